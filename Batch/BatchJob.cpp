@@ -0,0 +1,285 @@
+#include "BatchJob.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtMath>
+
+#include <AIS_Shape.hxx>
+#include <Prs3d_LineAspect.hxx>
+#include <Standard_Failure.hxx>
+#include <gp.hxx>
+
+#include "Label/Label_Builder.h"
+#include "Label/Label_Session.h"
+#include "OCCTool/ModelImporter.h"
+#include "OCCTool/OffscreenView.h"
+#include "OCCTool/PMIModel.h"
+
+static bool viewOrientation(const QString& name, V3d_TypeOfOrientation& orientation)
+{
+    static const struct {
+        const char* name;
+        V3d_TypeOfOrientation orientation;
+    } VIEWS[] = {
+        { "iso",    V3d_XposYnegZpos },
+        { "front",  V3d_Yneg },
+        { "back",   V3d_Ypos },
+        { "top",    V3d_Zpos },
+        { "bottom", V3d_Zneg },
+        { "left",   V3d_Xneg },
+        { "right",  V3d_Xpos }
+    };
+
+    for(size_t i=0;i<sizeof(VIEWS)/sizeof(VIEWS[0]);++i) {
+        if(name == VIEWS[i].name) {
+            orientation = VIEWS[i].orientation;
+            return true;
+        }
+    }
+    return false;
+}
+
+static gp_XYZ readXYZ(const QJsonValue& value)
+{
+    QJsonArray xyz = value.toArray();
+    return gp_XYZ(xyz.at(0).toDouble(), xyz.at(1).toDouble(), xyz.at(2).toDouble());
+}
+
+BatchJob::BatchJob(const QString &specFile, const QString &outputDir)
+    : mySpecFile(specFile),
+      myOutputDir(outputDir),
+      myName(QFileInfo(specFile).completeBaseName()),
+      myLinearRatio(0.001),
+      myAngular(qDegreesToRadians(20.0)),
+      myModel(nullptr)
+{
+}
+
+void BatchJob::SetMeshDeflection(double linearRatio, double angular)
+{
+    myLinearRatio = linearRatio;
+    myAngular = angular;
+}
+
+BatchJob::~BatchJob()
+{
+    Clear();
+}
+
+bool BatchJob::Prepare()
+{
+    myError.clear();
+    myWarnings.clear();
+    if(!readSpec())
+        return false;
+
+    try {
+        if(!importModel())
+            return false;
+    }
+    catch(const Standard_Failure& theFailure) {
+        myError = QObject::tr("Can't import %1: %2").arg(myModelFile, theFailure.GetMessageString());
+        return false;
+    }
+
+    buildLabels();
+    return true;
+}
+
+bool BatchJob::Write(OffscreenView *view)
+{
+    if(!QDir().mkpath(myOutputDir)) {
+        myError = QObject::tr("Can't create the directory %1").arg(myOutputDir);
+        return false;
+    }
+
+    // 1.the annotated session, it's opened later with the same model
+    QString error;
+    if(!Label_Session::Save(QDir(myOutputDir).filePath(myName + ".pmis"), myLabels, error)) {
+        myError = error;
+        return false;
+    }
+
+    if(!view || !view->IsValid())
+        return true;
+
+    // 2.the snapshots, the scene is displayed once for all the views
+    Handle(AIS_InteractiveContext) context = view->GetContext();
+    context->RemoveAll(Standard_False);
+
+    Handle(AIS_Shape) anAIS = new AIS_Shape(myShape);
+    anAIS->Attributes()->SetFaceBoundaryDraw(true);
+    anAIS->Attributes()->SetFaceBoundaryAspect(new Prs3d_LineAspect(Quantity_NOC_BLACK, Aspect_TOL_SOLID, 1.));
+    anAIS->Attributes()->SetAutoTriangulation(false);
+    context->SetColor(anAIS, Quantity_NOC_GRAY80, Standard_False);
+    context->Display(anAIS, Standard_False);
+    for(int i=0;i<myLabels.size();++i)
+        context->Display(myLabels[i], Standard_False);
+
+    bool ok = true;
+    for(int i=0;i<myViews.size();++i) {
+        const BatchViewSpec& spec = myViews[i];
+        V3d_TypeOfOrientation orientation;
+        if(spec.HasCamera) {
+            view->SetCamera(spec.Eye, spec.At, spec.Up, spec.Fit);
+        }
+        else if(viewOrientation(spec.Name, orientation)) {
+            view->SetProjection(orientation);
+        }
+        else {
+            myWarnings.append(QObject::tr("Unknown view %1").arg(spec.Name));
+            continue;
+        }
+
+        QString imageFile = QDir(myOutputDir).filePath(myName + "_" + spec.Name + ".png");
+        if(!view->Dump(imageFile, spec.Width, spec.Height)) {
+            myError = QObject::tr("Can't write the image %1").arg(imageFile);
+            ok = false;
+        }
+    }
+
+    context->RemoveAll(Standard_False);
+    return ok;
+}
+
+void BatchJob::Clear()
+{
+    myLabels.clear();
+    myShape.Nullify();
+    delete myModel;
+    myModel = nullptr;
+}
+
+bool BatchJob::readSpec()
+{
+    QFile file(mySpecFile);
+    if(!file.open(QIODevice::ReadOnly)) {
+        myError = QObject::tr("Can't open the spec %1").arg(mySpecFile);
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if(!doc.isObject()) {
+        myError = QObject::tr("Invalid spec %1: %2").arg(mySpecFile, parseError.errorString());
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    QString model = root["model"].toString();
+    if(model.isEmpty()) {
+        myError = QObject::tr("No model in the spec %1").arg(mySpecFile);
+        return false;
+    }
+    myModelFile = QFileInfo(mySpecFile).absoluteDir().absoluteFilePath(model);
+
+    mySpecs.clear();
+    QJsonArray labels = root["labels"].toArray();
+    for(int i=0;i<labels.size();++i) {
+        QJsonObject label = labels[i].toObject();
+        Label_Spec spec;
+        spec.Type = label["type"].toString();
+
+        QJsonArray shapes = label["shapes"].toArray();
+        for(int k=0;k<shapes.size();++k)
+            spec.Shapes.append(shapes[k].toInt(-1));
+
+        QJsonArray values = label["values"].toArray();
+        for(int k=0;k<values.size();++k)
+            spec.Values.append(NCollection_Utf8String(values[k].toString().toUtf8().constData()));
+
+        QJsonArray touches = label["touch"].toArray();
+        for(int k=0;k<touches.size();++k)
+            spec.Touches.append(gp_Pnt(readXYZ(touches[k])));
+
+        QJsonArray place = label["place"].toArray();
+        gp_XYZ normal(place.at(0).toDouble(), place.at(1).toDouble(), place.at(2).toDouble());
+        if(place.size() == 3 && normal.Modulus() > gp::Resolution()) {
+            spec.Place = gp_Dir(normal);
+            spec.HasPlace = true;
+        }
+        mySpecs.append(spec);
+    }
+
+    myViews.clear();
+    QJsonArray views = root["views"].toArray();
+    for(int i=0;i<views.size();++i) {
+        BatchViewSpec view;
+        if(!views[i].isObject()) {
+            view.Name = views[i].toString();
+            myViews.append(view);
+            continue;
+        }
+
+        QJsonObject object = views[i].toObject();
+        view.Name = object["name"].toString();
+        if(object.contains("eye")) {
+            view.HasCamera = true;
+            view.Eye = gp_Pnt(readXYZ(object["eye"]));
+            view.At = gp_Pnt(readXYZ(object["at"]));
+            gp_XYZ up = object.contains("up") ? readXYZ(object["up"]) : gp::DZ().XYZ();
+            view.Up = up.Modulus() > gp::Resolution() ? gp_Dir(up) : gp::DZ();
+            view.Fit = object["fit"].toBool(false);
+        }
+        QJsonArray size = object["size"].toArray();
+        if(size.size() == 2) {
+            view.Width = size.at(0).toInt();
+            view.Height = size.at(1).toInt();
+        }
+        if(view.Name.isEmpty())
+            view.Name = QString("view%1").arg(i+1);
+        myViews.append(view);
+    }
+    if(myViews.isEmpty()) {
+        BatchViewSpec view;
+        view.Name = "iso";
+        myViews.append(view);
+    }
+    return true;
+}
+
+bool BatchJob::importModel()
+{
+    // the files are already spread on the cores, mesh each one in its own thread
+    ModelImporter importer;
+    importer.SetMeshInParallel(false);
+    importer.SetPickIndexEnabled(false);
+    importer.SetMeshDeflection(myLinearRatio, myAngular);
+
+    int status = ModelImporter::Failed;
+    QString message;
+    QObject::connect(&importer, &ModelImporter::importFinished, [&](int theStatus, const QString& theMessage) {
+        status = theStatus;
+        message = theMessage;
+    });
+    importer.Import(myModelFile);
+
+    if(status != ModelImporter::Done) {
+        myError = QObject::tr("Can't import %1: %2").arg(myModelFile, message);
+        return false;
+    }
+
+    myShape = importer.GetShape();
+    myModel = importer.TakeModel();
+    return true;
+}
+
+void BatchJob::buildLabels()
+{
+    // the specs are independent, they are built on every core
+    QStringList errors;
+    QList<Handle(Label_PMI)> labels = Label_Builder(myModel).Build(mySpecs, errors);
+
+    myLabels.clear();
+    for(int i=0;i<labels.size();++i) {
+        if(labels[i].IsNull()) {
+            myWarnings.append(QObject::tr("Label %1: %2").arg(i+1).arg(errors[i]));
+            continue;
+        }
+        myLabels.append(labels[i]);
+    }
+}
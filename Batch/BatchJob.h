@@ -0,0 +1,102 @@
+#ifndef BATCHJOB_H
+#define BATCHJOB_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <gp_Dir.hxx>
+#include <gp_Pnt.hxx>
+
+#include "Label/Label_Builder.h"
+
+class PMIModel;
+class OffscreenView;
+
+//! One snapshot of the annotation spec, by a named direction or a camera
+struct BatchViewSpec
+{
+    BatchViewSpec() : HasCamera(false), Fit(false), Width(0), Height(0) {}
+
+    QString Name;
+    bool HasCamera;
+    gp_Pnt Eye;
+    gp_Pnt At;
+    gp_Dir Up;
+    bool Fit;    //!< fit all in the direction of camera
+    int Width;   //!< size of image, 0 for the size of view
+    int Height;
+};
+
+//! Annotate one model by its spec file, which is JSON:
+//! {
+//!   "model": "part.step",
+//!   "labels": [ { "type": "Diameter", "shapes": [12], "values": ["Φ10", "+0.1", "-0.1"],
+//!                 "touch": [[0,0,0]], "place": [0,0,1] } ],
+//!   "views": ["iso", "front", "top",
+//!             { "name": "detail", "eye": [100,-100,80], "at": [0,0,0], "up": [0,0,1],
+//!               "fit": false, "size": [1920,1080] }]
+//! }
+//! The relative model path is resolved by the spec location. A named view
+//! may also be an object with a size, without a camera.
+class BatchJob
+{
+public:
+    BatchJob(const QString& specFile, const QString& outputDir);
+    ~BatchJob();
+
+    //! Set the mesh deflection of the import, see ModelImporter::SetMeshDeflection()
+    void SetMeshDeflection(double linearRatio, double angular);
+
+    //! Read the spec, import the model and build the labels,
+    //! it doesn't touch the viewer and may run in any thread
+    bool Prepare();
+
+    //! Write the session file and the snapshot of every view,
+    //! it must run in the thread of the view, no snapshot if view is null
+    bool Write(OffscreenView* view);
+
+    //! Release the model and the labels
+    void Clear();
+
+    QString Name() const {
+        return myName;
+    }
+
+    QString Error() const {
+        return myError;
+    }
+
+    //! The labels which are skipped, with the reason
+    QStringList Warnings() const {
+        return myWarnings;
+    }
+
+    int LabelCount() const {
+        return myLabels.size();
+    }
+
+private:
+    bool readSpec();
+    bool importModel();
+    void buildLabels();
+
+    QString mySpecFile;
+    QString myOutputDir;
+    QString myName;
+    QString myModelFile;
+    QList<Label_Spec> mySpecs;
+    QList<BatchViewSpec> myViews;
+
+    double myLinearRatio;
+    double myAngular;
+
+    PMIModel* myModel;
+    TopoDS_Shape myShape;
+    QList<Handle(Label_PMI)> myLabels;
+
+    QString myError;
+    QStringList myWarnings;
+};
+
+#endif // BATCHJOB_H
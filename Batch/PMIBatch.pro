@@ -0,0 +1,20 @@
+# Headless batch annotation, see Batch/main.cpp for the usage
+
+QT += core gui
+QT -= widgets
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = PMIBatch
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+HEADERS += \
+    BatchJob.h
+
+SOURCES += \
+    BatchJob.cpp \
+    main.cpp
+
+include(../PMICore.pri)
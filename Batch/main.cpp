@@ -0,0 +1,156 @@
+// PMIBatch annotates models without a display window.
+//
+//   PMIBatch [-o dir] [-j jobs] [-s 1280x960] [-d 0.001] [-a 20] [--no-render] spec.json|dir ...
+//
+// Every spec names a model and its labels, see BatchJob.h. For each spec
+// the tool writes <name>.pmis and <name>_<view>.png into the output directory.
+// The models are imported and annotated in parallel, one per core, the
+// snapshots are taken one by one in the main thread with a shared view.
+// On Linux the snapshots need an X display, run it under xvfb-run on servers,
+// LIBGL_ALWAYS_SOFTWARE=1 draws them with the software OpenGL of Mesa.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include <QtMath>
+
+#include <OSD_Parallel.hxx>
+#include <OSD_ThreadPool.hxx>
+
+#include <memory>
+
+#include "BatchJob.h"
+#include "OCCTool/OffscreenView.h"
+
+//! Prepare the jobs of a chunk, one in each thread
+struct PrepareFunctor
+{
+    explicit PrepareFunctor(const QVector<BatchJob*>& jobs) : myJobs(jobs) {}
+
+    void operator()(int index) const {
+        myJobs[index]->Prepare();
+    }
+
+    const QVector<BatchJob*>& myJobs;
+};
+
+//! Expand the directories into their *.json files
+static QStringList collectSpecs(const QStringList& args)
+{
+    QStringList specs;
+    for(int i=0;i<args.size();++i) {
+        QFileInfo info(args[i]);
+        if(info.isDir()) {
+            QDir dir(info.absoluteFilePath());
+            QStringList files = dir.entryList(QStringList() << "*.json", QDir::Files, QDir::Name);
+            for(int k=0;k<files.size();++k)
+                specs.append(dir.absoluteFilePath(files[k]));
+        }
+        else {
+            specs.append(info.absoluteFilePath());
+        }
+    }
+    return specs;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // share the model cache with the application
+    QCoreApplication::setApplicationName("PMIAnnotation");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Annotate models by spec files without a display window.");
+    parser.addHelpOption();
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "Output directory.", "dir", "output");
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Number of models annotated at once.", "jobs",
+                                  QString::number(QThread::idealThreadCount()));
+    QCommandLineOption sizeOption(QStringList() << "s" << "size", "Size of the snapshots.", "WxH", "1280x960");
+    QCommandLineOption deflectionOption(QStringList() << "d" << "deflection",
+                                        "Linear mesh deflection, relative to the model size.", "ratio", "0.001");
+    QCommandLineOption angleOption(QStringList() << "a" << "angle", "Angular mesh deflection in degrees.", "degrees", "20");
+    QCommandLineOption noRenderOption("no-render", "Write the sessions only.");
+    parser.addOption(outputOption);
+    parser.addOption(jobsOption);
+    parser.addOption(sizeOption);
+    parser.addOption(deflectionOption);
+    parser.addOption(angleOption);
+    parser.addOption(noRenderOption);
+    parser.addPositionalArgument("specs", "Spec files, or directories of them.", "spec.json|dir...");
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList specs = collectSpecs(parser.positionalArguments());
+    if(specs.isEmpty())
+        parser.showHelp(1);
+
+    const QString outputDir = QFileInfo(parser.value(outputOption)).absoluteFilePath();
+    const int jobCount = qMax(1, parser.value(jobsOption).toInt());
+    const QStringList size = parser.value(sizeOption).split('x');
+    const int width = size.size() == 2 ? size[0].toInt() : 0;
+    const int height = size.size() == 2 ? size[1].toInt() : 0;
+    if(width <= 0 || height <= 0) {
+        err << "Invalid size " << parser.value(sizeOption) << endl;
+        return 1;
+    }
+    const double deflection = parser.value(deflectionOption).toDouble();
+    const double angle = parser.value(angleOption).toDouble();
+    if(deflection <= 0 || angle <= 0) {
+        err << "Invalid mesh deflection " << parser.value(deflectionOption) << ", " << parser.value(angleOption) << endl;
+        return 1;
+    }
+
+    // the label font is loaded relative to the executable, the paths are already absolute
+    QDir::setCurrent(QCoreApplication::applicationDirPath());
+
+    // the first call sets the number of threads of OSD_Parallel
+    OSD_ThreadPool::DefaultPool(jobCount);
+
+    std::unique_ptr<OffscreenView> view;
+    if(!parser.isSet(noRenderOption)) {
+        view.reset(new OffscreenView(width, height));
+        if(!view->IsValid()) {
+            err << "No display for the snapshots, only the sessions are written" << endl;
+            view.reset();
+        }
+    }
+
+    int failed = 0;
+    for(int from=0;from<specs.size();from+=jobCount) {
+        // 1.import and annotate a chunk of models in parallel
+        QVector<BatchJob*> jobs;
+        for(int i=from;i<qMin(from+jobCount, specs.size());++i) {
+            jobs.append(new BatchJob(specs[i], outputDir));
+            jobs.last()->SetMeshDeflection(deflection, qDegreesToRadians(angle));
+        }
+
+        OSD_Parallel::For(0, jobs.size(), PrepareFunctor(jobs));
+
+        // 2.write them one by one, the view belongs to this thread
+        for(int i=0;i<jobs.size();++i) {
+            BatchJob* job = jobs[i];
+            bool ok = job->Error().isEmpty() && job->Write(view.get());
+
+            if(ok)
+                out << job->Name() << ": " << job->LabelCount() << " labels" << endl;
+            else
+                err << job->Name() << ": " << job->Error() << endl;
+            const QStringList warnings = job->Warnings();
+            for(int k=0;k<warnings.size();++k)
+                err << job->Name() << ": " << warnings[k] << endl;
+
+            if(!ok)
+                ++failed;
+            delete job;
+        }
+    }
+
+    out << specs.size() - failed << " of " << specs.size() << " specs annotated" << endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -8,6 +8,7 @@
 #include <TopoDS.hxx>
 
 #include "OCCTool/GeneralTools.h"
+#include "OCCTool/PMIModel.h"
 
 DatumInput::DatumInput(QWidget *parent) :
     QWidget(parent),
@@ -26,6 +27,11 @@ DatumInput::~DatumInput()
     delete ui;
 }
 
+void DatumInput::SetModel(const PMIModel *model)
+{
+    myModel = model;
+}
+
 void DatumInput::SetBindShape(int index, const TopoDS_Shape &shape, const gp_Pnt &touch)
 {
     QString content;
@@ -55,7 +61,7 @@ void DatumInput::SetBindShape(int index, const TopoDS_Shape &shape, const gp_Pnt
         ui->lineEdit_elementName->setText(content);
     }
     else {
-        if(!GeneralTools::GetPlane(shape,myPlace)) {
+        if(!feature(shape).GetPlane(myPlace)) {
             QMessageBox::critical(this,"错误","请选择平面!");
             return;
         }
@@ -65,17 +71,14 @@ void DatumInput::SetBindShape(int index, const TopoDS_Shape &shape, const gp_Pnt
             gp_Dir direc;
             if(GeneralTools::GetShapeNormal(myBindShape,myTouch,direc)) {
                 if(myBindShape.ShapeType() == TopAbs_EDGE) {
-                    double a,b;
-                    Handle(Geom_Curve) curve = BRep_Tool::Curve(TopoDS::Edge(myBindShape),a,b);
                     gp_Ax2 ax2;
-                    if(GeneralTools::GetCenter(curve, ax2)) {
+                    if(feature(myBindShape).GetCenter(ax2)) {
                         direc = ax2.Direction();
                     }
                 }
                 else if(myBindShape.ShapeType() == TopAbs_FACE) {
-                    Handle(Geom_Surface) surface = BRep_Tool::Surface(TopoDS::Face(myBindShape));
                     gp_Ax1 ax1;
-                    if(GeneralTools::GetAxis(surface,ax1)) {
+                    if(feature(myBindShape).GetAxis(ax1)) {
                         direc = ax1.Direction();
                     }
                 }
@@ -146,3 +149,8 @@ void DatumInput::on_pushButton_selectPlace_clicked()
     selectPlace = true;
     requestSelectShape();
 }
+
+ShapeFeature DatumInput::feature(const TopoDS_Shape &shape) const
+{
+    return myModel ? myModel->Feature(shape) : ShapeFeature::Classify(shape);
+}
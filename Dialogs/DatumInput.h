@@ -6,6 +6,10 @@
 #include <TopoDS_Shape.hxx>
 #include <gp_Pln.hxx>
 
+#include "OCCTool/ShapeFeature.h"
+
+class PMIModel;
+
 namespace Ui {
 class DatumInput;
 }
@@ -30,7 +34,13 @@ private:
 
     TopoDS_Shape myBindShape;
 
+    const PMIModel* myModel = nullptr;
+
+    ShapeFeature feature(const TopoDS_Shape& shape) const;
+
 public slots:
+    //! The model of the selected shapes, their features are read from it
+    void SetModel(const PMIModel* model);
     void SetBindShape(int index, const TopoDS_Shape& shape, const gp_Pnt& touch);
 
 signals:
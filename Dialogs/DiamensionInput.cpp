@@ -15,6 +15,7 @@
 
 #include "TolStringInfo.h"
 #include "OCCTool/GeneralTools.h"
+#include "OCCTool/PMIModel.h"
 
 DiamensionInput::DiamensionInput(QWidget *parent) :
     QWidget(parent),
@@ -99,6 +100,11 @@ void DiamensionInput::on_pushButton_cancle_clicked()
     emit readyToClose();
 }
 
+void DiamensionInput::SetModel(const PMIModel *model)
+{
+    myModel = model;
+}
+
 void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const gp_Pnt &touch)
 {
     QString content;
@@ -129,11 +135,8 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
                 QMessageBox::critical(this,"错误","仅支持直线段长度!");
                 return;
             }
-            BRep_Tool bpt;
-            double a,b;
-            Handle(Geom_Curve) gc =bpt.Curve(TopoDS::Edge(shape),a,b);
             gp_Lin alin;
-            if(!GeneralTools::GetLine(gc,alin)) {
+            if(!feature(shape).GetLine(alin)) {
                 QMessageBox::critical(this,"错误","仅支持直线段长度!");
                 return;
             }
@@ -154,15 +157,15 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
             }
             if(!last.IsNull()) {
                 if(last.ShapeType() == TopAbs_FACE && shape.ShapeType() == TopAbs_FACE) {
-                    Handle(Geom_Surface) face1 = BRep_Tool::Surface(TopoDS::Face(last));
-                    Handle(Geom_Surface) face2 = BRep_Tool::Surface(TopoDS::Face(shape));
+                    const ShapeFeature feature1 = feature(last);
+                    const ShapeFeature feature2 = feature(shape);
 
                     gp_Ax1 axis1, axis2;
                     gp_Pln pln1, pln2;
-                    bool reta1 = GeneralTools::GetAxis(face1,axis1);
-                    bool reta2 = GeneralTools::GetAxis(face2,axis2);
-                    bool retb1 = GeneralTools::GetPlane(last,pln1);
-                    bool retb2 = GeneralTools::GetPlane(shape,pln2);
+                    bool reta1 = feature1.GetAxis(axis1);
+                    bool reta2 = feature2.GetAxis(axis2);
+                    bool retb1 = feature1.GetPlane(pln1);
+                    bool retb2 = feature2.GetPlane(pln2);
 
                     //两个旋转面
                     if(reta1 && reta2) {
@@ -226,16 +229,15 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
                     }
                 }
                 else if(last.ShapeType() == TopAbs_FACE && shape.ShapeType() == TopAbs_EDGE) {
-                    Handle(Geom_Surface) face1 = BRep_Tool::Surface(TopoDS::Face(last));
-                    double a,b;
-                    Handle(Geom_Curve) curve2 = BRep_Tool::Curve(TopoDS::Edge(shape),a,b);
+                    const ShapeFeature feature1 = feature(last);
+                    const ShapeFeature feature2 = feature(shape);
 
                     gp_Ax1 axis1;gp_Pln pln1;
                     gp_Lin lin2;gp_Ax2 ax2;
-                    bool reta1 = GeneralTools::GetAxis(face1,axis1);
-                    bool reta2 = GeneralTools::GetLine(curve2,lin2);
-                    bool retb1 = GeneralTools::GetPlane(last,pln1);
-                    bool retb2 = GeneralTools::GetCenter(curve2,ax2);
+                    bool reta1 = feature1.GetAxis(axis1);
+                    bool reta2 = feature2.GetLine(lin2);
+                    bool retb1 = feature1.GetPlane(pln1);
+                    bool retb2 = feature2.GetCenter(ax2);
                     //平面和直线
                     if(retb1 && reta2) {
                         if(pln1.Distance(lin2) < 1e-6) {
@@ -293,16 +295,15 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
                     }
                 }
                 else if(shape.ShapeType() == TopAbs_FACE && last.ShapeType() == TopAbs_EDGE) {
-                    Handle(Geom_Surface) face1 = BRep_Tool::Surface(TopoDS::Face(shape));
-                    double a,b;
-                    Handle(Geom_Curve) curve2 = BRep_Tool::Curve(TopoDS::Edge(last),a,b);
+                    const ShapeFeature feature1 = feature(shape);
+                    const ShapeFeature feature2 = feature(last);
 
                     gp_Ax1 axis1;gp_Pln pln1;
                     gp_Lin lin2;gp_Ax2 ax2;
-                    bool reta1 = GeneralTools::GetAxis(face1,axis1);
-                    bool reta2 = GeneralTools::GetLine(curve2,lin2);
-                    bool retb1 = GeneralTools::GetPlane(shape,pln1);
-                    bool retb2 = GeneralTools::GetCenter(curve2,ax2);
+                    bool reta1 = feature1.GetAxis(axis1);
+                    bool reta2 = feature2.GetLine(lin2);
+                    bool retb1 = feature1.GetPlane(pln1);
+                    bool retb2 = feature2.GetCenter(ax2);
                     //平面和直线
                     if(retb1 && reta2) {
                         if(pln1.Distance(lin2) < 1e-6) {
@@ -360,18 +361,15 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
                     }
                 }
                 else if(last.ShapeType() == TopAbs_EDGE && shape.ShapeType() == TopAbs_EDGE) {
-                    double a,b,c,d;
-                    Handle(Geom_Curve) curve1 = BRep_Tool::Curve(TopoDS::Edge(last),a,b);
-                    Handle(Geom_Curve) curve2 = BRep_Tool::Curve(TopoDS::Edge(shape),c,d);
-                    gp_Pnt p1,p2,p3,p4;
-                    curve1->D0(a,p1);curve1->D0(b,p2);curve2->D0(c,p3);curve2->D0(d,p4);
+                    const ShapeFeature feature1 = feature(last);
+                    const ShapeFeature feature2 = feature(shape);
 
                     gp_Ax2 axis1, axis2;
                     gp_Lin lin1, lin2;
-                    bool ret1 = GeneralTools::GetLine(curve1,lin1);
-                    bool ret2 = GeneralTools::GetLine(curve2,lin2);
-                    bool ret3 = GeneralTools::GetCenter(curve1,axis1);
-                    bool ret4 = GeneralTools::GetCenter(curve2,axis2);
+                    bool ret1 = feature1.GetLine(lin1);
+                    bool ret2 = feature2.GetLine(lin2);
+                    bool ret3 = feature1.GetCenter(axis1);
+                    bool ret4 = feature2.GetCenter(axis2);
 
                     // 两条线段
                     if(ret1 && ret2) {
@@ -450,11 +448,7 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
             if(!last.IsNull()) {
                 if(last.ShapeType() == TopAbs_EDGE && shape.ShapeType() == TopAbs_EDGE) {
                     gp_Lin lin1,lin2;
-                    BRep_Tool bpt;
-                    double a,b;
-                    Handle(Geom_Curve) cva =bpt.Curve(TopoDS::Edge(last),a,b);
-                    Handle(Geom_Curve) cvb =bpt.Curve(TopoDS::Edge(shape),a,b);
-                    if(GeneralTools::GetLine(cva,lin1) && GeneralTools::GetLine(cvb,lin2)) {
+                    if(feature(last).GetLine(lin1) && feature(shape).GetLine(lin2)) {
                         if(lin1.Distance(lin2) > 1e-6) {
                             QMessageBox::critical(this,"错误","两直线异面!");
                             return;
@@ -470,7 +464,7 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
                 }
                 else if(last.ShapeType() == TopAbs_FACE && shape.ShapeType() == TopAbs_FACE) {
                     gp_Pln pln1;gp_Pln pln2;
-                    if(GeneralTools::GetPlane(last,pln1) &&GeneralTools::GetPlane(shape,pln2)) {
+                    if(feature(last).GetPlane(pln1) && feature(shape).GetPlane(pln2)) {
                         if(!pln1.Axis().IsParallel(pln2.Axis(),1e-6)) {
                             ui->lineEdit_mainVal->setText(QString::number(pln1.Axis().Angle(pln2.Axis())*180/M_PI));
                         }
@@ -481,13 +475,9 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
                     }
                 }
                 else if(last.ShapeType() == TopAbs_FACE && shape.ShapeType() == TopAbs_EDGE) {
-                    Handle(Geom_Surface) surface = BRep_Tool::Surface(TopoDS::Face(last));
-                    double a,b;
-                    Handle(Geom_Curve) curve = BRep_Tool::Curve(TopoDS::Edge(shape),a,b);
-
                     gp_Ax1 axis; gp_Lin lin;
-                    bool ret1 = GeneralTools::GetAxis(surface,axis);
-                    bool ret2 = GeneralTools::GetLine(curve,lin);
+                    bool ret1 = feature(last).GetAxis(axis);
+                    bool ret2 = feature(shape).GetLine(lin);
                     if(ret1 && ret2) {
                         if(axis.IsParallel(lin.Position(), 1e-6)) {
                             QMessageBox::critical(this,"错误","直线与轴线平行!");
@@ -508,13 +498,9 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
                     }
                 }
                 else if(last.ShapeType() == TopAbs_EDGE && shape.ShapeType() == TopAbs_FACE) {
-                    Handle(Geom_Surface) surface = BRep_Tool::Surface(TopoDS::Face(shape));
-                    double a,b;
-                    Handle(Geom_Curve) curve = BRep_Tool::Curve(TopoDS::Edge(last),a,b);
-
                     gp_Ax1 axis; gp_Lin lin;
-                    bool ret1 = GeneralTools::GetAxis(surface,axis);
-                    bool ret2 = GeneralTools::GetLine(curve,lin);
+                    bool ret1 = feature(shape).GetAxis(axis);
+                    bool ret2 = feature(last).GetLine(lin);
                     if(ret1 && ret2) {
                         if(axis.IsParallel(lin.Position(), 1e-6)) {
                             QMessageBox::critical(this,"错误","直线与轴线平行!");
@@ -542,11 +528,8 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
                 QMessageBox::critical(this,"错误","仅支持圆弧!");
                 return;
             }
-            BRep_Tool bpt;
-            double a,b;
-            Handle(Geom_Curve) gc =bpt.Curve(TopoDS::Edge(shape),a,b);
             gp_Circ circ;
-            if(!GeneralTools::GetCicle(gc,circ)) {
+            if(!feature(shape).GetCircle(circ)) {
                 QMessageBox::critical(this,"错误","仅支持圆弧!");
                 return;
             }
@@ -558,11 +541,8 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
                 QMessageBox::critical(this,"错误","仅支持圆弧!");
                 return;
             }
-            BRep_Tool bpt;
-            double a,b;
-            Handle(Geom_Curve) gc =bpt.Curve(TopoDS::Edge(shape),a,b);
             gp_Circ circ;
-            if(!GeneralTools::GetCicle(gc,circ)) {
+            if(!feature(shape).GetCircle(circ)) {
                 QMessageBox::critical(this,"错误","仅支持圆弧!");
                 return;
             }
@@ -574,9 +554,8 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
                 QMessageBox::critical(this,"错误","仅支持圆锥面!");
                 return;
             }
-            Handle(Geom_Surface) face = BRep_Tool::Surface(TopoDS::Face(shape));
             gp_Cone cone;
-            if(GeneralTools::GetCone(face, cone)) {
+            if(feature(shape).GetCone(cone)) {
                 double value = 1.0/tan(cone.SemiAngle());
                 ui->lineEdit_mainVal->setText(QString("1:%1").arg(QString::number(0.5*value,'g',4)));
             }
@@ -600,7 +579,7 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
         }
     }
     else {
-        if(!GeneralTools::GetPlane(shape,myPlace)) {
+        if(!feature(shape).GetPlane(myPlace)) {
             QMessageBox::critical(this,"错误","请选择平面!");
             return;
         }
@@ -608,6 +587,11 @@ void DiamensionInput::SetBindShape(int index, const TopoDS_Shape &shape, const g
     }
 }
 
+ShapeFeature DiamensionInput::feature(const TopoDS_Shape &shape) const
+{
+    return myModel ? myModel->Feature(shape) : ShapeFeature::Classify(shape);
+}
+
 void DiamensionInput::on_pushButton_selectPlace_clicked()
 {
     selectPlace = true;
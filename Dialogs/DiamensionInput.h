@@ -7,6 +7,10 @@
 #include <gp_Pln.hxx>
 #include <NCollection_UtfString.hxx>
 
+#include "OCCTool/ShapeFeature.h"
+
+class PMIModel;
+
 namespace Ui {
 class DiamensionInput;
 }
@@ -45,9 +49,14 @@ private:
     NCollection_Utf8String upVal;
     NCollection_Utf8String lowVal;
 
+    const PMIModel* myModel = nullptr;
+
     void enableSubAndSup(bool ret);
+    ShapeFeature feature(const TopoDS_Shape& shape) const;
 
 public slots:
+    //! The model of the selected shapes, their features are read from it
+    void SetModel(const PMIModel* model);
     void SetBindShape(int index, const TopoDS_Shape& shape, const gp_Pnt& touch);
 
 signals:
@@ -14,6 +14,7 @@
 #include "TolStringInfo.h"
 #include "TolBaseInput.h"
 #include "OCCTool/GeneralTools.h"
+#include "OCCTool/PMIModel.h"
 
 ToleranceInput::ToleranceInput(QWidget *parent) :
     QWidget(parent),
@@ -53,6 +54,11 @@ ToleranceInput::~ToleranceInput()
     delete ui;
 }
 
+void ToleranceInput::SetModel(const PMIModel *model)
+{
+    myModel = model;
+}
+
 void ToleranceInput::SetBindShape(int index, const TopoDS_Shape &shape, const gp_Pnt &touch)
 {
     QString content;
@@ -93,7 +99,7 @@ void ToleranceInput::SetBindShape(int index, const TopoDS_Shape &shape, const gp
         ui->lineEdit_elementName->setText(content);
     }
     else {
-        if(!GeneralTools::GetPlane(shape,myPlace)) {
+        if(!feature(shape).GetPlane(myPlace)) {
             QMessageBox::critical(this,"错误","请选择平面!");
             return;
         }
@@ -105,7 +111,7 @@ void ToleranceInput::SetBindShape(int index, const TopoDS_Shape &shape, const gp
 void ToleranceInput::SetPointOnPlane(const gp_Pnt &pnt, const Handle(AIS_InteractiveContext)& context)
 {
     gp_Pln pln;
-    if(!GeneralTools::GetPlane(myBindShape,pln)) {
+    if(!feature(myBindShape).GetPlane(pln)) {
         QMessageBox::critical(this,"错误","只能在平面上测量直线度!");
     }
 
@@ -1175,3 +1181,8 @@ void ToleranceInput::on_pushButton_selectPlace_clicked()
     requestSelectShape();
 }
 
+
+ShapeFeature ToleranceInput::feature(const TopoDS_Shape &shape) const
+{
+    return myModel ? myModel->Feature(shape) : ShapeFeature::Classify(shape);
+}
@@ -9,8 +9,10 @@
 
 #include "TolBaseInput.h"
 #include "OCCTool/AIS_DraftPoint.h"
+#include "OCCTool/ShapeFeature.h"
 
 class QLabel;
+class PMIModel;
 
 namespace Ui {
 class ToleranceInput;
@@ -29,6 +31,8 @@ public:
     }
 
 public slots:
+    //! The model of the selected shapes, their features are read from it
+    void SetModel(const PMIModel* model);
     void SetBindShape(int index, const TopoDS_Shape& shape, const gp_Pnt& touch);
     void SetPointOnPlane(const gp_Pnt& pnt, const Handle(AIS_InteractiveContext)& context);
 
@@ -95,6 +99,7 @@ private:
     gp_Pnt myTouch;
     int selectIndex = -1;
     int pointCnt = 0;
+    const PMIModel* myModel = nullptr;
 
     QString tolName;
     NCollection_Utf8String tolWChar;
@@ -124,6 +129,7 @@ private:
     NCollection_Utf8String nstrFromBaseState(const BaseEditState& state);
 
     void handleLabelContent();
+    ShapeFeature feature(const TopoDS_Shape& shape) const;
     void appendString(const QString& str);
 
 signals:
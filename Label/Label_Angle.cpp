@@ -1,6 +1,5 @@
 ﻿ #include "Label_Angle.h"
 
-#include <BRepBuilderAPI_MakeEdge.hxx>
 #include <Font_BRepTextBuilder.hxx>
 #include <Prs3d_Arrow.hxx>
 #include <Prs3d_ShadingAspect.hxx>
@@ -13,9 +12,7 @@
 #include <Geom_Line.hxx>
 #include <Geom_Plane.hxx>
 #include <GeomAPI_ProjectPointOnSurf.hxx>
-#include <GC_MakeArcOfCircle.hxx>
 #include <GC_MakePlane.hxx>
-#include <BRepBuilderAPI_Transform.hxx>
 
 IMPLEMENT_STANDARD_RTTIEXT(Label_Angle,Label_PMI)
 
@@ -32,13 +29,10 @@ Label_Angle::Label_Angle(const NCollection_Utf8StringList &values,
     mySUPStr = values[1];
     mySUBStr = values[2];
 
-    myPntFirst = p1; myPntCorner = p2; myPntSecond = p3;
+    // 1. normal of label
+    SetDiamension(p1, p2, p3);
 
     myHasOrientation3D = Standard_True;
-    // 1. normal of label
-    myFirstDir = p1.XYZ()-p2.XYZ();
-    mySecondDir = p3.XYZ()-p2.XYZ();
-    myNormal = myFirstDir ^ mySecondDir;
 
     // 2.position of label
     gp_Pnt mid = 0.5*(p1.XYZ() + p3.XYZ());
@@ -48,6 +42,15 @@ Label_Angle::Label_Angle(const NCollection_Utf8StringList &values,
     myOrientation3D.SetYDirection(dvr);
 }
 
+void Label_Angle::SetDiamension(const gp_Pnt p1, const gp_Pnt &p2, const gp_Pnt &p3)
+{
+    myPntFirst = p1; myPntCorner = p2; myPntSecond = p3;
+
+    myFirstDir = p1.XYZ()-p2.XYZ();
+    mySecondDir = p3.XYZ()-p2.XYZ();
+    myNormal = myFirstDir ^ mySecondDir;
+}
+
 void Label_Angle::SetLocation(const gp_Pnt &pnt)
 {
     myHasOrientation3D = Standard_True;
@@ -57,10 +60,25 @@ void Label_Angle::SetLocation(const gp_Pnt &pnt)
 
     myOrientation3D.SetLocation(pp);
     myOrientation3D.SetYDirection(myOrientation3D.Location().XYZ() - myPntCorner.XYZ());
+    updatePosture();
+}
+
+void Label_Angle::SaveRecord(Label_Record &theRecord) const
+{
+    Label_PMI::SaveRecord(theRecord);
+    theRecord.Type = Label_Record::Angle;
+    theRecord.Strings = { myMainStr, mySUPStr, mySUBStr };
+    theRecord.Points = { myPntFirst, myPntCorner, myPntSecond };
+}
 
-    this->SetToUpdate();
-    this->UpdatePresentations();
-    this->GetContext()->RecomputeSelectionOnly(this);
+Standard_Boolean Label_Angle::LoadRecord(const Label_Record &theRecord)
+{
+    if(theRecord.Type != Label_Record::Angle || theRecord.Strings.size() < 3 || theRecord.Points.size() < 3)
+        return Standard_False;
+
+    SetData(theRecord.Strings[0], theRecord.Strings[1], theRecord.Strings[2]);
+    SetDiamension(theRecord.Points[0], theRecord.Points[1], theRecord.Points[2]);
+    return Label_PMI::LoadRecord(theRecord);
 }
 
 void Label_Angle::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsMgr*/,
@@ -69,7 +87,8 @@ void Label_Angle::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsM
 {
     switch (theMode)
     {
-    case 0:
+    case GlyphMode:
+    case TextMode:
     {
         // 0. verify the data
         if(myMainStr.IsEmpty())
@@ -91,16 +110,13 @@ void Label_Angle::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsM
         anAspect->SetColor(myLabelColor);
 
         // 3.draw the main&sup&sub string
-        TopoDS_Shape strShape = ComputeStringWithSupAndSub(myMainStr,mySUBStr,mySUPStr,myLabelWidth);
+        const TextMesh& strMesh = ComputeStringWithSupAndSub(myMainStr,mySUBStr,mySUPStr,myLabelWidth);
         gp_Trsf apply;
-        apply.SetTranslation(-0.5*myLabelWidth*myOrientation3D.XDirection());
-        BRepBuilderAPI_Transform compTrans(strShape,apply);
-        StdPrs_ShadedShape::Add(thePrs,compTrans.Shape(),myDrawer);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect(anAspect->Aspect());
+        apply.SetTranslation(gp_Vec(-0.5*myLabelWidth, 0, 0));
+        drawText(thePrs, theMode, strMesh, calculateOrientionTrsf()*apply, anAspect);
 
         // 4.draw the fly out line and arrow
-        ComputeFlyoutPnts();
-        ComputeLeadLine(thePrs, anAspect);
+        drawLead(thePrs, theMode, anAspect);
 
         break;
     }
@@ -157,17 +173,12 @@ void Label_Angle::ComputeFlyoutPnts()
     mySecondFlyOut = myPntCorner.Translated(pan2*mySecondDir);
 }
 
-void Label_Angle::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
-                                    const Handle(Prs3d_ShadingAspect)& anAspect)
+void Label_Angle::computeLead(LeadGeometry& theLead)
 {
     // 1. compute flyout line
-    TopoDS_Shape firstLin = BRepBuilderAPI_MakeEdge(myPntCorner, myFirstFlyOut);
-    StdPrs_ShadedShape::Add(thePrs,firstLin,myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
-
-    TopoDS_Shape secondLin = BRepBuilderAPI_MakeEdge(myPntCorner, mySecondFlyOut);
-    StdPrs_ShadedShape::Add(thePrs,secondLin,myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    ComputeFlyoutPnts();
+    theLead.AddSegment(myPntCorner, myFirstFlyOut);
+    theLead.AddSegment(myPntCorner, mySecondFlyOut);
 
     // 2. compute the arrow
     const Standard_Real textDis = myPntCorner.Distance(myOrientation3D.Location());
@@ -197,19 +208,8 @@ void Label_Angle::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
     gp_Pnt arrowL2 = arrowMid2.Translated(0.5*arrowDir2);
     gp_Pnt arrowR2 = arrowMid2.Translated(-0.5*arrowDir2);
 
-    Handle(Graphic3d_ArrayOfTriangles) aTriangle = new Graphic3d_ArrayOfTriangles(3);
-    aTriangle->AddVertex (arrowL1);
-    aTriangle->AddVertex (arcP1);
-    aTriangle->AddVertex (arrowR1);
-    thePrs->CurrentGroup()->AddPrimitiveArray(aTriangle);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
-
-    Handle(Graphic3d_ArrayOfTriangles) bTriangle = new Graphic3d_ArrayOfTriangles(3);
-    bTriangle->AddVertex (arrowL2);
-    bTriangle->AddVertex (arcP2);
-    bTriangle->AddVertex (arrowR2);
-    thePrs->CurrentGroup()->AddPrimitiveArray(bTriangle);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddTriangle(arrowL1, arcP1, arrowR1);
+    theLead.AddTriangle(arrowL2, arcP2, arrowR2);
 
     // 2. compute the arc
     gp_Pnt arcStart = arcP1;
@@ -236,10 +236,7 @@ void Label_Angle::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
 
     // draw the arc
     gp_Circ targetCirc(gp_Ax2(myPntCorner, myNormal), textDis);
-    Handle(Geom_TrimmedCurve) arcCurve = GC_MakeArcOfCircle(targetCirc, arcStart, arcEnd, Standard_True);
-    TopoDS_Shape arc = BRepBuilderAPI_MakeEdge(arcCurve);
-    StdPrs_ShadedShape::Add(thePrs,arc,myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddArc(targetCirc, arcStart, arcEnd);
 }
 
 Standard_Boolean Label_Angle::JudgePointInRegion(const gp_Pnt &pt)
@@ -18,17 +18,22 @@ public:
     //! Set location of shape, interface for drafting
     virtual void SetLocation(const gp_Pnt& pnt) override;
 
+    //! Store the type, strings and points of label
+    virtual void SaveRecord(Label_Record& theRecord) const Standard_OVERRIDE;
+
+    //! Rebuild the label from the record
+    virtual Standard_Boolean LoadRecord(const Label_Record& theRecord) Standard_OVERRIDE;
+
     //! Set the length value by main,sup,sub string
     void SetData(const NCollection_Utf8String& main, const NCollection_Utf8String& sup, const NCollection_Utf8String& sub) {
         myMainStr = main;
         mySUPStr = sup;
         mySUBStr = sub;
+        invalidateText();
     }
 
-    //! Set the points which the label is indicated to
-    void SetDiamension(const gp_Pnt p1, const gp_Pnt& p2, const gp_Pnt& p3) {
-        myPntFirst = p1; myPntCorner = p2; myPntSecond = p3;
-    }
+    //! Set the points which the label is indicated to, p2 is the corner
+    void SetDiamension(const gp_Pnt p1, const gp_Pnt& p2, const gp_Pnt& p3);
 
 protected:
 
@@ -43,8 +48,8 @@ protected:
 
     void ComputeFlyoutPnts();
 
-    void ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
-                          const Handle(Prs3d_ShadingAspect)& anAspect);
+    //! Add the fly out lines, the arc and arrows
+    virtual void computeLead(LeadGeometry& theLead) Standard_OVERRIDE;
 
     Standard_Boolean JudgePointInRegion(const gp_Pnt& pt);
     Standard_Boolean CloserToFirstEdge(const gp_Pnt& pt);
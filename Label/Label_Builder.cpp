@@ -0,0 +1,894 @@
+#include "Label_Builder.h"
+
+#include <QObject>
+#include <QVector>
+
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepTools.hxx>
+#include <BRep_Tool.hxx>
+#include <ElCLib.hxx>
+#include <ElSLib.hxx>
+#include <GC_MakePlane.hxx>
+#include <GeomAPI_IntSS.hxx>
+#include <GeomAPI_ProjectPointOnCurve.hxx>
+#include <GeomAPI_ProjectPointOnSurf.hxx>
+#include <Geom_Line.hxx>
+#include <Geom_Plane.hxx>
+#include <IntAna2d_AnaIntersection.hxx>
+#include <OSD_Parallel.hxx>
+#include <ProjLib.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Vertex.hxx>
+#include <gp.hxx>
+
+#include "Label_Angle.h"
+#include "Label_Datum.h"
+#include "Label_Diameter.h"
+#include "Label_Length.h"
+#include "Label_Radius.h"
+#include "Label_Taper.h"
+#include "Label_Tolerance.h"
+#include "OCCTool/GeneralTools.h"
+#include "OCCTool/PMIModel.h"
+
+//! The values of spec with empty strings up to count
+static QList<NCollection_Utf8String> paddedValues(const QList<NCollection_Utf8String>& values, int count)
+{
+    QList<NCollection_Utf8String> result = values;
+    while(result.size() < count)
+        result.append(NCollection_Utf8String(""));
+    return result;
+}
+
+//! The foot of p on pln
+static gp_Pnt projectOnPlane(const gp_Pln& pln, const gp_Pnt& p)
+{
+    const gp_Pnt2d uv = ProjLib::Project(pln, p);
+    return ElSLib::Value(uv.X(), uv.Y(), pln);
+}
+
+//! Build the labels of specs, one spec in each call with its own builder
+struct BuildFunctor
+{
+    BuildFunctor(const PMIModel* model, const QList<Label_Spec>& specs,
+                 Handle(Label_PMI)* labels, QString* errors)
+        : myModel(model), mySpecs(specs), myLabels(labels), myErrors(errors) {}
+
+    void operator()(int index) const {
+        Label_Builder aBuilder(myModel);
+        try {
+            myLabels[index] = aBuilder.Build(mySpecs[index]);
+            myErrors[index] = aBuilder.Error();
+        }
+        catch(const Standard_Failure& theFailure) {
+            // the geometry of shapes doesn't fit, such as two planes without intersection
+            myLabels[index].Nullify();
+            myErrors[index] = QString::fromUtf8(theFailure.GetMessageString());
+        }
+    }
+
+    const PMIModel* myModel;
+    const QList<Label_Spec>& mySpecs;
+    Handle(Label_PMI)* myLabels;
+    QString* myErrors;
+};
+
+Label_Builder::Label_Builder(const PMIModel *model)
+    : myModel(model)
+{
+}
+
+Handle(Label_PMI) Label_Builder::Tolerance(const NCollection_Utf8String &tolName,
+                                            const NCollection_Utf8String &tolVal,
+                                            const NCollection_Utf8String &tolVal2,
+                                            const QList<NCollection_Utf8String> &baseName,
+                                            const TopoDS_Shape& shape,
+                                            const gp_Pln& place,
+                                            const gp_Pnt& touch)
+{
+    if(!checkModel())
+        return Handle(Label_PMI)();
+
+    Handle(Label_Tolerance) aLabel = new Label_Tolerance();
+    aLabel->SetData(tolName,tolVal,tolVal2,baseName);
+    const Bnd_Box& box = myModel->BoundingBox();
+
+    gp_Dir direc;
+    GeneralTools::GetShapeNormal(shape,touch,direc);
+
+    gp_Pnt target = targetWithBox(touch,direc,box);
+
+    gp_Ax2 oriention;
+    oriention.SetLocation(target);
+    oriention.SetDirection(direc);
+
+    aLabel->SetPosture(touch,oriention);
+    aLabel->SetShapeIndices(shapeIndices(shape));
+    return aLabel;
+}
+
+Handle(Label_PMI) Label_Builder::Dimension(const QList<NCollection_Utf8String> &valList,
+                                            const TopoDS_Shape &shape1, const TopoDS_Shape &shape2,
+                                            const gp_Pnt &touch1, const gp_Pnt &touch2,
+                                            const gp_Pln& place, int type)
+{
+    if(!checkModel())
+        return Handle(Label_PMI)();
+
+    const Bnd_Box& box = myModel->BoundingBox();
+    switch(type)
+    {
+    //尺寸
+    case Size:{
+        if(shape1.ShapeType() == TopAbs_EDGE) {
+            TopoDS_Vertex vertex1, vertex2;
+            TopExp::Vertices (TopoDS::Edge (shape1), vertex1, vertex2);
+            gp_Pnt p1 = BRep_Tool::Pnt (vertex1);
+            gp_Pnt p2 = BRep_Tool::Pnt (vertex2);
+
+            gp_Dir normal = place.Axis().Direction().Reversed();
+            gp_Dir lin(p2.XYZ()-p1.XYZ());
+            if(!lin.IsNormal(normal, 1e-6)) {
+                myError = "所选放置面法向不与直线垂直!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt mid = 0.5*(p1.XYZ() + p2.XYZ());
+            gp_Pnt target = targetWithBox(mid,normal,box);
+            gp_Ax2 oriention(target, lin^normal);
+            oriention.SetYDirection(normal);
+
+            Handle(Label_Length) aLabel = new Label_Length(valList, p1,p2,oriention);
+            aLabel->SetShapeIndices(shapeIndices(shape1));
+            return aLabel;
+        }
+        break;
+    }
+        //距离
+    case Distance:{
+        return measureLength(box, valList, shape1, shape2);
+    }
+        //角度
+    case Angle:{
+        return measureAngle(valList, shape1, shape2, touch1, touch2);
+    }
+        //直径
+    case Diameter:{
+        if(shape1.ShapeType() == TopAbs_EDGE) {
+            gp_Circ circle;
+            if(myModel->Feature(shape1).GetCircle(circle)) {
+                gp_Dir direc = touch1.XYZ() - circle.Location().XYZ();
+                gp_Pnt target = targetWithBox(touch1, direc, box);
+                gp_Ax2 oriention(target, circle.Axis().Direction(), direc);
+                // 偏移避免遮挡
+                gp_Dir pan = circle.Axis().Direction();
+                circle.Translate(0.01*pan);
+                oriention.Translate(0.01*pan);
+
+                Handle(Label_Diameter) aLabel = new Label_Diameter(valList, circle, oriention);
+                aLabel->SetShapeIndices(shapeIndices(shape1));
+                return aLabel;
+            }
+        }
+        break;
+    }
+        //半径
+    case Radius:{
+        if(shape1.ShapeType() == TopAbs_EDGE) {
+            gp_Circ circle;
+            if(myModel->Feature(shape1).GetCircle(circle)) {
+                gp_Dir direc = touch1.XYZ() - circle.Location().XYZ();
+                gp_Pnt target = targetWithBox(touch1, direc, box);
+                gp_Ax2 oriention(target, circle.Axis().Direction(), direc);
+                // 偏移避免遮挡
+                gp_Dir pan = circle.Axis().Direction();
+                circle.Translate(0.01*pan);
+                oriention.Translate(0.01*pan);
+
+                Handle(Label_Radius) aLabel = new Label_Radius(valList, circle, oriention);
+                aLabel->SetShapeIndices(shapeIndices(shape1));
+                return aLabel;
+            }
+        }
+        break;
+    }
+        //锥度
+    case Taper:{
+        if(shape1.ShapeType() == TopAbs_FACE) {
+            gp_Cone cone;
+            if(myModel->Feature(shape1).GetCone(cone)) {
+                gp_Lin center = cone.Axis();
+                GeomAPI_ProjectPointOnCurve PPOC(touch1, new Geom_Line(center));
+                gp_Pnt pc = PPOC.NearestPoint();
+                gp_Dir direc = touch1.XYZ() - pc.XYZ();
+                gp_Pnt target = targetWithBox(touch1, direc, box);
+
+                gp_Dir dvx = center.Direction();
+                gp_Dir normal = dvx ^ direc;
+                gp_Ax2 oriention(target, normal, dvx);
+
+                Handle(Label_Taper) aLabel = new Label_Taper(valList[0], touch1, oriention);
+                aLabel->SetShapeIndices(shapeIndices(shape1));
+                return aLabel;
+            }
+            else {
+                myError = "仅支持锥面的锥度标注!";
+                return Handle(Label_PMI)();
+            }
+        }
+    }
+    }
+    myError = "所选类型暂不支持!";
+    return Handle(Label_PMI)();
+}
+
+Handle(Label_PMI) Label_Builder::Datum(const QString &str, const TopoDS_Shape& shape, const gp_Pln &place, const gp_Pnt& touch)
+{
+    if(!checkModel())
+        return Handle(Label_PMI)();
+
+    Handle(Label_Datum) aLabel = new Label_Datum();
+    aLabel->SetDatumName(str.toStdString().data());
+
+    const Bnd_Box& box = myModel->BoundingBox();
+    gp_Pnt origin = touch;
+
+    // 1.normal at touch point, set as label's Y axis
+    gp_Dir direc;
+    if(!GeneralTools::GetShapeNormal(shape,origin,direc)) {
+        myError = "所选形状不能作为基准!";
+        return Handle(Label_PMI)();
+    }
+
+    // 2. reset the touch point if shape is circle/cylinder...
+    // and get the place location out of bounding box
+    if(shape.ShapeType() == TopAbs_EDGE) {
+        gp_Ax2 ax2;
+        if(myModel->Feature(shape).GetCenter(ax2)) {
+            origin = ax2.Location();
+            direc = ax2.Direction();
+        }
+        else {
+            double a,b;
+            Handle(Geom_Curve) curve = BRep_Tool::Curve(TopoDS::Edge(shape),a,b);
+            origin = curve->Value(b);//直线从一个端点引出
+        }
+    }
+    else if(shape.ShapeType() == TopAbs_FACE) {
+        gp_Ax1 ax1;
+        if(myModel->Feature(shape).GetAxis(ax1)) {
+            gp_Lin lin(ax1);
+            Handle(Geom_Line) line  = new Geom_Line(lin);
+            GeomAPI_ProjectPointOnCurve  ppc(touch, line);
+            origin = ppc.NearestPoint();
+            direc = ax1.Direction();
+        }
+    }
+    gp_Pnt target = targetWithBox(origin,direc,box);
+
+    // 3.normal of label plane, set as label's Z axis
+    gp_Dir normal = place.Axis().Direction();
+    if(direc.IsParallel(normal, 1e-6)) {
+        myError = "放置面法向与基准元素法向一致!";
+        return Handle(Label_PMI)();
+    }
+
+    if(!direc.IsNormal(normal, 1e-6)) {
+        myError = "放置面法向与基准元素法向不垂直!";
+        return Handle(Label_PMI)();
+    }
+
+    // 4.label's X axis
+    gp_Dir VX = direc.Crossed(normal);
+
+    // 5.offset the target position by X axis
+    target.Translate(-0.5*aLabel->StrWidth()*VX);
+
+    // 6. the placement of label
+    gp_Ax2 oriention(target,normal,VX);
+
+    aLabel->SetTouchPoint(origin);
+    aLabel->SetOriention(oriention);
+    aLabel->SetShapeIndices(shapeIndices(shape));
+    return aLabel;
+}
+
+Handle(Label_PMI) Label_Builder::Build(const Label_Spec &spec)
+{
+    static const char* DIMENSION_TYPES[] = { "Size", "Distance", "Angle", "Diameter", "Radius", "Taper" };
+
+    if(!checkModel())
+        return Handle(Label_PMI)();
+
+    TopoDS_Shape shape1 = spec.Shapes.size() > 0 ? myModel->GetShape(spec.Shapes[0]) : TopoDS_Shape();
+    TopoDS_Shape shape2 = spec.Shapes.size() > 1 ? myModel->GetShape(spec.Shapes[1]) : TopoDS_Shape();
+    if(shape1.IsNull()) {
+        myError = QObject::tr("No shape");
+        return Handle(Label_PMI)();
+    }
+
+    gp_Pnt touch1 = spec.Touches.size() > 0 ? spec.Touches[0] : DefaultTouch(shape1);
+    gp_Pnt touch2 = spec.Touches.size() > 1 ? spec.Touches[1] : DefaultTouch(shape2.IsNull() ? shape1 : shape2);
+    gp_Pln place(touch1, spec.HasPlace ? spec.Place : gp::DZ());
+
+    if(spec.Type == "Tolerance") {
+        QList<NCollection_Utf8String> values = paddedValues(spec.Values, 3);
+        return Tolerance(values[0], values[1], values[2], values.mid(3), shape1, place, touch1);
+    }
+    if(spec.Type == "Datum") {
+        QList<NCollection_Utf8String> values = paddedValues(spec.Values, 1);
+        return Datum(QString::fromUtf8(values[0].ToCString()), shape1, place, touch1);
+    }
+    for(int k=0;k<int(sizeof(DIMENSION_TYPES)/sizeof(DIMENSION_TYPES[0]));++k) {
+        if(spec.Type == DIMENSION_TYPES[k])
+            return Dimension(paddedValues(spec.Values, 3), shape1, shape2, touch1, touch2, place, k);
+    }
+    myError = QObject::tr("Unknown type %1").arg(spec.Type);
+    return Handle(Label_PMI)();
+}
+
+QList<Handle(Label_PMI)> Label_Builder::Build(const QList<Label_Spec> &specs, QStringList &errors, bool inParallel) const
+{
+    QVector<Handle(Label_PMI)> labels(specs.size());
+    QVector<QString> reasons(specs.size());
+    if(!specs.isEmpty())
+        OSD_Parallel::For(0, specs.size(), BuildFunctor(myModel, specs, labels.data(), reasons.data()), !inParallel);
+
+    errors = reasons.toList();
+    return labels.toList();
+}
+
+gp_Pnt Label_Builder::DefaultTouch(const TopoDS_Shape &shape)
+{
+    if(shape.IsNull())
+        return gp_Pnt();
+
+    switch(shape.ShapeType())
+    {
+    case TopAbs_FACE:{
+        const TopoDS_Face& face = TopoDS::Face(shape);
+        Standard_Real u1, u2, v1, v2;
+        BRepTools::UVBounds(face, u1, u2, v1, v2);
+        BRepAdaptor_Surface surface(face);
+        return surface.Value(0.5*(u1+u2), 0.5*(v1+v2));
+    }
+    case TopAbs_EDGE:{
+        BRepAdaptor_Curve curve(TopoDS::Edge(shape));
+        return curve.Value(0.5*(curve.FirstParameter()+curve.LastParameter()));
+    }
+    case TopAbs_VERTEX:
+        return BRep_Tool::Pnt(TopoDS::Vertex(shape));
+    default:
+        return gp_Pnt();
+    }
+}
+
+bool Label_Builder::checkModel()
+{
+    myError.clear();
+    if(!myModel) {
+        myError = "请先导入模型!";
+        return false;
+    }
+    return true;
+}
+
+QList<int> Label_Builder::shapeIndices(const TopoDS_Shape &shape1, const TopoDS_Shape &shape2) const
+{
+    QList<TopoDS_Shape> shapes;
+    shapes.append(shape1);
+    if(!shape2.IsNull())
+        shapes.append(shape2);
+    return myModel ? myModel->FindShapes(shapes) : QList<int>();
+}
+
+gp_Pnt Label_Builder::targetWithBox(const gp_Pnt &input, const gp_Dir &dir, const Bnd_Box &box)
+{
+    gp_Pnt target;
+
+    // the border is where the ray leaves the box if input is inside it, else where it enters
+    double dif = 0;
+    Standard_Real tmin, tmax;
+    if(GeneralTools::IntersectRayBox(gp_Lin(input,dir), box, tmin, tmax) && tmax >= 0) {
+        dif = (tmin >= 0) ? tmin : tmax;
+    }
+    if(dif < 15)
+        dif = 15;
+
+    target = input.XYZ() + 1.2*dif*dir.XYZ();
+    return target;
+}
+
+Handle(Label_PMI) Label_Builder::measureLength(const Bnd_Box &box, const QList<NCollection_Utf8String> &valList,
+                                              const TopoDS_Shape &shape1, const TopoDS_Shape &shape2)
+{
+    Handle(Label_Length) aLabel;
+    if(shape1.ShapeType() == TopAbs_FACE && shape2.ShapeType() == TopAbs_FACE) {
+        const ShapeFeature feature1 = myModel->Feature(shape1);
+        const ShapeFeature feature2 = myModel->Feature(shape2);
+
+        gp_Ax1 axis1, axis2;
+        gp_Pln pln1, pln2;
+        bool reta1 = feature1.GetAxis(axis1);
+        bool reta2 = feature2.GetAxis(axis2);
+        bool retb1 = feature1.GetPlane(pln1);
+        bool retb2 = feature2.GetPlane(pln2);
+
+        //两个旋转面
+        if(reta1 && reta2) {
+            if(!axis1.IsParallel(axis2, 1e-6)) {
+                myError = "两面不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            if(gp_Lin(axis1).Distance(gp_Lin(axis2)) < 1e-6) {
+                myError = "两转轴重合!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!axis1.IsParallel(axis2, 1e-6)) {
+                myError = "两转不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, axis1, axis2, p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //两个平面
+        else if(retb1 && retb2){
+            if(pln1.Distance(pln2) < 1e-6) {
+                myError = "两面不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            TopExp_Explorer exp;
+            exp.Init(shape1, TopAbs_EDGE);
+            Standard_Real low, up;
+            Handle(Geom_Curve) curve = BRep_Tool::Curve(TopoDS::Edge(exp.Value()), low, up);
+            gp_Pnt plnPt = curve->Value(low);
+            gp_Ax1 plnAxis1(plnPt, pln1.YAxis().Direction());
+            gp_Pnt np = projectOnPlane(pln2, plnPt);
+            gp_Ax1 plnAxis2(np,plnAxis1.Direction());
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, plnAxis1, plnAxis2, p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //1是旋转面，2是平面
+        else if(reta1 && retb2) {
+            if(pln2.Distance(gp_Lin(axis1)) < 1e-6) {
+                myError = "平面与转轴重合!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!pln2.Axis().IsNormal(axis1, 1e-6)) {
+                myError = "平面与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt np = projectOnPlane(pln2, axis1.Location());
+            gp_Ax1 plnAxis(np,axis1.Direction());
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, axis1, plnAxis, p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //1是平面2是旋转面
+        else if(reta2 && retb1){
+            if(pln1.Distance(gp_Lin(axis2)) < 1e-6) {
+                myError = "平面与转轴重合!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!pln1.Axis().IsNormal(axis2, 1e-6)) {
+                myError = "平面与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt np = projectOnPlane(pln1, axis2.Location());
+            gp_Ax1 plnAxis(np,axis2.Direction());
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, plnAxis, axis2, p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+    }
+    else if(shape1.ShapeType() == TopAbs_FACE && shape2.ShapeType() == TopAbs_EDGE) {
+        const ShapeFeature feature1 = myModel->Feature(shape1);
+        const ShapeFeature feature2 = myModel->Feature(shape2);
+
+        gp_Ax1 axis1;gp_Pln pln1;
+        gp_Lin lin2;gp_Ax2 ax2;
+        bool reta1 = feature1.GetAxis(axis1);
+        bool reta2 = feature2.GetLine(lin2);
+        bool retb1 = feature1.GetPlane(pln1);
+        bool retb2 = feature2.GetCenter(ax2);
+        //平面和直线
+        if(retb1 && reta2) {
+            if(pln1.Distance(lin2) < 1e-6) {
+                myError = "直线在平面上!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!pln1.Axis().IsNormal(lin2.Position(), 1e-6)) {
+                myError = "直线不与平面垂直!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt np = projectOnPlane(pln1, lin2.Location());
+            gp_Ax1 plnAxis(np,lin2.Direction());
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, plnAxis, lin2.Position(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //平面和圆弧
+        else if(retb1 && retb2) {
+            if(!pln1.Axis().IsNormal(ax2.Axis(), 1e-6) && !pln1.Axis().IsParallel(ax2.Axis(), 1e-6)) {
+                myError = "平面与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt np = projectOnPlane(pln1, ax2.Location());
+            gp_Ax1 plnAxis(np,ax2.Direction());
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, plnAxis, ax2.Axis(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //旋转面和直线
+        else if(reta1 && reta2) {
+            if(gp_Lin(axis1).Distance(lin2) < 1e-6) {
+                myError = "直线与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!axis1.IsParallel(lin2.Position(), 1e-6)) {
+                myError = "直线与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, axis1, lin2.Position(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //旋转面和圆弧
+        else if(reta1 && retb2) {
+            if(gp_Lin(axis1).Distance(gp_Lin(ax2.Axis())) < 1e-6) {
+                myError = "面转轴与弧转轴重合!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!axis1.IsParallel(ax2.Axis(), 1e-6)) {
+                myError = "面转轴与弧转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, axis1, ax2.Axis(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+    }
+    else if(shape2.ShapeType() == TopAbs_FACE && shape1.ShapeType() == TopAbs_EDGE) {
+        const ShapeFeature feature1 = myModel->Feature(shape2);
+        const ShapeFeature feature2 = myModel->Feature(shape1);
+
+        gp_Ax1 axis1;gp_Pln pln1;
+        gp_Lin lin2;gp_Ax2 ax2;
+        bool reta1 = feature1.GetAxis(axis1);
+        bool reta2 = feature2.GetLine(lin2);
+        bool retb1 = feature1.GetPlane(pln1);
+        bool retb2 = feature2.GetCenter(ax2);
+        //平面和直线
+        if(retb1 && reta2) {
+            if(pln1.Distance(lin2) < 1e-6) {
+                myError = "直线在平面上!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!pln1.Axis().IsNormal(lin2.Position(), 1e-6)) {
+                myError = "直线不与平面垂直!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt np = projectOnPlane(pln1, lin2.Location());
+            gp_Ax1 plnAxis(np,lin2.Direction());
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, plnAxis, lin2.Position(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //平面和圆弧
+        else if(retb1 && retb2) {
+            if(!pln1.Axis().IsNormal(ax2.Axis(), 1e-6) && !pln1.Axis().IsParallel(ax2.Axis(), 1e-6)) {
+                myError = "平面与圆弧不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt np = projectOnPlane(pln1, ax2.Location());
+            gp_Ax1 plnAxis(np,ax2.Direction());
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, plnAxis, ax2.Axis(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //旋转面和直线
+        else if(reta1 && reta2) {
+            if(gp_Lin(axis1).Distance(lin2) < 1e-6) {
+                myError = "直线与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!axis1.IsParallel(lin2.Position(), 1e-6)) {
+                myError = "直线与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, axis1, lin2.Position(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //旋转面和圆弧
+        else if(reta1 && retb2) {
+            if(gp_Lin(axis1).Distance(gp_Lin(ax2.Location(),ax2.Direction())) < 1e-6) {
+                myError = "面转轴与圆弧转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!axis1.IsParallel(ax2.Axis(), 1e-6)) {
+                myError = "面转轴与弧转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, axis1, ax2.Axis(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+    }
+    else if(shape1.ShapeType() == TopAbs_EDGE && shape2.ShapeType() == TopAbs_EDGE) {
+        const ShapeFeature feature1 = myModel->Feature(shape1);
+        const ShapeFeature feature2 = myModel->Feature(shape2);
+
+        gp_Ax2 axis1, axis2;
+        gp_Lin lin1, lin2;
+        bool ret1 = feature1.GetLine(lin1);
+        bool ret2 = feature2.GetLine(lin2);
+        bool ret3 = feature1.GetCenter(axis1);
+        bool ret4 = feature2.GetCenter(axis2);
+
+        // 两条线段
+        if(ret1 && ret2) {
+            if(lin1.Distance(lin2) < 1e-6) {
+                myError = "两直线相交!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!lin1.Position().IsParallel(lin2.Position(), 1e-6)) {
+                myError = "两直线不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, lin1.Position(), lin2.Position(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //1线段2圆弧
+        else if(ret1 && ret4) {
+            if(lin1.Distance(gp_Lin(axis2.Axis())) < 1e-6) {
+                myError = "直线与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!lin1.Position().IsParallel(axis2.Axis(), 1e-6) && !lin1.Position().IsNormal(axis2.Axis(), 1e-6)) {
+                myError = "直线与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, lin1.Position(), axis2.Axis(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //1圆弧2线段
+        else if(ret3 && ret2) {
+            if(lin2.Distance(gp_Lin(axis1.Axis())) < 1e-6) {
+                myError = "直线与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!lin2.Position().IsParallel(axis1.Axis(), 1e-6) && !lin2.Position().IsNormal(axis1.Axis(), 1e-6)) {
+                myError = "直线与转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, axis1.Axis(), lin2.Position(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+        //两条圆弧
+        else if(ret3 && ret4) {
+            gp_Lin lct1(axis1.Axis());
+            gp_Lin lct2(axis2.Axis());
+            if(lct1.Distance(lct2) < 1e-6) {
+                myError = "两个转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            if(!axis1.Axis().IsParallel(axis2.Axis(), 1e-6)) {
+                myError = "两个转轴不平行!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt p1 ,p2;gp_Ax2 oriention;
+            lengthOfTwoAxis(box, axis1.Axis(), axis2.Axis(), p1, p2, oriention);
+            aLabel = new Label_Length(valList, p1,p2,oriention);
+        }
+    }
+
+    if(aLabel.IsNull()) {
+        myError = "不支持的距离类型!";
+        return Handle(Label_PMI)();
+    }
+
+    aLabel->SetShapeIndices(shapeIndices(shape1, shape2));
+    return aLabel;
+}
+
+Handle(Label_PMI) Label_Builder::measureAngle(const QList<NCollection_Utf8String> &valList,
+                                             const TopoDS_Shape &shape1, const TopoDS_Shape &shape2,
+                                             const gp_Pnt &touch1, const gp_Pnt &touch2)
+{
+    Handle(Label_Angle) aLabel;
+    if(shape1.ShapeType() == TopAbs_EDGE && shape2.ShapeType() == TopAbs_EDGE) {
+        gp_Lin lin1,lin2;
+        bool ret1 = myModel->Feature(shape1).GetLine(lin1);
+        bool ret2 = myModel->Feature(shape2).GetLine(lin2);
+        if(ret1 && ret2) {
+            if(lin1.Position().IsParallel(lin2.Position(), 1e-6)) {
+                myError = "两直线平行!";
+                return Handle(Label_PMI)();
+            }
+
+            if(lin1.Distance(lin2) > 1e-6) {
+                myError = "两直线异面!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Pnt center = intersectionOfLines(lin1, lin2);
+
+            aLabel = new Label_Angle(valList,
+                                     touch1, center, touch2);
+            gp_Trsf pan;
+            gp_Dir normal = (touch1.XYZ()-center.XYZ()) ^ (touch2.XYZ()-center.XYZ());
+            pan.SetTranslation(0.01*normal);
+            aLabel->SetLocalTransformation(pan);
+        }
+        else {
+            myError = "所选类型不能计算角度!";
+            return Handle(Label_PMI)();
+        }
+    }
+    else if(shape1.ShapeType() == TopAbs_FACE && shape2.ShapeType() == TopAbs_FACE) {
+        gp_Pln pln1, pln2;gp_Ax1 axis1, axis2;
+        bool ret1 = myModel->Feature(shape1).GetPlane(pln1);
+        bool ret2 = myModel->Feature(shape2).GetPlane(pln2);
+
+        //两个平面
+        if(ret1 && ret2) {
+            if(pln1.Axis().IsParallel(pln2.Axis(), 1e-6)) {
+                myError = "两平面平行!";
+                return Handle(Label_PMI)();
+            }
+
+            GeomAPI_IntSS ISS(new Geom_Plane(pln1), new Geom_Plane(pln2), 1e-6);
+            Handle(Geom_Curve) curve = ISS.Line(1);
+
+            GeomAPI_ProjectPointOnCurve PPOC(touch1, curve);
+            gp_Pnt center = PPOC.NearestPoint();
+
+            gp_Lin inter;
+            GeneralTools::GetLine(curve, inter);
+            Handle(Geom_Plane) tmp = GC_MakePlane(inter.Position());
+            tmp->SetLocation(center);
+            GeomAPI_ProjectPointOnSurf PPOS(touch2, tmp);
+            gp_Pnt pcs = PPOS.NearestPoint();
+
+            aLabel = new Label_Angle(valList, touch1, center, pcs);
+        }
+        else {
+            myError = "所选类型不能计算角度!";
+            return Handle(Label_PMI)();
+        }
+    }
+    else if(shape1.ShapeType() == TopAbs_FACE && shape2.ShapeType() == TopAbs_EDGE) {
+        gp_Ax1 axis; gp_Lin lin;
+        bool ret1 = myModel->Feature(shape1).GetAxis(axis);
+        bool ret2 = myModel->Feature(shape2).GetLine(lin);
+        if(ret1 && ret2) {
+            if(axis.IsParallel(lin.Position(), 1e-6)) {
+                myError = "直线与轴线平行!";
+                return Handle(Label_PMI)();
+            }
+
+            if(lin.Distance(gp_Lin(axis)) > 1e-6) {
+                myError = "直线与轴线异面!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Lin linf(axis);
+            gp_Pnt center = intersectionOfLines(linf, lin);
+            GeomAPI_ProjectPointOnCurve PPOC(touch1, new Geom_Line(linf));
+            gp_Pnt pax = PPOC.NearestPoint();
+            aLabel = new Label_Angle(valList, touch2, center, pax);
+        }
+        else {
+            myError = "所选类型不能计算角度!";
+            return Handle(Label_PMI)();
+        }
+    }
+    else if(shape2.ShapeType() == TopAbs_FACE && shape1.ShapeType() == TopAbs_EDGE) {
+        gp_Ax1 axis; gp_Lin lin;
+        bool ret1 = myModel->Feature(shape2).GetAxis(axis);
+        bool ret2 = myModel->Feature(shape1).GetLine(lin);
+        if(ret1 && ret2) {
+            if(axis.IsParallel(lin.Position(), 1e-6)) {
+                myError = "直线与轴线平行!";
+                return Handle(Label_PMI)();
+            }
+
+            if(lin.Distance(gp_Lin(axis)) > 1e-6) {
+                myError = "直线与轴线异面!";
+                return Handle(Label_PMI)();
+            }
+
+            gp_Lin linf(axis);
+            gp_Pnt center = intersectionOfLines(linf, lin);
+            GeomAPI_ProjectPointOnCurve PPOC(touch2, new Geom_Line(linf));
+            gp_Pnt pax = PPOC.NearestPoint();
+            aLabel = new Label_Angle(valList, touch1, center, pax);
+        }
+        else {
+            myError = "所选类型不能计算角度!";
+            return Handle(Label_PMI)();
+        }
+    }
+
+    if(aLabel.IsNull()) {
+        myError = "不支持的距离类型!";
+        return Handle(Label_PMI)();
+    }
+
+    aLabel->SetShapeIndices(shapeIndices(shape1, shape2));
+    return aLabel;
+}
+
+void Label_Builder::lengthOfTwoAxis(const Bnd_Box &box, const gp_Ax1 &ax1, const gp_Ax1 &ax2, gp_Pnt &first, gp_Pnt &second, gp_Ax2 &oriention)
+{
+    gp_Pnt p1 = ax1.Location();
+    gp_Pnt p2 = ax2.Location();
+    gp_Dir pp(p1.XYZ()-p2.XYZ());
+    gp_Dir c2 = ax2.Direction();
+    gp_Dir normal = c2.Crossed(pp);
+
+    Handle(Geom_Line) line = new Geom_Line(gp_Lin(ax2));
+    GeomAPI_ProjectPointOnCurve PPC(p1,line);
+
+    gp_Pnt p3 = PPC.NearestPoint();
+
+    gp_Pnt mid = 0.5*(p1.XYZ() + p3.XYZ());
+    gp_Pnt target = targetWithBox(mid,c2,box);
+    first = p1;
+    second = p3;
+    oriention = gp_Ax2(target, normal, p3.XYZ()-p1.XYZ());
+}
+
+gp_Pnt Label_Builder::intersectionOfLines(const gp_Lin &lin1, const gp_Lin &lin2)
+{
+    gp_Pln plane = gp_Pln (lin2.Location(), gp_Vec (lin1.Direction()) ^ gp_Vec (lin2.Direction()));
+    // Find intersection
+    gp_Lin2d aFirstLin2d  = ProjLib::Project (plane, lin1);
+    gp_Lin2d aSecondLin2d = ProjLib::Project (plane, lin2);
+
+    IntAna2d_AnaIntersection anInt2d (aFirstLin2d, aSecondLin2d);
+    gp_Pnt2d anIntersectPoint = gp_Pnt2d (anInt2d.Point(1).Value());
+    gp_Pnt center = ElCLib::To3d (plane.Position().Ax2(), anIntersectPoint);
+    return center;
+}
@@ -0,0 +1,103 @@
+#ifndef LABEL_BUILDER_H
+#define LABEL_BUILDER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <Bnd_Box.hxx>
+#include <gp_Ax1.hxx>
+#include <gp_Lin.hxx>
+#include <gp_Pln.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include "Label_PMI.h"
+
+class PMIModel;
+
+//! One label to build, by the indices of its shapes in the model
+struct Label_Spec
+{
+    Label_Spec() : HasPlace(false) {}
+
+    QString Type;                          //!< Tolerance, Datum or a dimension type of Label_Builder
+    QList<int> Shapes;                     //!< indices of shapes in PMIModel
+    QList<NCollection_Utf8String> Values;  //!< the strings of label
+    QList<gp_Pnt> Touches;                 //!< picked points, a point on the shape if missing
+    gp_Dir Place;                          //!< normal of the placement plane
+    bool HasPlace;
+};
+
+//! Build and place the labels on the shapes of a model.
+//! It has no dependence on the viewer or the dialogs, so it's shared
+//! by the main window and the batch tool. A null label is returned
+//! if the shapes don't fit the label, and Error() tells the reason.
+class Label_Builder
+{
+public:
+    //! type of the dimension label, the same as the DiamensionInput combo box
+    enum DimensionType {
+        Size = 0,
+        Distance,
+        Angle,
+        Diameter,
+        Radius,
+        Taper
+    };
+
+    explicit Label_Builder(const PMIModel* model);
+
+    Handle(Label_PMI) Tolerance(const NCollection_Utf8String& tolName,
+                                const NCollection_Utf8String& tolVal,
+                                const NCollection_Utf8String& tolVal2,
+                                const QList<NCollection_Utf8String>& baseName,
+                                const TopoDS_Shape& shape,
+                                const gp_Pln& place,
+                                const gp_Pnt& touch);
+
+    Handle(Label_PMI) Dimension(const QList<NCollection_Utf8String>& valList,
+                                const TopoDS_Shape& shape1, const TopoDS_Shape& shape2,
+                                const gp_Pnt& touch1, const gp_Pnt& touch2,
+                                const gp_Pln& place, int type);
+
+    Handle(Label_PMI) Datum(const QString& str, const TopoDS_Shape& shape, const gp_Pln& place, const gp_Pnt& touch);
+
+    //! Build the label of spec, null if it doesn't fit the model
+    Handle(Label_PMI) Build(const Label_Spec& spec);
+
+    //! Build the labels of specs on every core if inParallel is true, the
+    //! labels aren't displayed. The labels and errors are in the order of
+    //! specs, a spec which isn't built has a null label and its reason
+    QList<Handle(Label_PMI)> Build(const QList<Label_Spec>& specs, QStringList& errors, bool inParallel = true) const;
+
+    //! A point on the shape, used when the spec gives no touch point
+    static gp_Pnt DefaultTouch(const TopoDS_Shape& shape);
+
+    //! The reason why the last label is not built
+    const QString& Error() const {
+        return myError;
+    }
+
+private:
+    bool checkModel();
+
+    //! Return the indices of shapes in the model, -1 for the missing ones
+    QList<int> shapeIndices(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2 = TopoDS_Shape()) const;
+
+    gp_Pnt targetWithBox(const gp_Pnt& input, const gp_Dir& dir, const Bnd_Box& box);
+
+    Handle(Label_PMI) measureLength(const Bnd_Box& box, const QList<NCollection_Utf8String> &valList,
+                                    const TopoDS_Shape &shape1, const TopoDS_Shape &shape2);
+    Handle(Label_PMI) measureAngle(const QList<NCollection_Utf8String> &valList,
+                                   const TopoDS_Shape &shape1, const TopoDS_Shape &shape2,
+                                   const gp_Pnt& touch1, const gp_Pnt& touch2);
+
+    void lengthOfTwoAxis(const Bnd_Box& box, const gp_Ax1& ax1, const gp_Ax1& ax2,
+                         gp_Pnt& first, gp_Pnt& second, gp_Ax2& oriention);
+    gp_Pnt intersectionOfLines(const gp_Lin& lin1, const gp_Lin& lin2);
+
+    const PMIModel* myModel;
+    QString myError;
+};
+
+#endif // LABEL_BUILDER_H
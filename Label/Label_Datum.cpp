@@ -1,6 +1,5 @@
 ﻿#include "Label_Datum.h"
 
-#include <BRepBuilderAPI_MakeEdge.hxx>
 #include <Font_BRepTextBuilder.hxx>
 #include <Prs3d_Arrow.hxx>
 #include <Prs3d_ShadingAspect.hxx>
@@ -31,9 +30,32 @@ void Label_Datum::SetLocation(const gp_Pnt &pnt)
     gp_Pnt pp = PPC.NearestPoint();
 
     myOrientation3D.SetLocation(pp);
-    this->SetToUpdate();
-    this->UpdatePresentations();
-    this->GetContext()->RecomputeSelectionOnly(this);
+    updatePosture();
+}
+
+gp_Pnt Label_Datum::AllowedLocation(const gp_Pnt &thePnt) const
+{
+    const gp_XYZ aDir = myOrientation3D.YDirection().XYZ();
+    const gp_XYZ anOrigin = myOrientation3D.Location().XYZ();
+    return gp_Pnt(anOrigin + (thePnt.XYZ() - anOrigin).Dot(aDir) * aDir);
+}
+
+void Label_Datum::SaveRecord(Label_Record &theRecord) const
+{
+    Label_PMI::SaveRecord(theRecord);
+    theRecord.Type = Label_Record::Datum;
+    theRecord.Strings = { myDatumName };
+    theRecord.Points = { myTouchPoint };
+}
+
+Standard_Boolean Label_Datum::LoadRecord(const Label_Record &theRecord)
+{
+    if(theRecord.Type != Label_Record::Datum || theRecord.Strings.isEmpty() || theRecord.Points.isEmpty())
+        return Standard_False;
+
+    SetDatumName(theRecord.Strings[0]);
+    SetTouchPoint(theRecord.Points[0]);
+    return Label_PMI::LoadRecord(theRecord);
 }
 
 void Label_Datum::SetPosture(const gp_Pnt &touchPnt, const gp_Ax2 &oriention)
@@ -45,6 +67,7 @@ void Label_Datum::SetPosture(const gp_Pnt &touchPnt, const gp_Ax2 &oriention)
 void Label_Datum::SetDatumName (const NCollection_Utf8String &name)
 {
     myDatumName = name;
+    invalidateText();
 }
 
 void Label_Datum::SetTouchPoint(const gp_Pnt &touchPnt)
@@ -63,7 +86,8 @@ void Label_Datum::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsM
 {
     switch (theMode)
     {
-    case 0:
+    case GlyphMode:
+    case TextMode:
     {
         // 0. verify the data
         if(myDatumName.IsEmpty())
@@ -88,14 +112,11 @@ void Label_Datum::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsM
         Handle(Prs3d_LineAspect) linAspect = new Prs3d_LineAspect(myLabelColor, Aspect_TOL_SOLID, 1);
 
         // 3.draw the datum str and it's bound box
-        TopoDS_Shape strShape = ComputeStringList({myDatumName}, myLabelWidth);
-        StdPrs_ShadedShape::Add(thePrs,strShape,myDrawer);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect(anAspect->Aspect());
-        StdPrs_ShadedShape::AddWireframeForFreeElements(thePrs,strShape,myDrawer);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect(linAspect->Aspect());
+        const TextMesh& strMesh = ComputeStringList({myDatumName}, myLabelWidth);
+        drawText(thePrs, theMode, strMesh, calculateOrientionTrsf(), anAspect, linAspect);
 
         // 4.draw the lead wire
-        appendLeadOfLabel(thePrs,anAspect);
+        drawLead(thePrs,theMode,anAspect);
 
         break;
     }
@@ -134,8 +155,7 @@ void Label_Datum::ComputeSelection (const Handle(SelectMgr_Selection)& theSelect
     }
 }
 
-void Label_Datum::appendLeadOfLabel(const Handle(Prs3d_Presentation)& thePrs,
-                                    const Handle(Prs3d_ShadingAspect)& anAspect)
+void Label_Datum::computeLead(LeadGeometry& theLead)
 {
     gp_Trsf apply = calculateOrientionTrsf();
     Standard_Real aWidth = calculateStringWidth(myDatumName);
@@ -157,26 +177,15 @@ void Label_Datum::appendLeadOfLabel(const Handle(Prs3d_Presentation)& thePrs,
     gp_Pnt baseTop;
     if(midBase.Distance(midBottom) < midBase.Distance(midTop)) {
         baseTop = midBase.Translated(gp_Vec(midBase,midBottom).Normalized()*3*1.732);
-
-        BRepBuilderAPI_MakeEdge aBuilder(midBase,midBottom);
-        StdPrs_ShadedShape::Add(thePrs,aBuilder.Shape(),myDrawer);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+        theLead.AddSegment(midBase,midBottom);
     }
     else {
         baseTop = midBase.Translated(gp_Vec(midBase,midBottom).Normalized()*3*1.732);
-
-        BRepBuilderAPI_MakeEdge aBuilder(midBase,midTop);
-        StdPrs_ShadedShape::Add(thePrs,aBuilder.Shape(),myDrawer);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+        theLead.AddSegment(midBase,midTop);
     }
 
     double distance = qMin(midBase.Distance(midBottom), midBase.Distance(midTop));
     if(distance > 0.7*myFontHeight) {
-        Handle(Graphic3d_ArrayOfTriangles) aTriangle = new Graphic3d_ArrayOfTriangles(3);
-        aTriangle->AddVertex (baseStart);
-        aTriangle->AddVertex (baseEnd);
-        aTriangle->AddVertex (baseTop);
-        thePrs->CurrentGroup()->AddPrimitiveArray (aTriangle);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+        theLead.AddTriangle(baseStart,baseEnd,baseTop);
     }
 }
@@ -14,6 +14,15 @@ public:
     //! Set location of shape, interface for drafting
     virtual void SetLocation(const gp_Pnt& pnt) override;
 
+    //! The projection on the line of the datum
+    virtual gp_Pnt AllowedLocation(const gp_Pnt& thePnt) const Standard_OVERRIDE;
+
+    //! Store the type, strings and points of label
+    virtual void SaveRecord(Label_Record& theRecord) const Standard_OVERRIDE;
+
+    //! Rebuild the label from the record
+    virtual Standard_Boolean LoadRecord(const Label_Record& theRecord) Standard_OVERRIDE;
+
     //! Setup position.
     void SetPosture (const gp_Pnt& touchPnt, const gp_Ax2& oriention);
 
@@ -43,8 +52,7 @@ protected:
                                    const Standard_Integer theMode) Standard_OVERRIDE;
 
     //! Add the arrow between touch point and label
-    void appendLeadOfLabel(const Handle(Prs3d_Presentation)& thePrs,
-                           const Handle(Prs3d_ShadingAspect)& anAspect);
+    virtual void computeLead(LeadGeometry& theLead) Standard_OVERRIDE;
 
 protected:
 
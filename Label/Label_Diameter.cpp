@@ -1,6 +1,5 @@
 ﻿#include "Label_Diameter.h"
 
-#include <BRepBuilderAPI_MakeEdge.hxx>
 #include <Font_BRepTextBuilder.hxx>
 #include <Prs3d_Arrow.hxx>
 #include <Prs3d_ShadingAspect.hxx>
@@ -44,9 +43,25 @@ void Label_Diameter::SetLocation(const gp_Pnt &pnt)
 
     myOrientation3D.SetLocation(pp);
     myOrientation3D.SetXDirection(pp.XYZ()-myCircle.Location().XYZ());
-    this->SetToUpdate();
-    this->UpdatePresentations();
-    this->GetContext()->RecomputeSelectionOnly(this);
+    updatePosture();
+}
+
+void Label_Diameter::SaveRecord(Label_Record &theRecord) const
+{
+    Label_PMI::SaveRecord(theRecord);
+    theRecord.Type = Label_Record::Diameter;
+    theRecord.Strings = { myMainStr, mySUPStr, mySUBStr };
+    theRecord.Circle = myCircle;
+}
+
+Standard_Boolean Label_Diameter::LoadRecord(const Label_Record &theRecord)
+{
+    if(theRecord.Type != Label_Record::Diameter || theRecord.Strings.size() < 3)
+        return Standard_False;
+
+    SetData(theRecord.Strings[0], theRecord.Strings[1], theRecord.Strings[2]);
+    SetDiamension(theRecord.Circle);
+    return Label_PMI::LoadRecord(theRecord);
 }
 
 void Label_Diameter::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsMgr*/,
@@ -55,7 +70,8 @@ void Label_Diameter::Compute (const Handle(PrsMgr_PresentationManager3d)& /*theP
 {
     switch (theMode)
     {
-    case 0:
+    case GlyphMode:
+    case TextMode:
     {
         // 0. verify the data
         if(myMainStr.IsEmpty())
@@ -77,12 +93,11 @@ void Label_Diameter::Compute (const Handle(PrsMgr_PresentationManager3d)& /*theP
         anAspect->SetColor(myLabelColor);
 
         // 3.draw the main&sup&sub string
-        TopoDS_Shape strShape = ComputeStringWithSupAndSub(myMainStr,mySUBStr,mySUPStr,myLabelWidth);
-        StdPrs_ShadedShape::Add(thePrs,strShape,myDrawer);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect(anAspect->Aspect());
+        const TextMesh& strMesh = ComputeStringWithSupAndSub(myMainStr,mySUBStr,mySUPStr,myLabelWidth);
+        drawText(thePrs, theMode, strMesh, calculateOrientionTrsf(), anAspect);
 
         // 4.draw the fly out line and arrow
-        ComputeLeadLine(thePrs, anAspect);
+        drawLead(thePrs, theMode, anAspect);
 
         break;
     }
@@ -121,8 +136,7 @@ void Label_Diameter::ComputeSelection (const Handle(SelectMgr_Selection)& theSel
     }
 }
 
-void Label_Diameter::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
-                                      const Handle(Prs3d_ShadingAspect)& anAspect)
+void Label_Diameter::computeLead(LeadGeometry& theLead)
 {
     const gp_Pnt textFirst = myOrientation3D.Location();
     const gp_Pnt textSecond = gp_Pnt(myLabelWidth, 0, 0).Transformed(calculateOrientionTrsf());
@@ -146,9 +160,7 @@ void Label_Diameter::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
         arrowDir = direc;
     }
     // draw the line
-    TopoDS_Shape leadLin = BRepBuilderAPI_MakeEdge(lead2, lead1);
-    StdPrs_ShadedShape::Add(thePrs,leadLin,myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddSegment(lead2, lead1);
 
     // draw the arrow triangle
     // the arrow close to the text
@@ -157,22 +169,12 @@ void Label_Diameter::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
     gp_Pnt arrowL1 = arrowMid1.Translated(0.5*arrowBotm);
     gp_Pnt arrowR1 = arrowMid1.Translated(0.5*arrowBotm.Reversed());
 
-    Handle(Graphic3d_ArrayOfTriangles) aTriangle = new Graphic3d_ArrayOfTriangles(3);
-    aTriangle->AddVertex (arrowL1);
-    aTriangle->AddVertex (circP1);
-    aTriangle->AddVertex (arrowR1);
-    thePrs->CurrentGroup()->AddPrimitiveArray(aTriangle);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddTriangle(arrowL1, circP1, arrowR1);
 
     // the arrow fra from the text
     gp_Pnt arrowMid2 = circP2.Translated(4*arrowDir.Reversed());
     gp_Pnt arrowL2 = arrowMid2.Translated(0.5*arrowBotm);
     gp_Pnt arrowR2 = arrowMid2.Translated(0.5*arrowBotm.Reversed());
 
-    Handle(Graphic3d_ArrayOfTriangles) bTriangle = new Graphic3d_ArrayOfTriangles(3);
-    bTriangle->AddVertex (arrowL2);
-    bTriangle->AddVertex (circP2);
-    bTriangle->AddVertex (arrowR2);
-    thePrs->CurrentGroup()->AddPrimitiveArray(bTriangle);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddTriangle(arrowL2, circP2, arrowR2);
 }
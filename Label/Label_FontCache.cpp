@@ -0,0 +1,156 @@
+#include "Label_FontCache.h"
+
+#include <Font_BRepTextBuilder.hxx>
+#include <Font_FontMgr.hxx>
+#include <Font_SystemFont.hxx>
+#include <Prs3d_Drawer.hxx>
+#include <StdPrs_ShadedShape.hxx>
+#include <StdPrs_ToolTriangulatedShape.hxx>
+
+#include <QMutexLocker>
+
+Label_FontCache &Label_FontCache::Instance()
+{
+    static Label_FontCache aCache;
+    return aCache;
+}
+
+Label_FontCache::~Label_FontCache()
+{
+    Clear();
+}
+
+Standard_Real Label_FontCache::AdvanceX(const NCollection_String &thePath, const Standard_Real theHeight,
+                                        const Standard_Utf32Char theChar, const Standard_Utf32Char theNextChar)
+{
+    QMutexLocker aLocker(&myMutex);
+    return advance(entry(thePath, theHeight), theChar, theNextChar);
+}
+
+Standard_Real Label_FontCache::StringWidth(const NCollection_String &thePath, const Standard_Real theHeight,
+                                           const NCollection_Utf8String &theStr)
+{
+    if(theStr.IsEmpty())
+        return 0;
+
+    QMutexLocker aLocker(&myMutex);
+    FontEntry* anEntry = entry(thePath, theHeight);
+
+    const QByteArray aKey(theStr.ToCString(), theStr.Size());
+    QHash<QByteArray, Standard_Real>::ConstIterator anIter = anEntry->Widths.constFind(aKey);
+    if(anIter != anEntry->Widths.constEnd())
+        return anIter.value();
+
+    Standard_Real tWidth = 0;
+    for(NCollection_Utf8Iter aCharIter = theStr.Iterator(); *aCharIter != 0; ) {
+        Standard_Utf32Char aCurrChar = *aCharIter;
+        Standard_Utf32Char aNextChar = *(++aCharIter);
+        tWidth += advance(anEntry, aCurrChar, aNextChar);
+    }
+
+    anEntry->Widths.insert(aKey, tWidth);
+    return tWidth;
+}
+
+TopoDS_Shape Label_FontCache::StringShape(const NCollection_String &thePath, const Standard_Real theHeight,
+                                          const NCollection_Utf8String &theStr)
+{
+    if(theStr.IsEmpty())
+        return TopoDS_Shape();
+
+    QMutexLocker aLocker(&myMutex);
+    return shape(entry(thePath, theHeight), theStr);
+}
+
+Handle(Graphic3d_ArrayOfTriangles) Label_FontCache::StringTriangles(const NCollection_String &thePath, const Standard_Real theHeight,
+                                                                    const NCollection_Utf8String &theStr)
+{
+    if(theStr.IsEmpty())
+        return Handle(Graphic3d_ArrayOfTriangles)();
+
+    QMutexLocker aLocker(&myMutex);
+    FontEntry* anEntry = entry(thePath, theHeight);
+
+    const QByteArray aKey(theStr.ToCString(), theStr.Size());
+    QHash<QByteArray, Handle(Graphic3d_ArrayOfTriangles)>::ConstIterator anIter = anEntry->Meshes.constFind(aKey);
+    if(anIter != anEntry->Meshes.constEnd())
+        return anIter.value();
+
+    // the string shape is shared, it's meshed only once under the lock
+    Handle(Graphic3d_ArrayOfTriangles) aTriangles;
+    TopoDS_Shape aShape = shape(anEntry, theStr);
+    if(!aShape.IsNull()) {
+        Handle(Prs3d_Drawer) aDrawer = new Prs3d_Drawer();
+        StdPrs_ToolTriangulatedShape::Tessellate(aShape, aDrawer);
+        aTriangles = StdPrs_ShadedShape::FillTriangles(aShape);
+    }
+
+    anEntry->Meshes.insert(aKey, aTriangles);
+    return aTriangles;
+}
+
+TCollection_AsciiString Label_FontCache::TextFontName(const NCollection_String &thePath)
+{
+    QMutexLocker aLocker(&myMutex);
+    const QString aKey = QString::fromUtf8(thePath.ToCString());
+    QHash<QString, TCollection_AsciiString>::ConstIterator anIter = myTextFonts.constFind(aKey);
+    if(anIter != myTextFonts.constEnd())
+        return anIter.value();
+
+    // the viewer finds the fonts by name, not by file
+    TCollection_AsciiString aName;
+    Handle(Font_FontMgr) aFontMgr = Font_FontMgr::GetInstance();
+    Handle(Font_SystemFont) aFont = aFontMgr->CheckFont(thePath.ToCString());
+    if(!aFont.IsNull()) {
+        aFontMgr->RegisterFont(aFont, Standard_False);
+        aName = aFont->FontName();
+    }
+    myTextFonts.insert(aKey, aName);
+    return aName;
+}
+
+void Label_FontCache::Clear()
+{
+    QMutexLocker aLocker(&myMutex);
+    qDeleteAll(myFonts);
+    myFonts.clear();
+}
+
+Label_FontCache::FontEntry *Label_FontCache::entry(const NCollection_String &thePath, const Standard_Real theHeight)
+{
+    const QPair<QString, Standard_Real> aKey(QString::fromUtf8(thePath.ToCString()), theHeight);
+    QHash<QPair<QString, Standard_Real>, FontEntry*>::ConstIterator anIter = myFonts.constFind(aKey);
+    if(anIter != myFonts.constEnd())
+        return anIter.value();
+
+    FontEntry* anEntry = new FontEntry();
+    anEntry->Font = new Font_BRepFont(thePath, theHeight);
+    myFonts.insert(aKey, anEntry);
+    return anEntry;
+}
+
+TopoDS_Shape Label_FontCache::shape(FontEntry *theEntry, const NCollection_Utf8String &theStr)
+{
+    const QByteArray aKey(theStr.ToCString(), theStr.Size());
+    QHash<QByteArray, TopoDS_Shape>::ConstIterator anIter = theEntry->Strings.constFind(aKey);
+    if(anIter != theEntry->Strings.constEnd())
+        return anIter.value();
+
+    // the glyphs are rendered only once by the font, the builder just places them
+    Font_BRepTextBuilder aTextBuilder;
+    TopoDS_Shape aShape = aTextBuilder.Perform(*theEntry->Font, theStr);
+    theEntry->Strings.insert(aKey, aShape);
+    return aShape;
+}
+
+Standard_Real Label_FontCache::advance(FontEntry *theEntry, const Standard_Utf32Char theChar, const Standard_Utf32Char theNextChar)
+{
+    const quint64 aKey = (quint64(theChar) << 32) | quint64(theNextChar);
+    QHash<quint64, Standard_Real>::ConstIterator anIter = theEntry->Advances.constFind(aKey);
+    if(anIter != theEntry->Advances.constEnd())
+        return anIter.value();
+
+    Standard_Real anAdvance = theEntry->Font->AdvanceX(theChar, theNextChar);
+    theEntry->Advances.insert(aKey, anAdvance);
+    return anAdvance;
+}
@@ -0,0 +1,79 @@
+#ifndef LABEL_FONTCACHE_H
+#define LABEL_FONTCACHE_H
+
+#include <Font_BRepFont.hxx>
+#include <Graphic3d_ArrayOfTriangles.hxx>
+#include <NCollection_String.hxx>
+#include <NCollection_UtfString.hxx>
+#include <TCollection_AsciiString.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+//! Process-wide cache of BRep fonts used by the PMI labels.
+//! Fonts are keyed by (font path, height); every entry also memoizes
+//! the advance of each glyph pair, the shape and the triangles of every
+//! shaped string, glyph outlines are memoized by Font_BRepFont itself.
+//! All methods are thread-safe.
+class Label_FontCache
+{
+public:
+    //! Return the global instance
+    static Label_FontCache& Instance();
+
+    //! Return the advance between two glyphs
+    Standard_Real AdvanceX(const NCollection_String& thePath, const Standard_Real theHeight,
+                           const Standard_Utf32Char theChar, const Standard_Utf32Char theNextChar);
+
+    //! Return the width of the string
+    Standard_Real StringWidth(const NCollection_String& thePath, const Standard_Real theHeight,
+                              const NCollection_Utf8String& theStr);
+
+    //! Return the shape of the string placed on plane XOY, the shape is shared, don't modify it
+    TopoDS_Shape StringShape(const NCollection_String& thePath, const Standard_Real theHeight,
+                             const NCollection_Utf8String& theStr);
+
+    //! Return the triangles of the string placed on plane XOY, the array is shared, don't modify it
+    Handle(Graphic3d_ArrayOfTriangles) StringTriangles(const NCollection_String& thePath, const Standard_Real theHeight,
+                                                       const NCollection_Utf8String& theStr);
+
+    //! Return the name of the font file for the text drawn by the viewer,
+    //! it's registered once in Font_FontMgr, empty if the file isn't a font
+    TCollection_AsciiString TextFontName(const NCollection_String& thePath);
+
+    //! Release all the fonts
+    void Clear();
+
+private:
+    Label_FontCache() {}
+    Label_FontCache(const Label_FontCache&);
+    Label_FontCache& operator=(const Label_FontCache&);
+    ~Label_FontCache();
+
+    struct FontEntry
+    {
+        Handle(Font_BRepFont) Font;
+        QHash<quint64, Standard_Real> Advances;
+        QHash<QByteArray, TopoDS_Shape> Strings;
+        QHash<QByteArray, Standard_Real> Widths;
+        QHash<QByteArray, Handle(Graphic3d_ArrayOfTriangles)> Meshes;
+    };
+
+    //! Find or create the entry, the mutex must be locked
+    FontEntry* entry(const NCollection_String& thePath, const Standard_Real theHeight);
+
+    //! Shape of a string, the mutex must be locked
+    TopoDS_Shape shape(FontEntry* theEntry, const NCollection_Utf8String& theStr);
+
+    //! Advance of a glyph pair, the mutex must be locked
+    Standard_Real advance(FontEntry* theEntry, const Standard_Utf32Char theChar, const Standard_Utf32Char theNextChar);
+
+    QMutex myMutex;
+    QHash<QPair<QString, Standard_Real>, FontEntry*> myFonts;
+    QHash<QString, TCollection_AsciiString> myTextFonts;
+};
+
+#endif // LABEL_FONTCACHE_H
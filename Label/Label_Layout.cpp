@@ -0,0 +1,398 @@
+#include "Label_Layout.h"
+#include "Label_LazyDisplay.h"
+
+#include <Precision.hxx>
+
+#include <cmath>
+
+// size of the grid cells in pixels, about a label of a few characters
+static const double CELL_SIZE = 64;
+// the cells out of the view are folded into a border of this many cells
+static const int CELL_BORDER = 8;
+// rings of places tried around a label, 8 places in each ring
+static const int RING_COUNT = 4;
+static const int RING_PLACES = 8;
+
+// the cost of a pixel covered by another label is the unit
+static const double CROSSING_COST = 400;   // a lead crossing another lead
+static const double LEAD_OVER_COST = 200;  // a lead through the text of another label
+static const double MOVE_COST = 1;         // a pixel moved from the current location
+
+//! Whether two segments cross each other, touching at the ends doesn't count
+static bool segmentsCross(const QLineF& a, const QLineF& b)
+{
+    const auto side = [](const QPointF& p, const QPointF& q, const QPointF& r) {
+        return (q.x() - p.x()) * (r.y() - p.y()) - (q.y() - p.y()) * (r.x() - p.x());
+    };
+    const double d1 = side(a.p1(), a.p2(), b.p1());
+    const double d2 = side(a.p1(), a.p2(), b.p2());
+    const double d3 = side(b.p1(), b.p2(), a.p1());
+    const double d4 = side(b.p1(), b.p2(), a.p2());
+    return ((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0));
+}
+
+//! Whether the segment goes through the rectangle
+static bool segmentCrossesRect(const QLineF& line, const QRectF& rect)
+{
+    if(rect.contains(line.p1()) || rect.contains(line.p2()))
+        return true;
+    const QLineF edges[4] = {
+        QLineF(rect.topLeft(), rect.topRight()), QLineF(rect.topRight(), rect.bottomRight()),
+        QLineF(rect.bottomRight(), rect.bottomLeft()), QLineF(rect.bottomLeft(), rect.topLeft())
+    };
+    for(int i=0;i<4;++i) {
+        if(segmentsCross(line, edges[i]))
+            return true;
+    }
+    return false;
+}
+
+static QRectF boundsOf(const QLineF& line)
+{
+    return QRectF(line.p1(), line.p2()).normalized();
+}
+
+Label_Layout::Label_Layout()
+    : myLazyDisplay(nullptr),
+      myWidth(0),
+      myHeight(0),
+      myStamp(0)
+{
+}
+
+void Label_Layout::Reset(const QList<Handle(Label_PMI)> &theLabels, const Handle(Graphic3d_Camera) &theCamera,
+                         const int theWidth, const int theHeight)
+{
+    myCamera = theCamera;
+    if(!theCamera.IsNull())
+        myCameraState = theCamera->WorldViewProjState();
+    myWidth = theWidth;
+    myHeight = theHeight;
+
+    myEntries.clear();
+    myIndices.clear();
+    myBoxes.clear();
+    myLeads.clear();
+    myEntries.reserve(theLabels.size());
+    for(int i=0;i<theLabels.size();++i) {
+        if(theLabels[i].IsNull() || myIndices.contains(theLabels[i].get()))
+            continue;
+
+        Entry anEntry;
+        anEntry.Label = theLabels[i];
+        anEntry.Target = theLabels[i]->LeadTarget();
+        anEntry.Width = theLabels[i]->TextWidth();
+        anEntry.Placed = false;
+        myIndices.insert(theLabels[i].get(), myEntries.size());
+        myEntries.append(anEntry);
+    }
+    myStamps.fill(0, myEntries.size());
+    myStamp = 0;
+
+    for(int i=0;i<myEntries.size();++i) {
+        Entry& anEntry = myEntries[i];
+        measure(anEntry, anEntry.Label->Orientation3D().Location(), anEntry.Box, anEntry.Lead);
+        insert(i);
+    }
+}
+
+Standard_Boolean Label_Layout::IsCurrent(const Handle(Graphic3d_Camera) &theCamera,
+                                         const int theWidth, const int theHeight) const
+{
+    if(myCamera.IsNull() || myCamera != theCamera || myWidth != theWidth || myHeight != theHeight)
+        return Standard_False;
+    Graphic3d_WorldViewProjState aState = myCameraState;
+    return !aState.IsChanged(theCamera->WorldViewProjState());
+}
+
+void Label_Layout::Add(const Handle(Label_PMI) &theLabel)
+{
+    if(theLabel.IsNull() || myCamera.IsNull() || myIndices.contains(theLabel.get()))
+        return;
+    const int anIndex = entryOf(theLabel);
+    Entry& anEntry = myEntries[anIndex];
+    measure(anEntry, anEntry.Label->Orientation3D().Location(), anEntry.Box, anEntry.Lead);
+    insert(anIndex);
+}
+
+int Label_Layout::Solve()
+{
+    for(int i=0;i<myEntries.size();++i)
+        remove(i);
+
+    int aMoved = 0;
+    for(int i=0;i<myEntries.size();++i) {
+        if(placeEntry(i))
+            ++aMoved;
+    }
+    return aMoved;
+}
+
+Standard_Boolean Label_Layout::Place(const Handle(Label_PMI) &theLabel)
+{
+    if(theLabel.IsNull() || myCamera.IsNull())
+        return Standard_False;
+
+    return placeEntry(entryOf(theLabel));
+}
+
+int Label_Layout::Pin(const Handle(Label_PMI) &theLabel)
+{
+    if(theLabel.IsNull() || myCamera.IsNull())
+        return 0;
+
+    const int anIndex = entryOf(theLabel);
+    remove(anIndex);
+    Entry& aPinned = myEntries[anIndex];
+    measure(aPinned, aPinned.Label->Orientation3D().Location(), aPinned.Box, aPinned.Lead);
+    insert(anIndex);
+
+    // the covered labels make way, the pinned one is already in the grid
+    const QVector<int> aCovered = query(myBoxes, aPinned.Box);
+    int aMoved = 0;
+    for(int i=0;i<aCovered.size();++i) {
+        const int j = aCovered[i];
+        if(j != anIndex && myEntries[j].Box.intersects(myEntries[anIndex].Box) && placeEntry(j))
+            ++aMoved;
+    }
+    return aMoved;
+}
+
+QPointF Label_Layout::project(const gp_Pnt &thePnt) const
+{
+    const gp_Pnt aNdc = myCamera->Project(thePnt);
+    return QPointF(0.5 * (aNdc.X() + 1.0) * myWidth, 0.5 * (1.0 - aNdc.Y()) * myHeight);
+}
+
+void Label_Layout::measure(const Entry &theEntry, const gp_Pnt &theLocation, QRectF &theBox, QLineF &theLead) const
+{
+    const Handle(Label_PMI)& aLabel = theEntry.Label;
+    const gp_Trsf& aTrsf = aLabel->LocalTransformation();
+    const gp_XYZ aX = aLabel->Orientation3D().XDirection().XYZ();
+    const gp_XYZ aY = aLabel->Orientation3D().YDirection().XYZ();
+    const Standard_Real aHeight = aLabel->Height();
+
+    // the text box as StringBox, its padding is in the width already
+    const Standard_Real aPadding = aLabel->Padding();
+    const Standard_Real xs[2] = { -aPadding, theEntry.Width - aPadding };
+    const Standard_Real ys[2] = { -0.3 * aHeight, aHeight };
+    double x1 = RealLast(), y1 = RealLast(), x2 = -RealLast(), y2 = -RealLast();
+    for(int i=0;i<4;++i) {
+        const gp_Pnt aCorner(theLocation.XYZ() + xs[i & 1] * aX + ys[i >> 1] * aY);
+        const QPointF p = project(aCorner.Transformed(aTrsf));
+        x1 = Min(x1, p.x());
+        y1 = Min(y1, p.y());
+        x2 = Max(x2, p.x());
+        y2 = Max(y2, p.y());
+    }
+    theBox = QRectF(QPointF(x1, y1), QPointF(x2, y2));
+    theLead = QLineF(project(theLocation.Transformed(aTrsf)), project(theEntry.Target.Transformed(aTrsf)));
+}
+
+Standard_Real Label_Layout::cost(int theIndex, const QRectF &theBox, const QLineF &theLead) const
+{
+    Standard_Real aCost = 0;
+
+    // 1.the area covered by the other labels
+    const QVector<int> aBoxes = query(myBoxes, theBox.united(boundsOf(theLead)));
+    for(int i=0;i<aBoxes.size();++i) {
+        const Entry& anOther = myEntries[aBoxes[i]];
+        if(aBoxes[i] == theIndex)
+            continue;
+        const QRectF aCommon = theBox.intersected(anOther.Box);
+        if(!aCommon.isEmpty())
+            aCost += aCommon.width() * aCommon.height();
+        if(segmentCrossesRect(theLead, anOther.Box) || segmentCrossesRect(anOther.Lead, theBox))
+            aCost += LEAD_OVER_COST;
+    }
+
+    // 2.the leads crossing each other
+    const QVector<int> aLeads = query(myLeads, boundsOf(theLead));
+    for(int i=0;i<aLeads.size();++i) {
+        if(aLeads[i] != theIndex && segmentsCross(theLead, myEntries[aLeads[i]].Lead))
+            aCost += CROSSING_COST;
+    }
+    return aCost;
+}
+
+Standard_Boolean Label_Layout::placeEntry(int theIndex)
+{
+    remove(theIndex);
+    Entry& anEntry = myEntries[theIndex];
+    const Handle(Label_PMI)& aLabel = anEntry.Label;
+    const gp_Ax2& anAxes = aLabel->Orientation3D();
+    const gp_Pnt anOrigin = anAxes.Location();
+
+    QRectF aBox;
+    QLineF aLead;
+    measure(anEntry, anOrigin, aBox, aLead);
+    Standard_Real aBest = cost(theIndex, aBox, aLead);
+
+    // pixels of a model unit on the plane of label, the rings are a text height apart
+    const gp_Trsf& aTrsf = aLabel->LocalTransformation();
+    const QPointF anOriginPx = project(anOrigin.Transformed(aTrsf));
+    const QPointF aXPx = project(anOrigin.Translated(gp_Vec(anAxes.XDirection())).Transformed(aTrsf));
+    const QPointF aYPx = project(anOrigin.Translated(gp_Vec(anAxes.YDirection())).Transformed(aTrsf));
+    const double aScale = qMax(QLineF(anOriginPx, aXPx).length(), QLineF(anOriginPx, aYPx).length());
+    if(aBest <= 0 || aScale <= Precision::Confusion()) {
+        anEntry.Box = aBox;
+        anEntry.Lead = aLead;
+        insert(theIndex);
+        return Standard_False;
+    }
+    const double aStep = qMax(aBox.height(), 16.0) / aScale;
+
+    gp_Pnt aBestPnt = anOrigin;
+    for(int ring=1;ring<=RING_COUNT && aBest > 0;++ring) {
+        for(int k=0;k<RING_PLACES;++k) {
+            const double anAngle = 2 * M_PI * k / RING_PLACES;
+            const gp_XYZ anOffset = ring * aStep * (std::cos(anAngle) * anAxes.XDirection().XYZ()
+                                                    + std::sin(anAngle) * anAxes.YDirection().XYZ());
+            const gp_Pnt aPlace = aLabel->AllowedLocation(gp_Pnt(anOrigin.XYZ() + anOffset));
+
+            QRectF aPlaceBox;
+            QLineF aPlaceLead;
+            measure(anEntry, aPlace, aPlaceBox, aPlaceLead);
+            const Standard_Real aCost = cost(theIndex, aPlaceBox, aPlaceLead)
+                    + MOVE_COST * QLineF(anOriginPx, project(aPlace.Transformed(aTrsf))).length();
+            if(aCost < aBest) {
+                aBest = aCost;
+                aBestPnt = aPlace;
+            }
+        }
+    }
+
+    const Standard_Boolean isMoved = aBestPnt.Distance(anOrigin) > Precision::Confusion();
+    if(isMoved) {
+        aLabel->SetLocation(aBestPnt);
+        if(myLazyDisplay)
+            myLazyDisplay->Moved(aLabel);
+    }
+
+    // the label may turn with the location, measure it where it is
+    measure(anEntry, aLabel->Orientation3D().Location(), anEntry.Box, anEntry.Lead);
+    insert(theIndex);
+    return isMoved;
+}
+
+int Label_Layout::entryOf(const Handle(Label_PMI) &theLabel)
+{
+    int anIndex = myIndices.value(theLabel.get(), -1);
+    if(anIndex >= 0)
+        return anIndex;
+
+    Entry anEntry;
+    anEntry.Label = theLabel;
+    anEntry.Target = theLabel->LeadTarget();
+    anEntry.Width = theLabel->TextWidth();
+    anEntry.Placed = false;
+    anIndex = myEntries.size();
+    myIndices.insert(theLabel.get(), anIndex);
+    myEntries.append(anEntry);
+    myStamps.append(0);
+    return anIndex;
+}
+
+void Label_Layout::insert(int theIndex)
+{
+    Entry& anEntry = myEntries[theIndex];
+    if(anEntry.Placed)
+        return;
+    addToGrid(myBoxes, anEntry.Box, theIndex);
+    addToGrid(myLeads, boundsOf(anEntry.Lead), theIndex);
+    anEntry.Placed = true;
+}
+
+void Label_Layout::remove(int theIndex)
+{
+    Entry& anEntry = myEntries[theIndex];
+    if(!anEntry.Placed)
+        return;
+    removeFromGrid(myBoxes, anEntry.Box, theIndex);
+    removeFromGrid(myLeads, boundsOf(anEntry.Lead), theIndex);
+    anEntry.Placed = false;
+}
+
+//! The range of cells covering rect, the far ones are folded into the border
+static void cellRange(const QRectF& rect, int& x1, int& y1, int& x2, int& y2)
+{
+    const auto cell = [](double v) {
+        const double c = std::floor(v / CELL_SIZE);
+        return int(qBound(-1.0e6, c, 1.0e6));
+    };
+    x1 = cell(rect.left());
+    y1 = cell(rect.top());
+    x2 = cell(rect.right());
+    y2 = cell(rect.bottom());
+}
+
+static quint64 cellKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint64(quint32(y));
+}
+
+//! Fold the cells far out of the view, so a label off the screen costs a few cells
+static void foldRange(int& x1, int& y1, int& x2, int& y2)
+{
+    const int aLimit = 4096 / int(CELL_SIZE) + CELL_BORDER;
+    x1 = qBound(-CELL_BORDER, x1, aLimit);
+    y1 = qBound(-CELL_BORDER, y1, aLimit);
+    x2 = qBound(-CELL_BORDER, x2, aLimit);
+    y2 = qBound(-CELL_BORDER, y2, aLimit);
+}
+
+void Label_Layout::addToGrid(Grid &theGrid, const QRectF &theRect, int theIndex)
+{
+    int x1, y1, x2, y2;
+    cellRange(theRect, x1, y1, x2, y2);
+    foldRange(x1, y1, x2, y2);
+    for(int x=x1;x<=x2;++x) {
+        for(int y=y1;y<=y2;++y)
+            theGrid[cellKey(x, y)].append(theIndex);
+    }
+}
+
+void Label_Layout::removeFromGrid(Grid &theGrid, const QRectF &theRect, int theIndex)
+{
+    int x1, y1, x2, y2;
+    cellRange(theRect, x1, y1, x2, y2);
+    foldRange(x1, y1, x2, y2);
+    for(int x=x1;x<=x2;++x) {
+        for(int y=y1;y<=y2;++y) {
+            Grid::iterator anIter = theGrid.find(cellKey(x, y));
+            if(anIter == theGrid.end())
+                continue;
+            anIter.value().removeOne(theIndex);
+            if(anIter.value().isEmpty())
+                theGrid.erase(anIter);
+        }
+    }
+}
+
+QVector<int> Label_Layout::query(const Grid &theGrid, const QRectF &theRect) const
+{
+    QVector<int> aResult;
+    if(++myStamp == 0) {
+        myStamps.fill(0);
+        myStamp = 1;
+    }
+
+    int x1, y1, x2, y2;
+    cellRange(theRect, x1, y1, x2, y2);
+    foldRange(x1, y1, x2, y2);
+    for(int x=x1;x<=x2;++x) {
+        for(int y=y1;y<=y2;++y) {
+            Grid::const_iterator anIter = theGrid.constFind(cellKey(x, y));
+            if(anIter == theGrid.constEnd())
+                continue;
+            const QVector<int>& aCell = anIter.value();
+            for(int i=0;i<aCell.size();++i) {
+                if(myStamps[aCell[i]] != myStamp) {
+                    myStamps[aCell[i]] = myStamp;
+                    aResult.append(aCell[i]);
+                }
+            }
+        }
+    }
+    return aResult;
+}
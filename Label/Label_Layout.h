@@ -0,0 +1,109 @@
+#ifndef LABEL_LAYOUT_H
+#define LABEL_LAYOUT_H
+
+#include <Graphic3d_Camera.hxx>
+#include <Graphic3d_WorldViewProjState.hxx>
+
+#include <QHash>
+#include <QLineF>
+#include <QList>
+#include <QRectF>
+#include <QVector>
+
+#include "Label_PMI.h"
+
+class Label_LazyDisplay;
+
+//! Move the labels apart on the screen of a camera. Every label is tried at
+//! rings of places around its location on its own plane, and the place with
+//! the least cost is taken: the area covered by the other labels, the leads
+//! crossing the other leads and the distance moved. The boxes and the leads
+//! are kept in grids of screen cells, so a place is checked against its
+//! neighbours only.
+class Label_Layout
+{
+public:
+    Label_Layout();
+
+    //! Take the labels at their current locations, as seen by theCamera in a
+    //! view of theWidth x theHeight pixels. Nothing is moved
+    void Reset(const QList<Handle(Label_PMI)>& theLabels,
+               const Handle(Graphic3d_Camera)& theCamera,
+               const int theWidth, const int theHeight);
+
+    //! Whether the layout was taken for theCamera as it is now, in a view of
+    //! theWidth x theHeight pixels. Otherwise the boxes on the screen are stale
+    //! and Reset() must be called
+    Standard_Boolean IsCurrent(const Handle(Graphic3d_Camera)& theCamera,
+                               const int theWidth, const int theHeight) const;
+
+    //! The moved labels are reported to theDisplay, so the ones it keeps
+    //! out of the view are tested at their new places
+    void SetLazyDisplay(Label_LazyDisplay* theDisplay) { myLazyDisplay = theDisplay; }
+
+    //! Take theLabel at its current location if it's new, nothing is moved
+    void Add(const Handle(Label_PMI)& theLabel);
+
+    //! Place all the labels again in their order, the earlier ones get the
+    //! better places. Returns the number of moved labels
+    int Solve();
+
+    //! Move theLabel to the place of least cost among the others,
+    //! it's added if it's new. Returns true if it's moved
+    Standard_Boolean Place(const Handle(Label_PMI)& theLabel);
+
+    //! Keep theLabel at its location, such as after a drag, and place again
+    //! the labels it covers. Returns the number of moved labels
+    int Pin(const Handle(Label_PMI)& theLabel);
+
+private:
+    struct Entry
+    {
+        Handle(Label_PMI) Label;
+        gp_Pnt Target;         //!< where the lead goes
+        Standard_Real Width;   //!< of the text with padding
+        QRectF Box;            //!< on the screen
+        QLineF Lead;           //!< on the screen, from the text to the target
+        bool Placed;           //!< in the grids
+    };
+
+    typedef QHash<quint64, QVector<int> > Grid;
+
+    QPointF project(const gp_Pnt& thePnt) const;
+
+    //! Box and lead of entry if its text is at theLocation
+    void measure(const Entry& theEntry, const gp_Pnt& theLocation, QRectF& theBox, QLineF& theLead) const;
+
+    Standard_Real cost(int theIndex, const QRectF& theBox, const QLineF& theLead) const;
+
+    //! Find the best place of entry and move the label there
+    Standard_Boolean placeEntry(int theIndex);
+
+    //! The index of theLabel, a new entry is made for it if it's new
+    int entryOf(const Handle(Label_PMI)& theLabel);
+
+    void insert(int theIndex);
+    void remove(int theIndex);
+
+    static void addToGrid(Grid& theGrid, const QRectF& theRect, int theIndex);
+    static void removeFromGrid(Grid& theGrid, const QRectF& theRect, int theIndex);
+    //! The entries in the cells of rect, each one once
+    QVector<int> query(const Grid& theGrid, const QRectF& theRect) const;
+
+    Label_LazyDisplay* myLazyDisplay;
+    Handle(Graphic3d_Camera) myCamera;
+    Graphic3d_WorldViewProjState myCameraState;
+    int myWidth;
+    int myHeight;
+
+    QVector<Entry> myEntries;
+    QHash<const Label_PMI*, int> myIndices;
+    Grid myBoxes;
+    Grid myLeads;
+
+    //! the last query which found each entry, so it's reported once
+    mutable QVector<int> myStamps;
+    mutable int myStamp;
+};
+
+#endif // LABEL_LAYOUT_H
@@ -0,0 +1,124 @@
+#include "Label_LazyDisplay.h"
+
+#include <Graphic3d_Camera.hxx>
+
+#include "Label_LevelOfDetail.h"
+
+// the labels a bit out of the view are displayed too, they come in with the next move
+static const Standard_Real MARGIN = 1.2;
+
+Label_LazyDisplay::Label_LazyDisplay()
+{
+}
+
+Standard_Boolean Label_LazyDisplay::Display(const Handle(AIS_InteractiveContext) &theContext,
+                                            const Handle(V3d_View) &theView,
+                                            const Label_LevelOfDetail &theDetail,
+                                            const Handle(Label_PMI) &theLabel)
+{
+    if(theLabel.IsNull())
+        return Standard_False;
+
+    Entry anEntry;
+    anEntry.Label = theLabel;
+    anEntry.Box = theLabel->Extent();
+    if(theView.IsNull() || isInView(anEntry.Box, theView)) {
+        theDetail.Prepare(theLabel, theView);
+        theContext->Display(theLabel, Standard_False);
+        return Standard_True;
+    }
+
+    myPending.append(anEntry);
+    return Standard_False;
+}
+
+Standard_Boolean Label_LazyDisplay::Update(const Handle(AIS_InteractiveContext) &theContext,
+                                           const Handle(V3d_View) &theView,
+                                           const Label_LevelOfDetail &theDetail)
+{
+    if(myPending.isEmpty() || theView.IsNull())
+        return Standard_False;
+
+    // nothing comes into the view if the camera, the window and the labels are the same
+    const Graphic3d_WorldViewProjState& aState = theView->Camera()->WorldViewProjState();
+    if(aState == myState && myMoved.isEmpty())
+        return Standard_False;
+    myState = aState;
+
+    Standard_Boolean isDisplayed = Standard_False;
+    for(int i=myPending.size()-1;i>=0;--i) {
+        if(!myMoved.isEmpty() && myMoved.contains(myPending[i].Label.get()))
+            myPending[i].Box = myPending[i].Label->Extent();
+        if(!isInView(myPending[i].Box, theView))
+            continue;
+
+        const Handle(Label_PMI)& aLabel = myPending[i].Label;
+        theDetail.Prepare(aLabel, theView);
+        theContext->Display(aLabel, Standard_False);
+        myPending.removeAt(i);
+        isDisplayed = Standard_True;
+    }
+    myMoved.clear();
+    return isDisplayed;
+}
+
+void Label_LazyDisplay::Flush(const Handle(AIS_InteractiveContext) &theContext,
+                              const Handle(V3d_View) &theView,
+                              const Label_LevelOfDetail &theDetail)
+{
+    for(int i=0;i<myPending.size();++i) {
+        theDetail.Prepare(myPending[i].Label, theView);
+        theContext->Display(myPending[i].Label, Standard_False);
+    }
+    myPending.clear();
+    myMoved.clear();
+}
+
+void Label_LazyDisplay::Moved(const Handle(Label_PMI) &theLabel)
+{
+    if(!theLabel.IsNull() && !myPending.isEmpty())
+        myMoved.insert(theLabel.get());
+}
+
+QList<Handle(Label_PMI)> Label_LazyDisplay::Pending() const
+{
+    QList<Handle(Label_PMI)> aLabels;
+    aLabels.reserve(myPending.size());
+    for(int i=0;i<myPending.size();++i)
+        aLabels.append(myPending[i].Label);
+    return aLabels;
+}
+
+void Label_LazyDisplay::Clear()
+{
+    myPending.clear();
+    myMoved.clear();
+}
+
+Standard_Boolean Label_LazyDisplay::isInView(const Bnd_Box &theBox, const Handle(V3d_View) &theView)
+{
+    if(theBox.IsVoid())
+        return Standard_True;
+
+    Standard_Real aMin[3], aMax[3];
+    theBox.Get(aMin[0], aMin[1], aMin[2], aMax[0], aMax[1], aMax[2]);
+
+    // the box in normalized device coordinates, the depth is left to the viewer
+    const Handle(Graphic3d_Camera)& aCamera = theView->Camera();
+    const gp_Pnt anEye = aCamera->Eye();
+    const gp_Dir aDir = aCamera->Direction();
+    Standard_Real xMin = RealLast(), yMin = RealLast(), xMax = -RealLast(), yMax = -RealLast();
+    for(int i=0;i<8;++i) {
+        const gp_Pnt aCorner(i & 1 ? aMax[0] : aMin[0], i & 2 ? aMax[1] : aMin[1], i & 4 ? aMax[2] : aMin[2]);
+        // a corner behind the eye flips in perspective, take it as visible
+        if(!aCamera->IsOrthographic() && gp_Vec(anEye, aCorner).Dot(gp_Vec(aDir)) <= 0)
+            return Standard_True;
+
+        const gp_Pnt aProjected = aCamera->Project(aCorner);
+        xMin = Min(xMin, aProjected.X());
+        xMax = Max(xMax, aProjected.X());
+        yMin = Min(yMin, aProjected.Y());
+        yMax = Max(yMax, aProjected.Y());
+    }
+    return xMax >= -MARGIN && xMin <= MARGIN && yMax >= -MARGIN && yMin <= MARGIN;
+}
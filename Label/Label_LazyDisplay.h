@@ -0,0 +1,71 @@
+#ifndef LABEL_LAZYDISPLAY_H
+#define LABEL_LAZYDISPLAY_H
+
+#include <AIS_InteractiveContext.hxx>
+#include <Bnd_Box.hxx>
+#include <Graphic3d_WorldViewProjState.hxx>
+#include <V3d_View.hxx>
+
+#include <QList>
+#include <QSet>
+
+#include "Label_PMI.h"
+
+class Label_LevelOfDetail;
+
+//! Display the labels only when they come into the view. A label out of the
+//! view is kept without its presentation and selection, which are computed
+//! when the camera turns to it, so loading many labels costs only the visible
+//! ones. A displayed label stays displayed, the viewer culls it by itself.
+class Label_LazyDisplay
+{
+public:
+    Label_LazyDisplay();
+
+    //! Display theLabel if its extent is in the view, otherwise keep it
+    //! until Update() finds it there. The viewer isn't updated.
+    //! Returns true if the label is displayed
+    Standard_Boolean Display(const Handle(AIS_InteractiveContext)& theContext,
+                             const Handle(V3d_View)& theView,
+                             const Label_LevelOfDetail& theDetail,
+                             const Handle(Label_PMI)& theLabel);
+
+    //! Display the kept labels which came into the view, the viewer isn't updated.
+    //! Returns true if any label is displayed
+    Standard_Boolean Update(const Handle(AIS_InteractiveContext)& theContext,
+                            const Handle(V3d_View)& theView,
+                            const Label_LevelOfDetail& theDetail);
+
+    //! Display all the kept labels
+    void Flush(const Handle(AIS_InteractiveContext)& theContext,
+               const Handle(V3d_View)& theView,
+               const Label_LevelOfDetail& theDetail);
+
+    //! Take the extent of theLabel again in the next Update() if it's kept,
+    //! called when the label is moved
+    void Moved(const Handle(Label_PMI)& theLabel);
+
+    //! The labels which aren't displayed yet
+    QList<Handle(Label_PMI)> Pending() const;
+
+    Standard_Boolean IsEmpty() const { return myPending.isEmpty(); }
+
+    //! Forget the kept labels
+    void Clear();
+
+private:
+    struct Entry
+    {
+        Handle(Label_PMI) Label;
+        Bnd_Box Box;
+    };
+
+    //! Whether the box is in the view, with a margin around it
+    static Standard_Boolean isInView(const Bnd_Box& theBox, const Handle(V3d_View)& theView);
+
+    QList<Entry> myPending;
+    QSet<const Label_PMI*> myMoved;
+    Graphic3d_WorldViewProjState myState;
+};
+
+#endif // LABEL_LAZYDISPLAY_H
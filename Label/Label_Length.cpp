@@ -1,6 +1,5 @@
 ﻿#include "Label_Length.h"
 
-#include <BRepBuilderAPI_MakeEdge.hxx>
 #include <Font_BRepTextBuilder.hxx>
 #include <Prs3d_Arrow.hxx>
 #include <Prs3d_ShadingAspect.hxx>
@@ -45,9 +44,25 @@ void Label_Length::SetLocation(const gp_Pnt &pnt)
     gp_Pnt pp = PPOS.NearestPoint();
 
     myOrientation3D.SetLocation(pp);
-    this->SetToUpdate();
-    this->UpdatePresentations();
-    this->GetContext()->RecomputeSelectionOnly(this);
+    updatePosture();
+}
+
+void Label_Length::SaveRecord(Label_Record &theRecord) const
+{
+    Label_PMI::SaveRecord(theRecord);
+    theRecord.Type = Label_Record::Length;
+    theRecord.Strings = { myMainStr, mySUPStr, mySUBStr };
+    theRecord.Points = { myFirstPnt, mySecondPnt };
+}
+
+Standard_Boolean Label_Length::LoadRecord(const Label_Record &theRecord)
+{
+    if(theRecord.Type != Label_Record::Length || theRecord.Strings.size() < 3 || theRecord.Points.size() < 2)
+        return Standard_False;
+
+    SetData(theRecord.Strings[0], theRecord.Strings[1], theRecord.Strings[2]);
+    SetDiamension(theRecord.Points[0], theRecord.Points[1]);
+    return Label_PMI::LoadRecord(theRecord);
 }
 
 void Label_Length::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsMgr*/,
@@ -56,7 +71,8 @@ void Label_Length::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrs
 {
     switch (theMode)
     {
-    case 0:
+    case GlyphMode:
+    case TextMode:
     {
         // 0. verify the data
         if(myMainStr.IsEmpty())
@@ -67,17 +83,7 @@ void Label_Length::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrs
             SetTransformPersistence (new Graphic3d_TransformPers (Graphic3d_TMF_ZoomPers, myOrientation3D.Location()));
         }
 
-        // 2.compute the points
-        gp_Pnt target = myOrientation3D.Location();
-        Handle(Geom_Line) dimLine = new Geom_Line(myFirstPnt, mySecondPnt.XYZ()-myFirstPnt.XYZ());
-        GeomAPI_ProjectPointOnCurve PPC(target,dimLine);
-        gp_Pnt nearest = PPC.NearestPoint();
-        gp_Vec flyOutVec = target.XYZ() - nearest.XYZ();
-
-        myFirstOut = myFirstPnt.Translated(flyOutVec);
-        mySecondOut = mySecondPnt.Translated(flyOutVec);
-
-        // 3.set the color and material
+        // 2.set the color and material
         // material
         Graphic3d_MaterialAspect aMaterialAspect;
         aMaterialAspect.SetMaterialName(Graphic3d_NOM_STONE);
@@ -87,13 +93,12 @@ void Label_Length::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrs
         anAspect->SetMaterial (aMaterialAspect);
         anAspect->SetColor(myLabelColor);
 
-        // 4.draw the main&sup&sub string
-        TopoDS_Shape strShape = ComputeStringWithSupAndSub(myMainStr,mySUBStr,mySUPStr,myLabelWidth);
-        StdPrs_ShadedShape::Add(thePrs,strShape,myDrawer);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect(anAspect->Aspect());
+        // 3.draw the main&sup&sub string
+        const TextMesh& strMesh = ComputeStringWithSupAndSub(myMainStr,mySUBStr,mySUPStr,myLabelWidth);
+        drawText(thePrs, theMode, strMesh, calculateOrientionTrsf(), anAspect);
 
-        // 5.draw the fly out line and arrow
-        ComputeFlyOut(thePrs, anAspect);
+        // 4.draw the fly out line and arrow
+        drawLead(thePrs, theMode, anAspect);
 
         break;
     }
@@ -156,16 +161,24 @@ void Label_Length::JudgeTextOut(bool &left, bool &right)
         right = false;
 }
 
-void Label_Length::ComputeFlyOut (const Handle(Prs3d_Presentation)& thePrs,
-                                  const Handle(Prs3d_ShadingAspect)& anAspect)
+void Label_Length::ComputeFlyOutPnts()
+{
+    gp_Pnt target = myOrientation3D.Location();
+    Handle(Geom_Line) dimLine = new Geom_Line(myFirstPnt, mySecondPnt.XYZ()-myFirstPnt.XYZ());
+    GeomAPI_ProjectPointOnCurve PPC(target,dimLine);
+    gp_Pnt nearest = PPC.NearestPoint();
+    gp_Vec flyOutVec = target.XYZ() - nearest.XYZ();
+
+    myFirstOut = myFirstPnt.Translated(flyOutVec);
+    mySecondOut = mySecondPnt.Translated(flyOutVec);
+}
+
+void Label_Length::computeLead(LeadGeometry& theLead)
 {
     // 1. compute the fly out line
-    TopoDS_Shape firstFlyLin = BRepBuilderAPI_MakeEdge(myFirstPnt, myFirstOut);
-    StdPrs_ShadedShape::Add(thePrs,firstFlyLin,myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
-    TopoDS_Shape secondFlyLin = BRepBuilderAPI_MakeEdge(mySecondPnt, mySecondOut);
-    StdPrs_ShadedShape::Add(thePrs,secondFlyLin,myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    ComputeFlyOutPnts();
+    theLead.AddSegment(myFirstPnt, myFirstOut);
+    theLead.AddSegment(mySecondPnt, mySecondOut);
 
     // 2. compute the arrow's points
     bool leftOver = false; bool rightOver = false;
@@ -213,22 +226,9 @@ void Label_Length::ComputeFlyOut (const Handle(Prs3d_Presentation)& thePrs,
     gp_Pnt rarrowR = rightMid.Translated(0.5*arrowBotm.Reversed());
 
     // 3.1 arrow's lead line
-    BRepBuilderAPI_MakeEdge aBuilder(leadLeft,leadRight);
-    StdPrs_ShadedShape::Add(thePrs,aBuilder.Shape(),myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddSegment(leadLeft,leadRight);
 
     // 3.2 arrow's triangle
-    Handle(Graphic3d_ArrayOfTriangles) aTriangle = new Graphic3d_ArrayOfTriangles(3);
-    aTriangle->AddVertex (larrowL);
-    aTriangle->AddVertex (myFirstOut);
-    aTriangle->AddVertex (larrowR);
-    thePrs->CurrentGroup()->AddPrimitiveArray(aTriangle);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
-
-    Handle(Graphic3d_ArrayOfTriangles) bTriangle = new Graphic3d_ArrayOfTriangles(3);
-    bTriangle->AddVertex (rarrowL);
-    bTriangle->AddVertex (mySecondOut);
-    bTriangle->AddVertex (rarrowR);
-    thePrs->CurrentGroup()->AddPrimitiveArray(bTriangle);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddTriangle(larrowL,myFirstOut,larrowR);
+    theLead.AddTriangle(rarrowL,mySecondOut,rarrowR);
 }
@@ -19,11 +19,18 @@ public:
     //! Set location of shape, interface for drafting
     virtual void SetLocation(const gp_Pnt& pnt) override;
 
+    //! Store the type, strings and points of label
+    virtual void SaveRecord(Label_Record& theRecord) const Standard_OVERRIDE;
+
+    //! Rebuild the label from the record
+    virtual Standard_Boolean LoadRecord(const Label_Record& theRecord) Standard_OVERRIDE;
+
     //! Set the length value by main,sup,sub string
     void SetData(const NCollection_Utf8String& main, const NCollection_Utf8String& sup, const NCollection_Utf8String& sub) {
         myMainStr = main;
         mySUPStr = sup;
         mySUBStr = sub;
+        invalidateText();
     }
 
     //! Set the points which the label is indicated to
@@ -45,8 +52,10 @@ protected:
 
     void JudgeTextOut(bool& left, bool& right);
 
-    void ComputeFlyOut (const Handle(Prs3d_Presentation)& thePrs,
-                        const Handle(Prs3d_ShadingAspect)& anAspect);
+    void ComputeFlyOutPnts();
+
+    //! Add the fly out lines and arrows
+    virtual void computeLead(LeadGeometry& theLead) Standard_OVERRIDE;
 
 protected:
 
@@ -0,0 +1,65 @@
+#include "Label_LevelOfDetail.h"
+
+#include <AIS_ListOfInteractive.hxx>
+#include <Graphic3d_Camera.hxx>
+
+// the glyphs come back at the threshold, the texture at 80% of it
+static const Standard_Real HYSTERESIS = 0.8;
+
+Label_LevelOfDetail::Label_LevelOfDetail()
+    : myThreshold(12)
+{
+}
+
+void Label_LevelOfDetail::SetThreshold(const Standard_Real thePixels)
+{
+    myThreshold = Max(0.0, thePixels);
+}
+
+Standard_Integer Label_LevelOfDetail::Mode(const Handle(Label_PMI) &theLabel, const Handle(V3d_View) &theView) const
+{
+    // the labels of fixed size on the screen keep the glyphs
+    if(myThreshold <= 0 || !theLabel->IsZoomable() || theView->Window().IsNull())
+        return Label_PMI::GlyphMode;
+
+    Standard_Integer aWidth = 0, aHeight = 0;
+    theView->Window()->Size(aWidth, aHeight);
+
+    // the text height across the view direction, in pixels
+    const Handle(Graphic3d_Camera)& aCamera = theView->Camera();
+    gp_Pnt anAnchor = theLabel->Orientation3D().Location().Transformed(theLabel->LocalTransformation());
+    gp_Pnt aBottom = aCamera->Project(anAnchor);
+    gp_Pnt aTop = aCamera->Project(anAnchor.Translated(theLabel->Height() * gp_Vec(aCamera->Up())));
+    const Standard_Real aPixels = 0.5 * aHeight * Abs(aTop.Y() - aBottom.Y());
+
+    const Standard_Real aLimit = theLabel->DisplayMode() == Label_PMI::TextMode ? myThreshold : HYSTERESIS * myThreshold;
+    return aPixels >= aLimit ? Label_PMI::GlyphMode : Label_PMI::TextMode;
+}
+
+void Label_LevelOfDetail::Prepare(const Handle(Label_PMI) &theLabel, const Handle(V3d_View) &theView) const
+{
+    if(!theLabel.IsNull() && !theView.IsNull())
+        theLabel->SetDisplayMode(Mode(theLabel, theView));
+}
+
+Standard_Boolean Label_LevelOfDetail::Update(const Handle(AIS_InteractiveContext) &theContext, const Handle(V3d_View) &theView)
+{
+    if(theContext.IsNull() || theView.IsNull())
+        return Standard_False;
+
+    Standard_Boolean isChanged = Standard_False;
+    AIS_ListOfInteractive aDisplayed;
+    theContext->DisplayedObjects(aDisplayed);
+    for(AIS_ListOfInteractive::Iterator anIter(aDisplayed); anIter.More(); anIter.Next()) {
+        Handle(Label_PMI) aLabel = Handle(Label_PMI)::DownCast(anIter.Value());
+        if(aLabel.IsNull() || aLabel->IsDragging())
+            continue;
+
+        const Standard_Integer aMode = Mode(aLabel, theView);
+        if(aMode != aLabel->DisplayMode()) {
+            theContext->SetDisplayMode(aLabel, aMode, Standard_False);
+            isChanged = Standard_True;
+        }
+    }
+    return isChanged;
+}
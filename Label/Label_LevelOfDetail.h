@@ -0,0 +1,38 @@
+#ifndef LABEL_LEVELOFDETAIL_H
+#define LABEL_LEVELOFDETAIL_H
+
+#include <AIS_InteractiveContext.hxx>
+#include <V3d_View.hxx>
+
+#include "Label_PMI.h"
+
+//! Switch the labels between their display modes by the height of text on
+//! the screen. Below the threshold the text is drawn by the font texture of
+//! the viewer, above it by the meshed glyphs. Both presentations are kept
+//! by the context, so a switch only swaps them.
+class Label_LevelOfDetail
+{
+public:
+    Label_LevelOfDetail();
+
+    //! Height of text in pixels where the labels switch to the meshed glyphs,
+    //! they switch back at a slightly smaller height so they don't flicker. 0 disables it
+    void SetThreshold(const Standard_Real thePixels);
+    Standard_Real Threshold() const { return myThreshold; }
+
+    //! The display mode of theLabel for its height on the screen of theView
+    Standard_Integer Mode(const Handle(Label_PMI)& theLabel, const Handle(V3d_View)& theView) const;
+
+    //! Choose the display mode of theLabel before it's displayed,
+    //! so only the presentation on the screen is computed
+    void Prepare(const Handle(Label_PMI)& theLabel, const Handle(V3d_View)& theView) const;
+
+    //! Switch the displayed labels whose mode changed, the viewer isn't updated.
+    //! Returns true if any label is switched
+    Standard_Boolean Update(const Handle(AIS_InteractiveContext)& theContext, const Handle(V3d_View)& theView);
+
+private:
+    Standard_Real myThreshold;
+};
+
+#endif // LABEL_LEVELOFDETAIL_H
@@ -1,17 +1,79 @@
 #include "Label_PMI.h"
 
+#include <AIS_InteractiveContext.hxx>
 #include <BRepBuilderAPI_MakePolygon.hxx>
-#include <BRepBuilderAPI_Transform.hxx>
-#include <Font_BRepTextBuilder.hxx>
+#include <ElCLib.hxx>
+#include <Graphic3d_ArrayOfSegments.hxx>
+#include <Graphic3d_ArrayOfTriangles.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <Prs3d_Text.hxx>
+#include <Prs3d_TextAspect.hxx>
+#include <TopLoc_Location.hxx>
+
+#include <cmath>
+
+#include "Label_FontCache.h"
 
 IMPLEMENT_STANDARD_RTTIEXT(Label_PMI,AIS_DraftShape)
 
+//! Copy the triangles into one indexed array, theTrsfs[i] is applied to theMeshes[i]
+static Handle(Graphic3d_ArrayOfTriangles) mergeTriangles(const NCollection_Vector<Handle(Graphic3d_ArrayOfTriangles)>& theMeshes,
+                                                         const NCollection_Vector<gp_Trsf>& theTrsfs)
+{
+    Standard_Integer aNbVertices = 0, aNbEdges = 0;
+    for(Standard_Integer i=0;i<theMeshes.Length();++i) {
+        const Handle(Graphic3d_ArrayOfTriangles)& aMesh = theMeshes(i);
+        aNbVertices += aMesh->VertexNumber();
+        aNbEdges += aMesh->EdgeNumber() > 0 ? aMesh->EdgeNumber() : aMesh->VertexNumber();
+    }
+    if(aNbVertices == 0)
+        return Handle(Graphic3d_ArrayOfTriangles)();
+
+    Handle(Graphic3d_ArrayOfTriangles) aResult = new Graphic3d_ArrayOfTriangles(aNbVertices, aNbEdges, Standard_True);
+    for(Standard_Integer i=0;i<theMeshes.Length();++i) {
+        const Handle(Graphic3d_ArrayOfTriangles)& aMesh = theMeshes(i);
+        const gp_Trsf& aTrsf = theTrsfs(i);
+        const Standard_Integer aBase = aResult->VertexNumber();
+
+        // the glyphs are planar on XOY, use its normal if the mesh has none
+        const gp_Dir aDefNormal = gp::DZ().Transformed(aTrsf);
+        for(Standard_Integer k=1;k<=aMesh->VertexNumber();++k) {
+            aResult->AddVertex(aMesh->Vertice(k).Transformed(aTrsf),
+                               aMesh->HasVertexNormals() ? aMesh->VertexNormal(k).Transformed(aTrsf) : aDefNormal);
+        }
+
+        if(aMesh->EdgeNumber() > 0) {
+            for(Standard_Integer k=1;k<=aMesh->EdgeNumber();++k)
+                aResult->AddEdge(aBase + aMesh->Edge(k));
+        }
+        else {
+            for(Standard_Integer k=1;k<=aMesh->VertexNumber();++k)
+                aResult->AddEdge(aBase + k);
+        }
+    }
+    return aResult;
+}
+
+//! Whether the transformations have exactly the same values
+static bool isSameTrsf(const gp_Trsf& theTrsf1, const gp_Trsf& theTrsf2)
+{
+    for(int aRow=1;aRow<=3;++aRow) {
+        for(int aCol=1;aCol<=4;++aCol) {
+            if(theTrsf1.Value(aRow, aCol) != theTrsf2.Value(aRow, aCol))
+                return false;
+        }
+    }
+    return true;
+}
+
 Label_PMI::Label_PMI()
     : myHasOrientation3D(Standard_False),
       myLabelZoomable(Standard_True),
       myFontHeight(4),
       myFontPadding(2),
-      myLabelColor(Quantity_NOC_BLACK)
+      myLabelColor(Quantity_NOC_BLACK),
+      myIsDragging(Standard_False),
+      myIsDragged(Standard_False)
 {
     myDrawer->SetDisplayMode (0);
 }
@@ -32,14 +94,96 @@ void Label_PMI::SetZoomable(const Standard_Boolean theIsZoomable)
     myLabelZoomable = theIsZoomable;
 }
 
+void Label_PMI::SaveRecord(Label_Record &theRecord) const
+{
+    theRecord.Orientation = myOrientation3D;
+    theRecord.Transformation = LocalTransformation();
+    theRecord.Height = myFontHeight;
+    theRecord.Padding = myFontPadding;
+    theRecord.ShapeIndices = myShapeIndices;
+}
+
+Standard_Boolean Label_PMI::LoadRecord(const Label_Record &theRecord)
+{
+    SetOriention(theRecord.Orientation);
+    SetHeight(theRecord.Height);
+    SetPadding(theRecord.Padding);
+    if(theRecord.Transformation.Form() != gp_Identity)
+        SetLocalTransformation(theRecord.Transformation);
+    myShapeIndices = theRecord.ShapeIndices;
+    return Standard_True;
+}
+
+Bnd_Box Label_PMI::Extent() const
+{
+    Label_Record aRecord;
+    SaveRecord(aRecord);
+
+    Bnd_Box aBox;
+    const gp_Trsf& aTrsf = aRecord.Transformation;
+
+    // the text is on either side of the anchor, some labels center it
+    const Standard_Real aWidth = TextWidth();
+    const gp_Trsf aText = aTrsf * calculateOrientionTrsf();
+    const Standard_Real aCorners[4][2] = { {-aWidth, -0.3*myFontHeight}, {-aWidth, myFontHeight},
+                                           {aWidth, -0.3*myFontHeight}, {aWidth, myFontHeight} };
+    for(int i=0;i<4;++i)
+        aBox.Add(gp_Pnt(aCorners[i][0], aCorners[i][1], 0).Transformed(aText));
+
+    // the lead ends at the indicated points or on the circle
+    for(int i=0;i<aRecord.Points.size();++i)
+        aBox.Add(aRecord.Points[i].Transformed(aTrsf));
+    if(aRecord.Type == Label_Record::Radius || aRecord.Type == Label_Record::Diameter) {
+        const gp_Pnt aCenter = aRecord.Circle.Location();
+        const Standard_Real aRadius = aRecord.Circle.Radius();
+        aBox.Add(aCenter.Translated(gp_Vec(aRadius, aRadius, aRadius)).Transformed(aTrsf));
+        aBox.Add(aCenter.Translated(gp_Vec(-aRadius, -aRadius, -aRadius)).Transformed(aTrsf));
+    }
+    return aBox;
+}
+
+Standard_Real Label_PMI::TextWidth() const
+{
+    Label_Record aRecord;
+    SaveRecord(aRecord);
+
+    Standard_Real aWidth = 0;
+    for(int i=0;i<aRecord.Strings.size();++i) {
+        if(!aRecord.Strings[i].IsEmpty())
+            aWidth += calculateStringWidth(aRecord.Strings[i]) + 2*myFontPadding;
+    }
+    return aWidth;
+}
+
+gp_Pnt Label_PMI::LeadTarget() const
+{
+    Label_Record aRecord;
+    SaveRecord(aRecord);
+    if(aRecord.Type == Label_Record::Radius || aRecord.Type == Label_Record::Diameter || aRecord.Points.isEmpty())
+        return aRecord.Circle.Location();
+    // the corner of angle
+    if(aRecord.Type == Label_Record::Angle && aRecord.Points.size() > 1)
+        return aRecord.Points[1];
+    return aRecord.Points.first();
+}
+
+gp_Pnt Label_PMI::AllowedLocation(const gp_Pnt &thePnt) const
+{
+    const gp_XYZ aNormal = myOrientation3D.Direction().XYZ();
+    const gp_XYZ aVec = thePnt.XYZ() - myOrientation3D.Location().XYZ();
+    return gp_Pnt(thePnt.XYZ() - aVec.Dot(aNormal) * aNormal);
+}
+
 void Label_PMI::SetHeight(const Standard_Real theHeight)
 {
     myFontHeight = theHeight;
+    invalidateText();
 }
 
 void Label_PMI::SetPadding(const Standard_Real thePadding)
 {
     myFontPadding = thePadding;
+    invalidateText();
 }
 
 const gp_Ax2 &Label_PMI::Orientation3D() const
@@ -52,17 +196,94 @@ Standard_Boolean Label_PMI::HasOrientation3D() const
     return myHasOrientation3D;
 }
 
-Standard_Real Label_PMI::calculateStringWidth(const NCollection_Utf8String &str) const
+void Label_PMI::BeginDrag()
+{
+    if(myIsDragging || GetContext().IsNull())
+        return;
+
+    myIsDragging = Standard_True;
+    myIsDragged = Standard_False;
+    myDragStartTrsf = calculateOrientionTrsf();
+    myDragBaseTrsf = LocalTransformation();
+}
+
+void Label_PMI::EndDrag()
 {
-    Font_BRepFont aBrepFont(FONT_FILE_PATH, myFontHeight);
-    Standard_Real tWidth=0;
-    for(NCollection_Utf8Iter anIter = str.Iterator(); *anIter != 0; ) {
-        Standard_Utf32Char aCurrChar = *anIter;
-        Standard_Utf32Char aNextChar = *(++anIter);
-        tWidth += aBrepFont.AdvanceX(aCurrChar,aNextChar);
+    if(!myIsDragging)
+        return;
+
+    myIsDragging = Standard_False;
+    if(!myIsDragged)
+        return;
+
+    // put back the original transformation, the geometry is rebuilt at the new location
+    if(myDragBaseTrsf.Form() == gp_Identity)
+        GetContext()->ResetLocation(this);
+    else
+        GetContext()->SetLocation(this, TopLoc_Location(myDragBaseTrsf));
+    updatePosture();
+}
+
+void Label_PMI::drawLead(const Handle(Prs3d_Presentation) &thePrs, const Standard_Integer theMode,
+                         const Handle(Prs3d_ShadingAspect) &anAspect)
+{
+    myLeadAspect = anAspect;
+    Handle(Graphic3d_Group)& aGroup = myLeadGroups[theMode == TextMode ? 1 : 0];
+    aGroup = thePrs->NewGroup();
+
+    LeadGeometry aLead;
+    computeLead(aLead);
+    fillLead(aGroup, aLead, gp_Trsf());
+}
+
+void Label_PMI::updatePosture()
+{
+    // only the presentation on the screen follows the drag, the other is computed after it
+    const Handle(Graphic3d_Group)& aLeadGroup = myLeadGroups[DisplayMode() == TextMode ? 1 : 0];
+    if(!myIsDragging || aLeadGroup.IsNull()) {
+        this->SetToUpdate();
+        // not displayed yet, it's computed when it is
+        if(GetContext().IsNull())
+            return;
+        this->UpdatePresentations();
+        this->GetContext()->RecomputeSelectionOnly(this);
+        return;
     }
 
-    return tWidth;
+    // the body of label is rigid, move it from the orientation when the drag started
+    myIsDragged = Standard_True;
+    gp_Trsf aMove = calculateOrientionTrsf() * myDragStartTrsf.Inverted();
+    GetContext()->SetLocation(this, TopLoc_Location(myDragBaseTrsf * aMove));
+
+    // the lead is computed in model space, bring it back under the moved location
+    LeadGeometry aLead;
+    computeLead(aLead);
+    fillLead(aLeadGroup, aLead, aMove.Inverted());
+}
+
+void Label_PMI::fillLead(const Handle(Graphic3d_Group) &theGroup, const LeadGeometry &theLead, const gp_Trsf &theTrsf)
+{
+    theGroup->Clear();
+    theGroup->SetGroupPrimitivesAspect(myLeadAspect->Aspect());
+
+    if(!theLead.Segments.IsEmpty()) {
+        Handle(Graphic3d_ArrayOfSegments) aSegments = new Graphic3d_ArrayOfSegments(theLead.Segments.Length());
+        for(NCollection_Vector<gp_Pnt>::Iterator anIter(theLead.Segments); anIter.More(); anIter.Next())
+            aSegments->AddVertex(anIter.Value().Transformed(theTrsf));
+        theGroup->AddPrimitiveArray(aSegments);
+    }
+
+    if(!theLead.Triangles.IsEmpty()) {
+        Handle(Graphic3d_ArrayOfTriangles) aTriangles = new Graphic3d_ArrayOfTriangles(theLead.Triangles.Length());
+        for(NCollection_Vector<gp_Pnt>::Iterator anIter(theLead.Triangles); anIter.More(); anIter.Next())
+            aTriangles->AddVertex(anIter.Value().Transformed(theTrsf));
+        theGroup->AddPrimitiveArray(aTriangles);
+    }
+}
+
+Standard_Real Label_PMI::calculateStringWidth(const NCollection_Utf8String &str) const
+{
+    return Label_FontCache::Instance().StringWidth(FONT_FILE_PATH, myFontHeight, str);
 }
 
 gp_Trsf Label_PMI::calculateOrientionTrsf() const
@@ -91,14 +312,20 @@ StringBox Label_PMI::calculateStringBox(const NCollection_Utf8String &str) const
     return box;
 }
 
-TopoDS_Shape Label_PMI::ComputeStringList(const NCollection_Utf8StringList &strlist, Standard_Real &width) const
+const TextMesh& Label_PMI::ComputeStringList(const NCollection_Utf8StringList &strlist, Standard_Real &width)
 {
-    if(strlist.isEmpty())
-        return TopoDS_Shape();
+    const QByteArray aKey = textKey("list", strlist);
+    if(myTextMesh.Key == aKey) {
+        width = myTextMesh.Width;
+        return myTextMesh;
+    }
 
-    TopoDS_Compound result;
-    BRep_Builder compBuilder;
-    compBuilder.MakeCompound(result);
+    // 1.collect the triangles of each string with its offset
+    Label_FontCache& aFontCache = Label_FontCache::Instance();
+    NCollection_Vector<Handle(Graphic3d_ArrayOfTriangles)> aStrMeshes;
+    NCollection_Vector<gp_Trsf> aStrTrsfs;
+    NCollection_Vector<gp_Pnt> aBoxPnts;
+    NCollection_Vector<TextRun> aRuns;
 
     gp_Vec offset;
     offset.SetXYZ({0,0,0});
@@ -107,61 +334,83 @@ TopoDS_Shape Label_PMI::ComputeStringList(const NCollection_Utf8StringList &strl
         if(strlist[i].IsEmpty())
             continue;
 
-        // 1.draw the shape of str
-        Font_BRepFont aBrepFont(FONT_FILE_PATH, myFontHeight);
-        Font_BRepTextBuilder aTextBuilder;
-        TopoDS_Shape txtShape = aTextBuilder.Perform(aBrepFont, strlist[i]);
+        gp_Trsf translate;
+        translate.SetTranslation(offset);
 
-        // 2.draw the str box
+        // 1.1 the mesh of str
+        Handle(Graphic3d_ArrayOfTriangles) aTriangles = aFontCache.StringTriangles(FONT_FILE_PATH, myFontHeight, strlist[i]);
+        if(!aTriangles.IsNull()) {
+            aStrMeshes.Append(aTriangles);
+            aStrTrsfs.Append(translate);
+        }
+        TextRun aRun;
+        aRun.Text = strlist[i];
+        aRun.Origin = gp_Pnt(offset.XYZ());
+        aRun.Height = myFontHeight;
+        aRuns.Append(aRun);
+
+        // 1.2 the str box
         StringBox box = calculateStringBox(strlist[i]);
         gp_Pnt end = box.bottomRight;
-        TopoDS_Shape boxShape = box.ToShape();
-
-        // 3.offset the txtShape and boxShape
-        gp_Trsf translate;
-        translate.SetTranslation(offset);
-        BRepBuilderAPI_Transform txtTrans(txtShape,translate);
-        BRepBuilderAPI_Transform boxTrans(boxShape,translate);
-        compBuilder.Add(result,txtTrans.Shape());
-        compBuilder.Add(result,boxTrans.Shape());
+        const gp_Pnt corners[5] = { box.bottomLeft, box.topLeft, box.topRight, box.bottomRight, box.bottomLeft };
+        for(int k=0;k<4;++k) {
+            aBoxPnts.Append(corners[k].Transformed(translate));
+            aBoxPnts.Append(corners[k+1].Transformed(translate));
+        }
 
-        // 4.set the value of offset
+        // 1.3 set the value of offset
         gp_Pnt next = offset.XYZ() + end.XYZ() + gp_Pnt(myFontPadding,0.3*myFontHeight,0).XYZ();
         width += box.BoxWidth();
         offset.SetXYZ(next.XYZ());
     }
 
-    // transform the compound to the work plane
-    gp_Trsf apply = calculateOrientionTrsf();
-    BRepBuilderAPI_Transform aTransform(result,apply);
+    // 2.merge them into one mesh
+    myTextMesh = TextMesh();
+    myTextMesh.Triangles = mergeTriangles(aStrMeshes, aStrTrsfs);
+    if(!aBoxPnts.IsEmpty()) {
+        myTextMesh.Segments = new Graphic3d_ArrayOfSegments(aBoxPnts.Length());
+        for(NCollection_Vector<gp_Pnt>::Iterator anIter(aBoxPnts); anIter.More(); anIter.Next())
+            myTextMesh.Segments->AddVertex(anIter.Value());
+    }
+    myTextMesh.Runs = aRuns;
+    myTextMesh.Width = width;
+    myTextMesh.Key = aKey;
 
-    return aTransform.Shape();
+    return myTextMesh;
 }
 
-TopoDS_Shape Label_PMI::ComputeStringWithSupAndSub(const NCollection_Utf8String &main,
-                                                   const NCollection_Utf8String &sub,
-                                                   const NCollection_Utf8String &sup,
-                                                   Standard_Real &width)
+const TextMesh& Label_PMI::ComputeStringWithSupAndSub(const NCollection_Utf8String &main,
+                                                      const NCollection_Utf8String &sub,
+                                                      const NCollection_Utf8String &sup,
+                                                      Standard_Real &width)
 {
-    if(main.IsEmpty())
-        return TopoDS_Shape();
+    if(main.IsEmpty()) {
+        invalidateText();
+        width = 0;
+        return myTextMesh;
+    }
 
-    TopoDS_Compound result;
-    BRep_Builder compBuilder;
-    compBuilder.MakeCompound(result);
+    const QByteArray aKey = textKey("supsub", NCollection_Utf8StringList() << main << sub << sup);
+    if(myTextMesh.Key == aKey) {
+        width = myTextMesh.Width;
+        return myTextMesh;
+    }
 
-    // 1.draw the main string with full font height
-    Font_BRepFont aBrepFont(FONT_FILE_PATH, myFontHeight);
-    Font_BRepTextBuilder aTextBuilder;
-    TopoDS_Shape mainShape = aTextBuilder.Perform(aBrepFont, main);
-    compBuilder.Add(result,mainShape);
+    // 1.the main string with full font height
+    Label_FontCache& aFontCache = Label_FontCache::Instance();
+    NCollection_Vector<Handle(Graphic3d_ArrayOfTriangles)> aStrMeshes;
+    NCollection_Vector<gp_Trsf> aStrTrsfs;
+    Handle(Graphic3d_ArrayOfTriangles) mainMesh = aFontCache.StringTriangles(FONT_FILE_PATH, myFontHeight, main);
+    if(!mainMesh.IsNull()) {
+        aStrMeshes.Append(mainMesh);
+        aStrTrsfs.Append(gp_Trsf());
+    }
 
-    // 2.draw the sub&sup string with half height
-    Font_BRepFont bBrepFont(FONT_FILE_PATH, 0.5*myFontHeight);
-    TopoDS_Shape subShape = aTextBuilder.Perform(bBrepFont, sub);
-    TopoDS_Shape supShape = aTextBuilder.Perform(bBrepFont, sup);
+    // 2.the sub&sup string with half height
+    Handle(Graphic3d_ArrayOfTriangles) subMesh = aFontCache.StringTriangles(FONT_FILE_PATH, 0.5*myFontHeight, sub);
+    Handle(Graphic3d_ArrayOfTriangles) supMesh = aFontCache.StringTriangles(FONT_FILE_PATH, 0.5*myFontHeight, sup);
 
-    // 3.offset the sub&sup shape
+    // 3.offset the sub&sup mesh
     width = calculateStringWidth(main);
     gp_Pnt rightBottom = gp_Pnt (width, 0, 0.0);
     gp_Pnt rightMid = gp_Pnt (width, 0.5*myFontHeight, 0.0);
@@ -174,16 +423,127 @@ TopoDS_Shape Label_PMI::ComputeStringWithSupAndSub(const NCollection_Utf8String
     Standard_Real widSup = calculateStringWidth(sup);
     width += 0.5*qMax(widSub,widSup);
 
-    BRepBuilderAPI_Transform aTransform(subShape,subTrsf);
-    BRepBuilderAPI_Transform bTransform(supShape,supTrsf);
-    compBuilder.Add(result,aTransform.Shape());
-    compBuilder.Add(result,bTransform.Shape());
+    if(!subMesh.IsNull()) {
+        aStrMeshes.Append(subMesh);
+        aStrTrsfs.Append(subTrsf);
+    }
+    if(!supMesh.IsNull()) {
+        aStrMeshes.Append(supMesh);
+        aStrTrsfs.Append(supTrsf);
+    }
+
+    // 4.merge them into one mesh
+    myTextMesh = TextMesh();
+    myTextMesh.Triangles = mergeTriangles(aStrMeshes, aStrTrsfs);
+    const TextRun aRuns[3] = {
+        { main, gp_Pnt(), myFontHeight },
+        { sub, rightBottom, 0.5*myFontHeight },
+        { sup, rightMid, 0.5*myFontHeight }
+    };
+    for(int i=0;i<3;++i) {
+        if(!aRuns[i].Text.IsEmpty())
+            myTextMesh.Runs.Append(aRuns[i]);
+    }
+    myTextMesh.Width = width;
+    myTextMesh.Key = aKey;
+
+    return myTextMesh;
+}
 
-    // 4.transform the compound to the work plane
-    gp_Trsf apply = calculateOrientionTrsf();
-    BRepBuilderAPI_Transform compTrans(result,apply);
+void Label_PMI::drawText(const Handle(Prs3d_Presentation) &thePrs,
+                         const Standard_Integer theMode,
+                         const TextMesh &theMesh,
+                         const gp_Trsf &theTrsf,
+                         const Handle(Prs3d_ShadingAspect) &anAspect,
+                         const Handle(Prs3d_LineAspect) &linAspect)
+{
+    if(theMode == TextMode && !theMesh.Runs.IsEmpty()) {
+        // a few textured quads for each string instead of the glyph triangles,
+        // the aspect is shared by the runs, Draw() takes the height of each run
+        if(myTextAspect.IsNull()) {
+            myTextAspect = new Prs3d_TextAspect();
+            const TCollection_AsciiString aFontName = Label_FontCache::Instance().TextFontName(FONT_FILE_PATH);
+            if(!aFontName.IsEmpty())
+                myTextAspect->SetFont(aFontName.ToCString());
+            myTextAspect->SetHorizontalJustification(Graphic3d_HTA_LEFT);
+            myTextAspect->SetVerticalJustification(Graphic3d_VTA_BOTTOM);
+            // the height is in the model units as the glyphs, not in pixels
+            myTextAspect->Aspect()->SetTextZoomable(Standard_True);
+        }
+        myTextAspect->SetColor(myLabelColor);
+
+        Handle(Graphic3d_Group) aGroup = thePrs->NewGroup();
+        for(NCollection_Vector<TextRun>::Iterator anIter(theMesh.Runs); anIter.More(); anIter.Next()) {
+            const TextRun& aRun = anIter.Value();
+            myTextAspect->SetHeight(aRun.Height);
+
+            gp_Ax2 anOrientation(aRun.Origin, gp::DZ(), gp::DX());
+            anOrientation.Transform(theTrsf);
+            Prs3d_Text::Draw(aGroup, myTextAspect, TCollection_ExtendedString(aRun.Text.ToCString(), Standard_True), anOrientation);
+        }
+    }
+    else if(!theMesh.Triangles.IsNull()) {
+        Handle(Graphic3d_Group) aGroup = thePrs->NewGroup();
+        aGroup->SetGroupPrimitivesAspect(anAspect->Aspect());
+        aGroup->AddPrimitiveArray(placeText(theMesh, theTrsf).Triangles);
+    }
 
-    return compTrans.Shape();
+    if(!theMesh.Segments.IsNull()) {
+        Handle(Graphic3d_Group) aGroup = thePrs->NewGroup();
+        if(linAspect.IsNull())
+            aGroup->SetGroupPrimitivesAspect(anAspect->Aspect());
+        else
+            aGroup->SetGroupPrimitivesAspect(linAspect->Aspect());
+        aGroup->AddPrimitiveArray(placeText(theMesh, theTrsf).Segments);
+    }
+}
+
+const PlacedText& Label_PMI::placeText(const TextMesh &theMesh, const gp_Trsf &theTrsf)
+{
+    // the cache holds the source arrays, so they can't be replaced by new ones at the same address
+    if(myPlacedText.SourceTriangles == theMesh.Triangles && myPlacedText.SourceSegments == theMesh.Segments
+            && isSameTrsf(myPlacedText.Trsf, theTrsf))
+        return myPlacedText;
+
+    myPlacedText = PlacedText();
+    myPlacedText.SourceTriangles = theMesh.Triangles;
+    myPlacedText.SourceSegments = theMesh.Segments;
+    myPlacedText.Trsf = theTrsf;
+
+    if(!theMesh.Triangles.IsNull()) {
+        NCollection_Vector<Handle(Graphic3d_ArrayOfTriangles)> aMeshes;
+        NCollection_Vector<gp_Trsf> aTrsfs;
+        aMeshes.Append(theMesh.Triangles);
+        aTrsfs.Append(theTrsf);
+        myPlacedText.Triangles = mergeTriangles(aMeshes, aTrsfs);
+    }
+
+    if(!theMesh.Segments.IsNull()) {
+        myPlacedText.Segments = new Graphic3d_ArrayOfSegments(theMesh.Segments->VertexNumber());
+        for(Standard_Integer i=1;i<=theMesh.Segments->VertexNumber();++i)
+            myPlacedText.Segments->AddVertex(theMesh.Segments->Vertice(i).Transformed(theTrsf));
+    }
+    return myPlacedText;
+}
+
+void Label_PMI::invalidateText()
+{
+    myTextMesh = TextMesh();
+    myPlacedText = PlacedText();
+}
+
+QByteArray Label_PMI::textKey(const char *theType, const NCollection_Utf8StringList &strlist) const
+{
+    QByteArray aKey(theType);
+    for(int i=0;i<strlist.size();++i) {
+        aKey.append('\0');
+        aKey.append(strlist[i].ToCString(), strlist[i].Size());
+    }
+    aKey.append('\0');
+    aKey.append(QByteArray::number(myFontHeight, 'g', 17));
+    aKey.append('\0');
+    aKey.append(QByteArray::number(myFontPadding, 'g', 17));
+    return aKey;
 }
 
 Standard_Real StringBox::BoxWidth() const
@@ -206,3 +566,33 @@ TopoDS_Shape StringBox::ToShape() const
     }
     else return TopoDS_Shape();
 }
+
+void LeadGeometry::AddSegment(const gp_Pnt &p1, const gp_Pnt &p2)
+{
+    Segments.Append(p1);
+    Segments.Append(p2);
+}
+
+void LeadGeometry::AddTriangle(const gp_Pnt &p1, const gp_Pnt &p2, const gp_Pnt &p3)
+{
+    Triangles.Append(p1);
+    Triangles.Append(p2);
+    Triangles.Append(p3);
+}
+
+void LeadGeometry::AddArc(const gp_Circ &circle, const gp_Pnt &p1, const gp_Pnt &p2)
+{
+    Standard_Real u1 = ElCLib::Parameter(circle, p1);
+    Standard_Real u2 = ElCLib::Parameter(circle, p2);
+    if(u2 < u1)
+        u2 += 2*M_PI;
+
+    // one segment every 5 degrees
+    const Standard_Integer nb = qMax(1, static_cast<Standard_Integer>(std::ceil((u2-u1)/(M_PI/36))));
+    gp_Pnt prev = ElCLib::Value(u1, circle);
+    for(Standard_Integer i=1;i<=nb;++i) {
+        gp_Pnt next = ElCLib::Value(u1 + (u2-u1)*i/nb, circle);
+        AddSegment(prev, next);
+        prev = next;
+    }
+}
@@ -1,15 +1,27 @@
 #ifndef LABEL_PMI_H
 #define LABEL_PMI_H
 
+#include <Bnd_Box.hxx>
 #include <gp_Pnt.hxx>
 #include <gp_Ax2.hxx>
+#include <gp_Circ.hxx>
+#include <gp_Trsf.hxx>
 #include <NCollection_UtfString.hxx>
+#include <NCollection_Vector.hxx>
 #include <Font_BRepFont.hxx>
+#include <Graphic3d_ArrayOfSegments.hxx>
+#include <Graphic3d_ArrayOfTriangles.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Prs3d_LineAspect.hxx>
+#include <Prs3d_ShadingAspect.hxx>
+#include <Prs3d_TextAspect.hxx>
 
+#include <QByteArray>
 #include <QList>
 
 #include "OCCTool/AIS_DraftShape.hxx"
 #include "TolStringInfo.h"
+#include "Label_Record.h"
 
 class TopoDS_Shape;
 
@@ -26,13 +38,70 @@ struct StringBox
     TopoDS_Shape ToShape() const;
 };
 
+//! A string of the label text and where it starts in the local frame
+struct TextRun
+{
+    NCollection_Utf8String Text;
+    gp_Pnt Origin;
+    Standard_Real Height;
+};
+
+//! Mesh of the label text in its local frame, the text starts from the origin on plane XOY
+struct TextMesh
+{
+    TextMesh() : Width(0) {}
+
+    Handle(Graphic3d_ArrayOfTriangles) Triangles; //!< glyphs of all strings
+    Handle(Graphic3d_ArrayOfSegments) Segments;   //!< boxes around the strings
+    NCollection_Vector<TextRun> Runs;             //!< the strings, drawn as viewer text far away
+    Standard_Real Width;
+    QByteArray Key;                               //!< strings, height and padding the mesh is built for
+};
+
+//! The arrays of a text mesh placed in the model 3D space, they are kept
+//! until the mesh or its transformation changes
+struct PlacedText
+{
+    Handle(Graphic3d_ArrayOfTriangles) SourceTriangles;
+    Handle(Graphic3d_ArrayOfSegments) SourceSegments;
+    gp_Trsf Trsf;
+    Handle(Graphic3d_ArrayOfTriangles) Triangles;
+    Handle(Graphic3d_ArrayOfSegments) Segments;
+};
+
+//! Lead lines and arrows of a label in the model 3D space
+struct LeadGeometry
+{
+    //! pairs of points, every pair is a segment
+    NCollection_Vector<gp_Pnt> Segments;
+    //! triples of points, every triple is a triangle
+    NCollection_Vector<gp_Pnt> Triangles;
+
+    void AddSegment(const gp_Pnt& p1, const gp_Pnt& p2);
+    void AddTriangle(const gp_Pnt& p1, const gp_Pnt& p2, const gp_Pnt& p3);
+
+    //! Add the arc from p1 to p2 anticlockwise around the axis of circle
+    void AddArc(const gp_Circ& circle, const gp_Pnt& p1, const gp_Pnt& p2);
+};
+
 class Label_PMI : public AIS_DraftShape
 {
 public:
+    //! The display modes, the text is meshed glyphs up close and the font
+    //! texture of the viewer far away, see Label_LevelOfDetail.
+    //! Mode 1 is left out, the viewer highlights in it.
+    enum DisplayMode {
+        GlyphMode = 0,
+        TextMode = 2
+    };
+
     Label_PMI();
 
     //! Return TRUE for supported display mode.
-    virtual Standard_Boolean AcceptDisplayMode (const Standard_Integer theMode) const Standard_OVERRIDE { return theMode == 0; }
+    virtual Standard_Boolean AcceptDisplayMode (const Standard_Integer theMode) const Standard_OVERRIDE
+    {
+        return theMode == GlyphMode || theMode == TextMode;
+    }
 
     //! Setup color of entire text.
     virtual void SetColor (const Quantity_Color& theColor) Standard_OVERRIDE;
@@ -40,6 +109,10 @@ public:
     //! Set location of shape, interface for drafting
     virtual void SetLocation(const gp_Pnt& pnt) override = 0;
 
+    //! Where SetLocation() puts the label for the point, the projection on
+    //! the plane of label by default
+    virtual gp_Pnt AllowedLocation(const gp_Pnt& thePnt) const;
+
     //! Setup position.
     void SetOriention (const gp_Ax2& oriention);
 
@@ -49,16 +122,68 @@ public:
     //! Setup height.
     void SetHeight (const Standard_Real theHeight);
 
+    //! Returns the font height in the model 3D space.
+    Standard_Real Height() const { return myFontHeight; }
+
+    //! Returns false if the label keeps its size on the screen.
+    Standard_Boolean IsZoomable() const { return myLabelZoomable; }
+
     //! Setup padding between text group
     void SetPadding (const Standard_Real thePadding);
 
+    //! Returns padding between text group
+    Standard_Real Padding() const { return myFontPadding; }
+
     //! Returns label orientation in the model 3D space.
     const gp_Ax2& Orientation3D() const;
 
     //! Returns true if the current text placement mode uses text orientation in the model 3D space.
     Standard_Boolean HasOrientation3D() const;
 
+    //! Start dragging, the label body is moved by local transformation
+    //! and only the lead is rebuilt until EndDrag()
+    virtual void BeginDrag() Standard_OVERRIDE;
+
+    //! Stop dragging and recompute the label at the new location
+    virtual void EndDrag() Standard_OVERRIDE;
+
+    //! Returns true if the label is being dragged
+    Standard_Boolean IsDragging() const { return myIsDragging; }
+
+    //! Set the indices of shapes in PMIModel which the label is bound to
+    void SetShapeIndices(const QList<int>& theIndices) { myShapeIndices = theIndices; }
+
+    //! Returns the indices of bound shapes
+    const QList<int>& ShapeIndices() const { return myShapeIndices; }
+
+    //! Store the data of label, the derived labels add their type, strings and points
+    virtual void SaveRecord(Label_Record& theRecord) const;
+
+    //! Rebuild the label from the record, returns false if the record doesn't fit the label
+    virtual Standard_Boolean LoadRecord(const Label_Record& theRecord);
+
+    //! A box around the text and the points the lead reaches, from the record
+    //! of label, it doesn't need the presentation
+    Bnd_Box Extent() const;
+
+    //! Width of all the strings with their padding, it doesn't need the presentation
+    Standard_Real TextWidth() const;
+
+    //! The point the lead goes to, the first indicated point or the circle center
+    gp_Pnt LeadTarget() const;
+
 protected:
+    //! Compute the lead lines and arrows, which depend on the location of label
+    virtual void computeLead(LeadGeometry& theLead) = 0;
+
+    //! Draw the lead into its own group of presentation of theMode
+    void drawLead(const Handle(Prs3d_Presentation)& thePrs,
+                  const Standard_Integer theMode,
+                  const Handle(Prs3d_ShadingAspect)& anAspect);
+
+    //! Show the label at the current myOrientation3D, called by SetLocation()
+    void updatePosture();
+
     //! Calculate label center, width and height
     Standard_Real calculateStringWidth (const NCollection_Utf8String& str) const;
 
@@ -68,13 +193,28 @@ protected:
     //! Calculate the bound box of string
     StringBox calculateStringBox (const NCollection_Utf8String& str) const;
 
-    //! Compute the shape of string list and their box
-    TopoDS_Shape ComputeStringList(const NCollection_Utf8StringList& strlist, Standard_Real& width) const;
+    //! Compute the mesh of string list and their box,
+    //! it's cached until the strings, height or padding change
+    const TextMesh& ComputeStringList(const NCollection_Utf8StringList& strlist, Standard_Real& width);
+
+    //! Compute the mesh of main string followed by the half height sub&sup string,
+    //! it's cached until the strings or height change
+    const TextMesh& ComputeStringWithSupAndSub(const NCollection_Utf8String& main,
+                                               const NCollection_Utf8String& sub,
+                                               const NCollection_Utf8String& sup,
+                                               Standard_Real& width);
+
+    //! Draw the text mesh, or its strings in TextMode, theTrsf places the local
+    //! frame of text in the model 3D space, the boxes use the line aspect if it's given
+    void drawText(const Handle(Prs3d_Presentation)& thePrs,
+                  const Standard_Integer theMode,
+                  const TextMesh& theMesh,
+                  const gp_Trsf& theTrsf,
+                  const Handle(Prs3d_ShadingAspect)& anAspect,
+                  const Handle(Prs3d_LineAspect)& linAspect = Handle(Prs3d_LineAspect)());
 
-    TopoDS_Shape ComputeStringWithSupAndSub(const NCollection_Utf8String& main,
-                                            const NCollection_Utf8String& sub,
-                                            const NCollection_Utf8String& sup,
-                                            Standard_Real& width);
+    //! Drop the cached text mesh, called when the data of label changes
+    void invalidateText();
 
 protected:
     gp_Ax2 myOrientation3D;
@@ -86,6 +226,32 @@ protected:
     Standard_Real myFontPadding;
     Quantity_Color myLabelColor;
 
+    QList<int> myShapeIndices;
+
+private:
+    //! Return the key of text mesh with the current height and padding
+    QByteArray textKey(const char* theType, const NCollection_Utf8StringList& strlist) const;
+
+    //! The arrays of theMesh placed by theTrsf, from the cache if they are unchanged
+    const PlacedText& placeText(const TextMesh& theMesh, const gp_Trsf& theTrsf);
+
+    //! Fill the lead group, theTrsf is applied to every point
+    void fillLead(const Handle(Graphic3d_Group)& theGroup, const LeadGeometry& theLead, const gp_Trsf& theTrsf);
+
+    TextMesh myTextMesh;
+    PlacedText myPlacedText;
+    //! the viewer text aspect of TextMode, built on the first draw
+    Handle(Prs3d_TextAspect) myTextAspect;
+
+    //! the lead group of each display mode, GlyphMode and TextMode
+    Handle(Graphic3d_Group) myLeadGroups[2];
+    Handle(Prs3d_ShadingAspect) myLeadAspect;
+
+    Standard_Boolean myIsDragging;
+    Standard_Boolean myIsDragged;
+    gp_Trsf myDragStartTrsf;  //!< orientation of label when the drag starts
+    gp_Trsf myDragBaseTrsf;   //!< local transformation when the drag starts
+
 public:
 
     //! CASCADE RTTI
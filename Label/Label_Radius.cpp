@@ -1,6 +1,5 @@
 ﻿#include "Label_Radius.h"
 
-#include <BRepBuilderAPI_MakeEdge.hxx>
 #include <Font_BRepTextBuilder.hxx>
 #include <Prs3d_Arrow.hxx>
 #include <Prs3d_ShadingAspect.hxx>
@@ -44,9 +43,25 @@ void Label_Radius::SetLocation(const gp_Pnt &pnt)
 
     myOrientation3D.SetLocation(pp);
     myOrientation3D.SetXDirection(pp.XYZ()-myCircle.Location().XYZ());
-    this->SetToUpdate();
-    this->UpdatePresentations();
-    this->GetContext()->RecomputeSelectionOnly(this);
+    updatePosture();
+}
+
+void Label_Radius::SaveRecord(Label_Record &theRecord) const
+{
+    Label_PMI::SaveRecord(theRecord);
+    theRecord.Type = Label_Record::Radius;
+    theRecord.Strings = { myMainStr, mySUPStr, mySUBStr };
+    theRecord.Circle = myCircle;
+}
+
+Standard_Boolean Label_Radius::LoadRecord(const Label_Record &theRecord)
+{
+    if(theRecord.Type != Label_Record::Radius || theRecord.Strings.size() < 3)
+        return Standard_False;
+
+    SetData(theRecord.Strings[0], theRecord.Strings[1], theRecord.Strings[2]);
+    SetDiamension(theRecord.Circle);
+    return Label_PMI::LoadRecord(theRecord);
 }
 
 void Label_Radius::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsMgr*/,
@@ -55,7 +70,8 @@ void Label_Radius::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrs
 {
     switch (theMode)
     {
-    case 0:
+    case GlyphMode:
+    case TextMode:
     {
         // 0. verify the data
         if(myMainStr.IsEmpty())
@@ -77,12 +93,11 @@ void Label_Radius::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrs
         anAspect->SetColor(myLabelColor);
 
         // 3.draw the main&sup&sub string
-        TopoDS_Shape strShape = ComputeStringWithSupAndSub(myMainStr,mySUBStr,mySUPStr,myLabelWidth);
-        StdPrs_ShadedShape::Add(thePrs,strShape,myDrawer);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect(anAspect->Aspect());
+        const TextMesh& strMesh = ComputeStringWithSupAndSub(myMainStr,mySUBStr,mySUPStr,myLabelWidth);
+        drawText(thePrs, theMode, strMesh, calculateOrientionTrsf(), anAspect);
 
         // 4.draw the fly out line and arrow
-        ComputeLeadLine(thePrs, anAspect);
+        drawLead(thePrs, theMode, anAspect);
 
         break;
     }
@@ -121,8 +136,7 @@ void Label_Radius::ComputeSelection (const Handle(SelectMgr_Selection)& theSelec
     }
 }
 
-void Label_Radius::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
-                                    const Handle(Prs3d_ShadingAspect)& anAspect)
+void Label_Radius::computeLead(LeadGeometry& theLead)
 {
     const gp_Pnt textFirst = myOrientation3D.Location();
     const gp_Pnt textSecond = gp_Pnt(myLabelWidth, 0, 0).Transformed(calculateOrientionTrsf());
@@ -138,9 +152,7 @@ void Label_Radius::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
         lead = circP;
     }
     // draw the line
-    TopoDS_Shape leadLin = BRepBuilderAPI_MakeEdge(center, lead);
-    StdPrs_ShadedShape::Add(thePrs,leadLin,myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddSegment(center, lead);
 
     // draw the arrow triangle
     gp_Dir arrowDir = direc.Reversed();
@@ -153,10 +165,5 @@ void Label_Radius::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
     gp_Pnt arrowL = arrowMid.Translated(0.5*arrowBotm);
     gp_Pnt arrowR = arrowMid.Translated(0.5*arrowBotm.Reversed());
 
-    Handle(Graphic3d_ArrayOfTriangles) aTriangle = new Graphic3d_ArrayOfTriangles(3);
-    aTriangle->AddVertex (arrowL);
-    aTriangle->AddVertex (circP);
-    aTriangle->AddVertex (arrowR);
-    thePrs->CurrentGroup()->AddPrimitiveArray(aTriangle);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddTriangle(arrowL, circP, arrowR);
 }
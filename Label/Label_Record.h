@@ -0,0 +1,40 @@
+#ifndef LABEL_RECORD_H
+#define LABEL_RECORD_H
+
+#include <gp_Ax2.hxx>
+#include <gp_Circ.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Trsf.hxx>
+#include <NCollection_UtfString.hxx>
+
+#include <QList>
+
+//! The data to rebuild a label without its input dialog,
+//! it's what a session file stores for every label
+struct Label_Record
+{
+    enum Type {
+        Tolerance = 0,
+        Datum,
+        Length,
+        Radius,
+        Diameter,
+        Angle,
+        Taper,
+        TypeCount
+    };
+
+    Label_Record() : Type(-1), Height(4), Padding(2) {}
+
+    int Type;
+    QList<NCollection_Utf8String> Strings;
+    gp_Ax2 Orientation;
+    QList<gp_Pnt> Points;   //!< touch points or the points the label indicates
+    gp_Circ Circle;         //!< circle of radius and diameter labels
+    gp_Trsf Transformation; //!< local transformation of the label
+    Standard_Real Height;
+    Standard_Real Padding;
+    QList<int> ShapeIndices; //!< indices of the bound shapes in PMIModel
+};
+
+#endif // LABEL_RECORD_H
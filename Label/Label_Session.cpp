@@ -0,0 +1,477 @@
+#include "Label_Session.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QSaveFile>
+#include <QVector>
+
+#include <OSD_Parallel.hxx>
+#include <Standard_Failure.hxx>
+
+#include <algorithm>
+
+#include "Label_Angle.h"
+#include "Label_Datum.h"
+#include "Label_Diameter.h"
+#include "Label_Length.h"
+#include "Label_Radius.h"
+#include "Label_Taper.h"
+#include "Label_Tolerance.h"
+
+// header of the binary session file
+static const quint32 SESSION_MAGIC = 0x504D4953; // "PMIS"
+static const quint32 SESSION_VERSION = 1;
+// no label has more strings, points or bound shapes, a bigger count means a broken file
+static const quint32 MAX_ITEM_COUNT = 1024;
+
+static const char* TYPE_NAMES[Label_Record::TypeCount] = {
+    "Tolerance", "Datum", "Length", "Radius", "Diameter", "Angle", "Taper"
+};
+
+//! Create the labels of records, one record in each call
+struct CreateFunctor
+{
+    CreateFunctor(const QList<Label_Record>& records, Handle(Label_PMI)* labels)
+        : myRecords(records), myLabels(labels) {}
+
+    void operator()(int index) const {
+        try {
+            myLabels[index] = Label_Session::CreateLabel(myRecords[index]);
+        }
+        catch(const Standard_Failure&) {
+            myLabels[index].Nullify();
+        }
+    }
+
+    const QList<Label_Record>& myRecords;
+    Handle(Label_PMI)* myLabels;
+};
+
+static bool hasCircle(int type)
+{
+    return type == Label_Record::Radius || type == Label_Record::Diameter;
+}
+
+// binary helpers, gp_Ax2 is stored as location, main direction and X direction
+
+static void writeXYZ(QDataStream& stream, const gp_XYZ& xyz)
+{
+    stream << xyz.X() << xyz.Y() << xyz.Z();
+}
+
+static gp_XYZ readXYZ(QDataStream& stream)
+{
+    double x = 0, y = 0, z = 0;
+    stream >> x >> y >> z;
+    return gp_XYZ(x, y, z);
+}
+
+static void writeAx2(QDataStream& stream, const gp_Ax2& ax2)
+{
+    writeXYZ(stream, ax2.Location().XYZ());
+    writeXYZ(stream, ax2.Direction().XYZ());
+    writeXYZ(stream, ax2.XDirection().XYZ());
+}
+
+static gp_Ax2 readAx2(QDataStream& stream)
+{
+    gp_XYZ location = readXYZ(stream);
+    gp_XYZ direction = readXYZ(stream);
+    gp_XYZ xdirection = readXYZ(stream);
+    return gp_Ax2(gp_Pnt(location), gp_Dir(direction), gp_Dir(xdirection));
+}
+
+static void writeTrsf(QDataStream& stream, const gp_Trsf& trsf)
+{
+    for(int row=1;row<=3;++row)
+        for(int col=1;col<=4;++col)
+            stream << trsf.Value(row, col);
+}
+
+//! Build the transformation of 3x4 matrix by rows, an identity one keeps its form
+static gp_Trsf makeTrsf(const double v[12])
+{
+    static const double identity[12] = { 1,0,0,0, 0,1,0,0, 0,0,1,0 };
+    gp_Trsf trsf;
+    if(std::equal(v, v + 12, identity))
+        return trsf;
+
+    trsf.SetValues(v[0], v[1], v[2], v[3],
+                   v[4], v[5], v[6], v[7],
+                   v[8], v[9], v[10], v[11]);
+    return trsf;
+}
+
+static gp_Trsf readTrsf(QDataStream& stream)
+{
+    double v[12];
+    for(int i=0;i<12;++i)
+        stream >> v[i];
+    return makeTrsf(v);
+}
+
+// JSON helpers, the same layout as the binary file
+
+static QJsonArray xyzToJson(const gp_XYZ& xyz)
+{
+    return QJsonArray({ xyz.X(), xyz.Y(), xyz.Z() });
+}
+
+static gp_XYZ xyzFromJson(const QJsonArray& array, int from = 0)
+{
+    return gp_XYZ(array.at(from).toDouble(), array.at(from+1).toDouble(), array.at(from+2).toDouble());
+}
+
+static QJsonArray ax2ToJson(const gp_Ax2& ax2)
+{
+    QJsonArray array;
+    const gp_XYZ values[3] = { ax2.Location().XYZ(), ax2.Direction().XYZ(), ax2.XDirection().XYZ() };
+    for(int i=0;i<3;++i) {
+        array.append(values[i].X());
+        array.append(values[i].Y());
+        array.append(values[i].Z());
+    }
+    return array;
+}
+
+static gp_Ax2 ax2FromJson(const QJsonArray& array)
+{
+    return gp_Ax2(gp_Pnt(xyzFromJson(array, 0)), gp_Dir(xyzFromJson(array, 3)), gp_Dir(xyzFromJson(array, 6)));
+}
+
+bool Label_Session::Save(const QString &fileName, const QList<Handle(Label_PMI)> &labels, QString &error)
+{
+    QList<Label_Record> records;
+    records.reserve(labels.size());
+    for(int i=0;i<labels.size();++i) {
+        Label_Record record;
+        labels[i]->SaveRecord(record);
+        if(record.Type >= 0 && record.Type < Label_Record::TypeCount)
+            records.append(record);
+    }
+
+    QSaveFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly)) {
+        error = QObject::tr("Can't write the file %1").arg(fileName);
+        return false;
+    }
+
+    bool ok = isJson(fileName) ? writeJson(&file, records) : writeBinary(&file, records);
+    if(!ok || !file.commit()) {
+        error = QObject::tr("Can't write the file %1").arg(fileName);
+        return false;
+    }
+    return true;
+}
+
+bool Label_Session::Load(const QString &fileName, QList<Handle(Label_PMI)> &labels, QString &error)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        error = QObject::tr("Can't open the file %1").arg(fileName);
+        return false;
+    }
+
+    QList<Label_Record> records;
+    try {
+        bool ok = isJson(fileName) ? readJson(&file, records, error) : readBinary(&file, records, error);
+        if(!ok)
+            return false;
+
+        // the labels are independent, they are created on every core
+        QVector<Handle(Label_PMI)> created(records.size());
+        if(!records.isEmpty())
+            OSD_Parallel::For(0, records.size(), CreateFunctor(records, created.data()));
+
+        labels.clear();
+        labels.reserve(records.size());
+        for(int i=0;i<created.size();++i) {
+            if(created[i].IsNull()) {
+                error = QObject::tr("The label %1 is invalid").arg(i+1);
+                return false;
+            }
+            labels.append(created[i]);
+        }
+    }
+    catch(const Standard_Failure&) {
+        // degenerated axis or transformation in the file
+        error = QObject::tr("The file %1 is broken").arg(fileName);
+        return false;
+    }
+    return true;
+}
+
+Handle(Label_PMI) Label_Session::CreateLabel(const Label_Record &record)
+{
+    Handle(Label_PMI) aLabel;
+    switch(record.Type)
+    {
+    case Label_Record::Tolerance:
+        aLabel = new Label_Tolerance();
+        break;
+    case Label_Record::Datum:
+        aLabel = new Label_Datum();
+        break;
+    case Label_Record::Length:
+        aLabel = new Label_Length();
+        break;
+    case Label_Record::Radius:
+        aLabel = new Label_Radius();
+        break;
+    case Label_Record::Diameter:
+        aLabel = new Label_Diameter();
+        break;
+    case Label_Record::Angle:
+        aLabel = new Label_Angle();
+        break;
+    case Label_Record::Taper:
+        aLabel = new Label_Taper();
+        break;
+    default:
+        return aLabel;
+    }
+
+    if(!aLabel->LoadRecord(record))
+        aLabel.Nullify();
+    return aLabel;
+}
+
+QString Label_Session::TypeName(int type)
+{
+    if(type < 0 || type >= Label_Record::TypeCount)
+        return QString();
+    return QString::fromLatin1(TYPE_NAMES[type]);
+}
+
+bool Label_Session::isJson(const QString &fileName)
+{
+    return fileName.endsWith(".json", Qt::CaseInsensitive);
+}
+
+bool Label_Session::writeBinary(QIODevice *device, const QList<Label_Record> &records)
+{
+    QDataStream stream(device);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream << SESSION_MAGIC << SESSION_VERSION << quint32(records.size());
+    for(int i=0;i<records.size();++i) {
+        const Label_Record& record = records[i];
+        stream << qint32(record.Type);
+
+        stream << quint32(record.Strings.size());
+        for(int k=0;k<record.Strings.size();++k)
+            stream << QByteArray(record.Strings[k].ToCString(), record.Strings[k].Size());
+
+        writeAx2(stream, record.Orientation);
+
+        stream << quint32(record.Points.size());
+        for(int k=0;k<record.Points.size();++k)
+            writeXYZ(stream, record.Points[k].XYZ());
+
+        if(hasCircle(record.Type)) {
+            writeAx2(stream, record.Circle.Position());
+            stream << record.Circle.Radius();
+        }
+
+        writeTrsf(stream, record.Transformation);
+        stream << record.Height << record.Padding;
+
+        stream << quint32(record.ShapeIndices.size());
+        for(int k=0;k<record.ShapeIndices.size();++k)
+            stream << qint32(record.ShapeIndices[k]);
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+bool Label_Session::readBinary(QIODevice *device, QList<Label_Record> &records, QString &error)
+{
+    QDataStream stream(device);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic = 0, version = 0, count = 0;
+    stream >> magic >> version >> count;
+    if(stream.status() != QDataStream::Ok || magic != SESSION_MAGIC) {
+        error = QObject::tr("Not a session file");
+        return false;
+    }
+    if(version > SESSION_VERSION) {
+        error = QObject::tr("The session file is made by a newer version");
+        return false;
+    }
+
+    records.clear();
+    for(quint32 i=0;i<count;++i) {
+        Label_Record record;
+        qint32 type = -1;
+        quint32 itemCount = 0;
+
+        stream >> type;
+        record.Type = type;
+
+        stream >> itemCount;
+        if(itemCount > MAX_ITEM_COUNT)
+            break;
+        for(quint32 k=0;k<itemCount;++k) {
+            QByteArray str;
+            stream >> str;
+            record.Strings.append(NCollection_Utf8String(str.constData()));
+        }
+
+        record.Orientation = readAx2(stream);
+
+        stream >> itemCount;
+        if(itemCount > MAX_ITEM_COUNT)
+            break;
+        for(quint32 k=0;k<itemCount;++k)
+            record.Points.append(gp_Pnt(readXYZ(stream)));
+
+        if(hasCircle(record.Type)) {
+            gp_Ax2 position = readAx2(stream);
+            double radius = 0;
+            stream >> radius;
+            record.Circle = gp_Circ(position, radius);
+        }
+
+        record.Transformation = readTrsf(stream);
+        stream >> record.Height >> record.Padding;
+
+        stream >> itemCount;
+        if(itemCount > MAX_ITEM_COUNT)
+            break;
+        for(quint32 k=0;k<itemCount;++k) {
+            qint32 index = -1;
+            stream >> index;
+            record.ShapeIndices.append(index);
+        }
+
+        if(stream.status() != QDataStream::Ok)
+            break;
+        records.append(record);
+    }
+
+    if(quint32(records.size()) != count) {
+        error = QObject::tr("The session file is broken");
+        return false;
+    }
+    return true;
+}
+
+bool Label_Session::writeJson(QIODevice *device, const QList<Label_Record> &records)
+{
+    QJsonArray labels;
+    for(int i=0;i<records.size();++i) {
+        const Label_Record& record = records[i];
+        QJsonObject label;
+        label["type"] = TypeName(record.Type);
+
+        QJsonArray strings;
+        for(int k=0;k<record.Strings.size();++k)
+            strings.append(QString::fromUtf8(record.Strings[k].ToCString()));
+        label["strings"] = strings;
+
+        label["orientation"] = ax2ToJson(record.Orientation);
+
+        QJsonArray points;
+        for(int k=0;k<record.Points.size();++k)
+            points.append(xyzToJson(record.Points[k].XYZ()));
+        label["points"] = points;
+
+        if(hasCircle(record.Type)) {
+            QJsonArray circle = ax2ToJson(record.Circle.Position());
+            circle.append(record.Circle.Radius());
+            label["circle"] = circle;
+        }
+
+        QJsonArray trsf;
+        for(int row=1;row<=3;++row)
+            for(int col=1;col<=4;++col)
+                trsf.append(record.Transformation.Value(row, col));
+        label["transformation"] = trsf;
+
+        label["height"] = record.Height;
+        label["padding"] = record.Padding;
+
+        QJsonArray shapes;
+        for(int k=0;k<record.ShapeIndices.size();++k)
+            shapes.append(record.ShapeIndices[k]);
+        label["shapes"] = shapes;
+
+        labels.append(label);
+    }
+
+    QJsonObject root;
+    root["version"] = int(SESSION_VERSION);
+    root["labels"] = labels;
+    return device->write(QJsonDocument(root).toJson()) >= 0;
+}
+
+bool Label_Session::readJson(QIODevice *device, QList<Label_Record> &records, QString &error)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(device->readAll(), &parseError);
+    if(doc.isNull() || !doc.isObject()) {
+        error = QObject::tr("Not a session file: %1").arg(parseError.errorString());
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    if(root["version"].toInt() > int(SESSION_VERSION)) {
+        error = QObject::tr("The session file is made by a newer version");
+        return false;
+    }
+
+    QJsonArray labels = root["labels"].toArray();
+    records.clear();
+    for(int i=0;i<labels.size();++i) {
+        QJsonObject label = labels[i].toObject();
+        Label_Record record;
+
+        QString typeName = label["type"].toString();
+        for(int type=0;type<Label_Record::TypeCount;++type) {
+            if(typeName == TYPE_NAMES[type])
+                record.Type = type;
+        }
+
+        QJsonArray strings = label["strings"].toArray();
+        for(int k=0;k<strings.size();++k)
+            record.Strings.append(NCollection_Utf8String(strings[k].toString().toUtf8().constData()));
+
+        QJsonArray orientation = label["orientation"].toArray();
+        QJsonArray circle = label["circle"].toArray();
+        QJsonArray trsf = label["transformation"].toArray();
+        if(orientation.size() != 9 || trsf.size() != 12 || (hasCircle(record.Type) && circle.size() != 10)) {
+            error = QObject::tr("The label %1 is invalid").arg(i+1);
+            return false;
+        }
+
+        record.Orientation = ax2FromJson(orientation);
+
+        QJsonArray points = label["points"].toArray();
+        for(int k=0;k<points.size();++k)
+            record.Points.append(gp_Pnt(xyzFromJson(points[k].toArray())));
+
+        if(hasCircle(record.Type))
+            record.Circle = gp_Circ(ax2FromJson(circle), circle[9].toDouble());
+
+        double values[12];
+        for(int k=0;k<12;++k)
+            values[k] = trsf[k].toDouble();
+        record.Transformation = makeTrsf(values);
+
+        record.Height = label["height"].toDouble(record.Height);
+        record.Padding = label["padding"].toDouble(record.Padding);
+
+        QJsonArray shapes = label["shapes"].toArray();
+        for(int k=0;k<shapes.size();++k)
+            record.ShapeIndices.append(shapes[k].toInt(-1));
+
+        records.append(record);
+    }
+    return true;
+}
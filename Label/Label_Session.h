@@ -0,0 +1,37 @@
+#ifndef LABEL_SESSION_H
+#define LABEL_SESSION_H
+
+#include <QList>
+#include <QString>
+
+#include "Label_PMI.h"
+
+//! Read and write the labels of an annotation session.
+//! The session is a versioned binary file, or JSON if the file name
+//! ends with ".json", which is meant for debugging.
+class Label_Session
+{
+public:
+    //! Write the labels into file, return false and the reason if it fails
+    static bool Save(const QString& fileName, const QList<Handle(Label_PMI)>& labels, QString& error);
+
+    //! Read the labels from file, return false and the reason if it fails,
+    //! the labels are created on every core and not displayed
+    static bool Load(const QString& fileName, QList<Handle(Label_PMI)>& labels, QString& error);
+
+    //! Create the label of record type and rebuild it, null if the record is invalid
+    static Handle(Label_PMI) CreateLabel(const Label_Record& record);
+
+    //! Return the name of record type, used by the JSON file
+    static QString TypeName(int type);
+
+private:
+    static bool isJson(const QString& fileName);
+
+    static bool writeBinary(QIODevice* device, const QList<Label_Record>& records);
+    static bool readBinary(QIODevice* device, QList<Label_Record>& records, QString& error);
+    static bool writeJson(QIODevice* device, const QList<Label_Record>& records);
+    static bool readJson(QIODevice* device, QList<Label_Record>& records, QString& error);
+};
+
+#endif // LABEL_SESSION_H
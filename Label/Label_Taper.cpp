@@ -1,6 +1,5 @@
 ﻿#include "Label_Taper.h"
 
-#include <BRepBuilderAPI_MakeEdge.hxx>
 #include <BRepBuilderAPI_MakePolygon.hxx>
 #include <Font_BRepTextBuilder.hxx>
 #include <Prs3d_Arrow.hxx>
@@ -39,10 +38,30 @@ void Label_Taper::SetLocation(const gp_Pnt &pnt)
     gp_Pnt pp = PPOS.NearestPoint();
 
     myOrientation3D.SetLocation(pp);
+    updatePosture();
+}
 
-    this->SetToUpdate();
-    this->UpdatePresentations();
-    this->GetContext()->RecomputeSelectionOnly(this);
+void Label_Taper::SetTouchPoint(const gp_Pnt &touchPnt)
+{
+    myTouchPoint = touchPnt;
+}
+
+void Label_Taper::SaveRecord(Label_Record &theRecord) const
+{
+    Label_PMI::SaveRecord(theRecord);
+    theRecord.Type = Label_Record::Taper;
+    theRecord.Strings = { myTaperStr };
+    theRecord.Points = { myTouchPoint };
+}
+
+Standard_Boolean Label_Taper::LoadRecord(const Label_Record &theRecord)
+{
+    if(theRecord.Type != Label_Record::Taper || theRecord.Strings.isEmpty() || theRecord.Points.isEmpty())
+        return Standard_False;
+
+    SetData(theRecord.Strings[0]);
+    SetTouchPoint(theRecord.Points[0]);
+    return Label_PMI::LoadRecord(theRecord);
 }
 
 void Label_Taper::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsMgr*/,
@@ -51,7 +70,8 @@ void Label_Taper::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsM
 {
     switch (theMode)
     {
-    case 0:
+    case GlyphMode:
+    case TextMode:
     {
         // 0. verify the data
         if(myTaperStr.IsEmpty())
@@ -73,12 +93,21 @@ void Label_Taper::Compute (const Handle(PrsMgr_PresentationManager3d)& /*thePrsM
         anAspect->SetColor(myLabelColor);
 
         // 3.draw the main&sup&sub string
-        TopoDS_Shape strShape = ComputeStringWithSupAndSub(myTaperStr, "", "", myLabelWidth);
-        StdPrs_ShadedShape::Add(thePrs,strShape,myDrawer);
+        const TextMesh& strMesh = ComputeStringWithSupAndSub(myTaperStr, "", "", myLabelWidth);
+        drawText(thePrs, theMode, strMesh, calculateOrientionTrsf(), anAspect);
+
+        // 4.draw the taper symbol before the text
+        gp_Trsf apply = calculateOrientionTrsf();
+        const gp_Pnt left = gp_Pnt(0,0,0).Transformed(apply);
+        gp_Pnt symLeft = left.Translated(-1.25*myFontHeight*myOrientation3D.XDirection());
+        gp_Pnt symBt1 = left.Translated(0.35*myFontHeight*myOrientation3D.YDirection());
+        gp_Pnt symBt2 = left.Translated(-0.35*myFontHeight*myOrientation3D.YDirection());
+        TopoDS_Shape symbolShape = BRepBuilderAPI_MakePolygon(symBt1, symBt2, symLeft, Standard_True);
+        StdPrs_ShadedShape::Add(thePrs,symbolShape,myDrawer);
         thePrs->CurrentGroup()->SetGroupPrimitivesAspect(anAspect->Aspect());
 
-        // 4.draw the fly out line and arrow
-        ComputeLeadLine(thePrs, anAspect);
+        // 5.draw the fly out line and arrow
+        drawLead(thePrs, theMode, anAspect);
 
         break;
     }
@@ -117,23 +146,15 @@ void Label_Taper::ComputeSelection (const Handle(SelectMgr_Selection)& theSelect
     }
 }
 
-void Label_Taper::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
-                                   const Handle(Prs3d_ShadingAspect)& anAspect)
+void Label_Taper::computeLead(LeadGeometry& theLead)
 {
     gp_Trsf apply = calculateOrientionTrsf();
 
     const gp_Pnt left = gp_Pnt(0,0,0).Transformed(apply);
     const gp_Pnt right = gp_Pnt(myLabelWidth,0,0).Transformed(apply);// the text's start and end position
+    const gp_Pnt symLeft = left.Translated(-1.25*myFontHeight*myOrientation3D.XDirection());
 
-    // 1 draw the symbol
-    gp_Pnt symLeft = left.Translated(-1.25*myFontHeight*myOrientation3D.XDirection());
-    gp_Pnt symBt1 = left.Translated(0.35*myFontHeight*myOrientation3D.YDirection());
-    gp_Pnt symBt2 = left.Translated(-0.35*myFontHeight*myOrientation3D.YDirection());
-    TopoDS_Shape symbolShape = BRepBuilderAPI_MakePolygon(symBt1, symBt2, symLeft, Standard_True);
-    StdPrs_ShadedShape::Add(thePrs,symbolShape,myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect(anAspect->Aspect());
-
-    // 2 draw the horizon segment
+    // 1 draw the horizon segment
     double disl = myTouchPoint.Distance(left);
     double disr = myTouchPoint.Distance(right);
 
@@ -141,11 +162,9 @@ void Label_Taper::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
     gp_Pnt beginPnt = (disl <= disr) ? gp_Pnt(-2.5*myFontHeight,0,0).Transformed(apply) :
                                        right; // where to begin the arrow
 
-    BRepBuilderAPI_MakeEdge aBuilder(segBegin,beginPnt);
-    StdPrs_ShadedShape::Add(thePrs,aBuilder.Shape(),myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddSegment(segBegin,beginPnt);
 
-    // 3 draw the arrow
+    // 2 draw the arrow
     gp_Dir arrowDir(myTouchPoint.XYZ()-beginPnt.XYZ());
     gp_Pnt arrowMid = myTouchPoint.Translated(4*arrowDir.Reversed());
     gp_Dir arrowBotm = myOrientation3D.YDirection();
@@ -153,15 +172,8 @@ void Label_Taper::ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
     gp_Pnt arrowR = arrowMid.Translated(0.5*arrowBotm.Reversed());
 
     // arrow's lead line
-    BRepBuilderAPI_MakeEdge bBuilder(beginPnt,arrowMid);
-    StdPrs_ShadedShape::Add(thePrs,bBuilder.Shape(),myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddSegment(beginPnt,arrowMid);
 
     // arrow's triangle
-    Handle(Graphic3d_ArrayOfTriangles) aTriangle = new Graphic3d_ArrayOfTriangles(3);
-    aTriangle->AddVertex (arrowL);
-    aTriangle->AddVertex (myTouchPoint);
-    aTriangle->AddVertex (arrowR);
-    thePrs->CurrentGroup()->AddPrimitiveArray(aTriangle);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddTriangle(arrowL,myTouchPoint,arrowR);
 }
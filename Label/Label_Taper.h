@@ -19,9 +19,16 @@ public:
     //! Set location of shape, interface for drafting
     virtual void SetLocation(const gp_Pnt& pnt) override;
 
+    //! Store the type, strings and points of label
+    virtual void SaveRecord(Label_Record& theRecord) const Standard_OVERRIDE;
+
+    //! Rebuild the label from the record
+    virtual Standard_Boolean LoadRecord(const Label_Record& theRecord) Standard_OVERRIDE;
+
     //! Set the length value by main,sup,sub string
     void SetData(const NCollection_Utf8String& value) {
         myTaperStr = value;
+        invalidateText();
     }
 
     //! Setup touch point
@@ -38,8 +45,8 @@ protected:
     virtual void ComputeSelection (const Handle(SelectMgr_Selection)& theSelection,
                                    const Standard_Integer theMode) Standard_OVERRIDE;
 
-    void ComputeLeadLine (const Handle(Prs3d_Presentation)& thePrs,
-                          const Handle(Prs3d_ShadingAspect)& anAspect);
+    //! Add the horizon segment and arrow to the touch point
+    virtual void computeLead(LeadGeometry& theLead) Standard_OVERRIDE;
 
 protected:
 
@@ -1,6 +1,5 @@
 ﻿#include "Label_Tolerance.h"
 
-#include <BRepBuilderAPI_MakeEdge.hxx>
 #include <BRepBuilderAPI_MakePolygon.hxx>
 #include <BRepBuilderAPI_Transform.hxx>
 #include <Font_BRepFont.hxx>
@@ -38,9 +37,26 @@ void Label_Tolerance::SetLocation(const gp_Pnt &pnt)
     gp_Pnt pp = PPOS.NearestPoint();
 
     myOrientation3D.SetLocation(pp);
-    this->SetToUpdate();
-    this->UpdatePresentations();
-    this->GetContext()->RecomputeSelectionOnly(this);
+    updatePosture();
+}
+
+void Label_Tolerance::SaveRecord(Label_Record &theRecord) const
+{
+    Label_PMI::SaveRecord(theRecord);
+    theRecord.Type = Label_Record::Tolerance;
+    theRecord.Strings = { myToleranceStr, myTolValue1, myTolValue2 };
+    theRecord.Strings.append(myBaseStrList);
+    theRecord.Points = { myTouchPoint };
+}
+
+Standard_Boolean Label_Tolerance::LoadRecord(const Label_Record &theRecord)
+{
+    if(theRecord.Type != Label_Record::Tolerance || theRecord.Strings.size() < 3 || theRecord.Points.isEmpty())
+        return Standard_False;
+
+    SetData(theRecord.Strings[0], theRecord.Strings[1], theRecord.Strings[2], theRecord.Strings.mid(3));
+    SetTouchPoint(theRecord.Points[0]);
+    return Label_PMI::LoadRecord(theRecord);
 }
 
 void Label_Tolerance::SetData (const NCollection_Utf8String &tolName,
@@ -55,6 +71,7 @@ void Label_Tolerance::SetData (const NCollection_Utf8String &tolName,
     myTolValue1 = tolVal1;
     myTolValue2 = tolVal2;
     myBaseStrList = baseList;
+    invalidateText();
 }
 
 void Label_Tolerance::SetPosture (const gp_Pnt& touchPnt, const gp_Ax2 &oriention)
@@ -74,7 +91,8 @@ void Label_Tolerance::Compute (const Handle(PrsMgr_PresentationManager3d)& /*the
 {
     switch (theMode)
     {
-    case 0:
+    case GlyphMode:
+    case TextMode:
     {
         // 0. verify the data
         if(myToleranceStr.IsEmpty() || myTolValue1.IsEmpty())
@@ -101,15 +119,12 @@ void Label_Tolerance::Compute (const Handle(PrsMgr_PresentationManager3d)& /*the
         // 3.draw the tolerance symbol and it's bound box
         NCollection_Utf8StringList strList;
         strList << myToleranceStr << myTolValue1 << myTolValue2 << myBaseStrList;
-        TopoDS_Shape strShape = ComputeStringList(strList, myLabelWidth);
-        StdPrs_ShadedShape::Add(thePrs,strShape,myDrawer);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect(anAspect->Aspect());
-        StdPrs_ShadedShape::AddWireframeForFreeElements(thePrs,strShape,myDrawer);
-        thePrs->CurrentGroup()->SetGroupPrimitivesAspect(linAspect->Aspect());
+        const TextMesh& strMesh = ComputeStringList(strList, myLabelWidth);
+        drawText(thePrs, theMode, strMesh, calculateOrientionTrsf(), anAspect, linAspect);
 
 
         // 4.draw the lead wire
-        appendLeadOfLabel(thePrs,anAspect);
+        drawLead(thePrs,theMode,anAspect);
 
         break;
     }
@@ -147,8 +162,7 @@ void Label_Tolerance::ComputeSelection (const Handle(SelectMgr_Selection)& theSe
     }
 }
 
-void Label_Tolerance::appendLeadOfLabel(const Handle(Prs3d_Presentation)& thePrs,
-                                        const Handle(Prs3d_ShadingAspect)& anAspect)
+void Label_Tolerance::computeLead(LeadGeometry& theLead)
 {
     gp_Trsf apply = calculateOrientionTrsf();
 
@@ -162,9 +176,7 @@ void Label_Tolerance::appendLeadOfLabel(const Handle(Prs3d_Presentation)& thePrs
                                        gp_Pnt(myLabelWidth-2*myFontPadding+2*myFontHeight,0.35*myFontHeight,0).Transformed(apply);
 
     // horizon segment
-    BRepBuilderAPI_MakeEdge aBuilder(leadPnt,beginPnt);
-    StdPrs_ShadedShape::Add(thePrs,aBuilder.Shape(),myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddSegment(leadPnt,beginPnt);
 
     // arrow
     gp_Dir arrowDir(myTouchPoint.XYZ()-beginPnt.XYZ());
@@ -174,15 +186,8 @@ void Label_Tolerance::appendLeadOfLabel(const Handle(Prs3d_Presentation)& thePrs
     gp_Pnt arrowR = arrowMid.Translated(0.5*arrowBotm.Reversed());
 
     // arrow's lead line
-    BRepBuilderAPI_MakeEdge bBuilder(beginPnt,arrowMid);
-    StdPrs_ShadedShape::Add(thePrs,bBuilder.Shape(),myDrawer);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddSegment(beginPnt,arrowMid);
 
     // arrow's triangle
-    Handle(Graphic3d_ArrayOfTriangles) aTriangle = new Graphic3d_ArrayOfTriangles(3);
-    aTriangle->AddVertex (arrowL);
-    aTriangle->AddVertex (myTouchPoint);
-    aTriangle->AddVertex (arrowR);
-    thePrs->CurrentGroup()->AddPrimitiveArray(aTriangle);
-    thePrs->CurrentGroup()->SetGroupPrimitivesAspect (anAspect->Aspect());
+    theLead.AddTriangle(arrowL,myTouchPoint,arrowR);
 }
@@ -14,6 +14,12 @@ public:
     //! Set location of shape, interface for drafting
     virtual void SetLocation(const gp_Pnt& pnt) override;
 
+    //! Store the type, strings and points of label
+    virtual void SaveRecord(Label_Record& theRecord) const Standard_OVERRIDE;
+
+    //! Rebuild the label from the record
+    virtual Standard_Boolean LoadRecord(const Label_Record& theRecord) Standard_OVERRIDE;
+
     //! Setup text.
     void SetData (const NCollection_Utf8String& tolName,
                   const NCollection_Utf8String& tolVal1,
@@ -38,8 +44,7 @@ protected:
                                    const Standard_Integer theMode) Standard_OVERRIDE;
 
     //! Add the arrow between touch point and label
-    void appendLeadOfLabel(const Handle(Prs3d_Presentation)& thePrs,
-                           const Handle(Prs3d_ShadingAspect)& anAspect);
+    virtual void computeLead(LeadGeometry& theLead) Standard_OVERRIDE;
 
 protected:
 
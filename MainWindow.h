@@ -6,8 +6,11 @@
 #include <NCollection_UtfString.hxx>
 
 #include "OCCTool/OccWidget.h"
+#include "Label/Label_PMI.h"
 
 class PMIModel;
+class QThread;
+class ModelImporter;
 
 namespace Ui {
 class MainWindow;
@@ -26,6 +29,8 @@ public:
 
 private slots:
     void on_actionImport_triggered();
+    void on_actionOpen_Session_triggered();
+    void on_actionSave_Session_triggered();
     void on_actionAdd_Tolerence_triggered();
     void on_actionAdd_Dimension_triggered();
     void on_actionAdd_Datum_triggered();
@@ -48,6 +53,8 @@ private:
 
     OccWidget *occWidget;
     PMIModel *pmiModel;
+    QThread *importThread;
+    ModelImporter *modelImporter;
 
     bool existPMIDock = false;
     bool existOtherDock = false;
@@ -55,21 +62,16 @@ private:
     bool requestShape;
     bool requestPointOnPlane = false;
 
-    gp_Pnt targetWithBox(const gp_Pnt& input, const gp_Dir& dir, const Bnd_Box& box);
+    void displayModel(const TopoDS_Shape& shape);
 
-    void measureLength(const Bnd_Box& box, const QList<NCollection_Utf8String> &valList,
-                       const TopoDS_Shape &shape1, const TopoDS_Shape &shape2);
-    void measureAngle(const QList<NCollection_Utf8String> &valList,
-                      const TopoDS_Shape &shape1, const TopoDS_Shape &shape2,
-                      const gp_Pnt& touch1, const gp_Pnt& touch2);
-
-    void lengthOfTwoAxis(const Bnd_Box& box, const gp_Ax1& ax1, const gp_Ax1& ax2,
-                            gp_Pnt& first, gp_Pnt& second, gp_Ax2& oriention);
-    gp_Pnt intersectionOfLines(const gp_Lin& lin1, const gp_Lin& lin2);
+    //! Display the built label, or tell the error if it's null
+    void displayLabel(const Handle(Label_PMI)& label, const QString& error);
 
 signals:
     void ShapeSelected(int index, const TopoDS_Shape &shape, const gp_Pnt& touch);
     void PointOnPlaneSelected(const gp_Pnt& pnt, const Handle(AIS_InteractiveContext)& context);
+    //! The model is replaced after importing, the old one is deleted
+    void ModelChanged(const PMIModel* model);
 };
 
 #endif // MAINWINDOW_H
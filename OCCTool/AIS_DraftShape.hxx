@@ -10,6 +10,12 @@ public:
     AIS_DraftShape() {}
     virtual ~AIS_DraftShape() {}
     virtual void SetLocation(const gp_Pnt& pnt) = 0;
+
+    //! Called before a sequence of SetLocation() driven by the mouse
+    virtual void BeginDrag() {}
+
+    //! Called when the mouse drag is finished
+    virtual void EndDrag() {}
 };
 
 DEFINE_STANDARD_HANDLE(AIS_DraftShape, AIS_InteractiveObject)
@@ -29,6 +29,8 @@
 #include <gp_Circ.hxx>
 #include <gp_Torus.hxx>
 #include <gp_Elips.hxx>
+#include <gp_Elips2d.hxx>
+#include <gp_Ax2d.hxx>
 #include <V3d_View.hxx>
 #include <IntCurvesFace_ShapeIntersector.hxx>
 #include <GProp_GProps.hxx>
@@ -49,10 +51,14 @@
 
 #include "math.h"
 #include "pca.h"
+#include "PointMoments.h"
 
 #include <QObject>
 #include <GeomLProp_SLProps.hxx>
 #include <GeomLProp_CLProps.hxx>
+#include <OSD_Parallel.hxx>
+
+#include <algorithm>
 
 #define  GLOG_NO_ABBREVIATED_SEVERITIES
 //#include "glog/logging.h"
@@ -157,7 +163,12 @@ list<gp_Pnt> GeneralTools::getPointsFromEdges(TopoDS_Shape aedge,int Num)
 }
 list<gp_Pnt> GeneralTools::EdgeConvertToPnts(TopoDS_Edge aEdge,bool isF)
 {
-    list<gp_Pnt> rePnts;
+    PointBuffer pts;
+    EdgeConvertToPnts(aEdge,isF,pts);
+    return pts.ToList();
+}
+void GeneralTools::EdgeConvertToPnts(const TopoDS_Edge& aEdge,bool isF,PointBuffer& pts)
+{
     BRepAdaptor_Curve   C;
     C.Initialize(aEdge);
     Standard_Real Lower    = BRepGProp_EdgeTool::FirstParameter  (C);
@@ -185,6 +196,7 @@ list<gp_Pnt> GeneralTools::EdgeConvertToPnts(TopoDS_Edge aEdge,bool isF)
     {
         nbIntervals = 1;
     }
+    pts.Reserve(pts.Size() + nbIntervals * Order);
     Standard_Integer nIndex = 0;
     Standard_Real UU1 = Min(Lower, Upper);
     Standard_Real UU2 = Max(Lower, Upper);
@@ -207,26 +219,20 @@ list<gp_Pnt> GeneralTools::EdgeConvertToPnts(TopoDS_Edge aEdge,bool isF)
         int hafOrder = Order/2;
         if(Order%2 != 0)
             hafOrder +=1;
-        list<gp_Pnt> rePntsNew;
-        for (i = 1; i <= Order; i++)
+        //前一半顺序, 后一半逆序
+        for (i = 1; i <= hafOrder; i++)
         {
             u   = um + ur * GaussP (i);
             BRepGProp_EdgeTool::D1 (C,u, P, V1);
-            if (i<=hafOrder)
-            {
-                rePnts.push_back(P);
-            }
-            else
-            {
-                rePntsNew.push_front(P);
-            }
+            pts.Append(P);
         }
-        for (list<gp_Pnt>::iterator it = rePntsNew.begin();it != rePntsNew.end();it++)
+        for (i = Order; i > hafOrder; i--)
         {
-            rePnts.push_back(*it);
+            u   = um + ur * GaussP (i);
+            BRepGProp_EdgeTool::D1 (C,u, P, V1);
+            pts.Append(P);
         }
     }
-    return rePnts;
 }
 gp_Vec GeneralTools::getNormalByPointOnFace(gp_Pnt P,TopoDS_Face face)
 {
@@ -267,6 +273,13 @@ gp_Vec GeneralTools::getNormalByPointOnFace(gp_Pnt P,TopoDS_Face face)
     return normal;
 }
 void GeneralTools::FaceConvertToPnts(TopoDS_Face aface,list<gp_Pnt> &Pts)
+{
+    PointBuffer pts;
+    FaceConvertToPnts(aface,pts);
+    for(size_t i=0;i<pts.Size();i++)
+        Pts.push_back(pts.Value(i));
+}
+void GeneralTools::FaceConvertToPnts(const TopoDS_Face& aface,PointBuffer& pts)
 {
     BRepGProp_Face theSurface(aface);
     Standard_Real LowerU, UpperU, LowerV, UpperV;
@@ -281,6 +294,7 @@ void GeneralTools::FaceConvertToPnts(TopoDS_Face aface,list<gp_Pnt> &Pts)
     const Standard_Real vm = 0.5 * (UpperV+  LowerV);
     Standard_Real ur = 0.5 * (UpperU-LowerU);
     Standard_Real vr = 0.5 * (UpperV-LowerV);
+    pts.Reserve(pts.Size() + UOrder * VOrder);
     gp_Vec aNormal;
     gp_Pnt aPoint;
     for (Standard_Integer j = 1; j <= VOrder; ++j)
@@ -290,29 +304,33 @@ void GeneralTools::FaceConvertToPnts(TopoDS_Face aface,list<gp_Pnt> &Pts)
         {
             const Standard_Real u = um + ur*GaussPU (i);
             theSurface.Normal(u, v, aPoint, aNormal);
-            Pts.push_back(aPoint);
+            pts.Append(aPoint);
         }
     }
 }
 list<gp_Pnt> GeneralTools::DiscreteShapeToPoints(TopoDS_Shape shape,bool isEdge)
 {
-    list<gp_Pnt> pts;
+    PointBuffer pts;
+    DiscreteShapeToPoints(shape,isEdge,pts);
+    return pts.ToList();
+}
+void GeneralTools::DiscreteShapeToPoints(const TopoDS_Shape& shape,bool isEdge,PointBuffer& pts)
+{
     if(isEdge)
     {
+        PointBuffer ptsedges;
         TopExp_Explorer Ex;
         for(Ex.Init(shape,TopAbs_EDGE);Ex.More();Ex.Next())
         {
-            list<gp_Pnt> ptsedges = EdgeConvertToPnts(TopoDS::Edge(Ex.Current()),false);
-            if(!pts.empty() && !ptsedges.empty())
+            ptsedges.Clear();
+            EdgeConvertToPnts(TopoDS::Edge(Ex.Current()),false,ptsedges);
+            //接在离上一条边终点近的一端
+            bool reversed = false;
+            if(!pts.IsEmpty() && !ptsedges.IsEmpty())
             {
-                if(pts.back().Distance(ptsedges.front()) > pts.back().Distance(ptsedges.back()))
-                {
-                    ptsedges.reverse();
-                }
+                reversed = pts.Last().Distance(ptsedges.First()) > pts.Last().Distance(ptsedges.Last());
             }
-            list<gp_Pnt>::iterator it = pts.begin();
-            advance(it,pts.size());
-            pts.splice(it,ptsedges);
+            pts.Append(ptsedges.Span(),reversed);
         }
     }
     else
@@ -323,7 +341,6 @@ list<gp_Pnt> GeneralTools::DiscreteShapeToPoints(TopoDS_Shape shape,bool isEdge)
             FaceConvertToPnts(TopoDS::Face(ExFace.Current()),pts);
         }
     }
-    return pts;
 }
 void GeneralTools::JudgeVectorByView(gp_Pnt P,Handle(V3d_View) myView,gp_Vec &V)
 {
@@ -382,25 +399,32 @@ bool GeneralTools::GetCicle(Handle(Geom_Curve) aCurve,gp_Circ& cir)
         Standard_Real lastParameter = aCurve->LastParameter();
         int num=100;
         Standard_Real step = (lastParameter - firstParameter)/num;
-        list<gp_Pnt> pts;
+        PointBuffer pts;
+        pts.Reserve(num+1);
         for(int i=0;i<=num;i++)
         {
             gp_Pnt P(0,0,0);
             aCurve->D0(firstParameter+step*i,P);
-            pts.push_back(P);
+            pts.Append(P);
         }
-        return FitCicle(pts,cir);
+        return FitCicle(pts.Span(),cir);
     }
     else
         return false;
 }
 bool GeneralTools::FitCicle(list<gp_Pnt> pts,gp_Circ& cir)
 {
-    if (pts.size() < 3)
+    return FitCicle(PointBuffer(pts).Span(),cir);
+}
+bool GeneralTools::FitCicle(const PointSpan& pts,gp_Circ& cir)
+{
+    if (pts.Size() < 3)
         return false;
     double tot = 0.001;
-    PCA pca(pts);
-    pca.Run();
+    PCA pca;
+    pca.Add(pts.X,pts.Y,pts.Z,pts.Count);
+    if(!pca.Run())
+        return false;
     vector<gp_Vec> aVectors = pca.GetEigenVector();
     gp_Pnt acenter = pca.GetCenterPoint();
     if(aVectors[0].Magnitude ()<=tot || aVectors[1].Magnitude ()<=tot)
@@ -408,10 +432,11 @@ bool GeneralTools::FitCicle(list<gp_Pnt> pts,gp_Circ& cir)
     gp_Vec normalV = aVectors[0].Crossed(aVectors[1]);
     normalV.Normalize();
     gp_Ax2 coordAx(acenter,normalV,aVectors[0]);
-    list<gp_Pnt2d> pts2d = TranslatePntToPnt2d(pts,coordAx);
+    Point2dBuffer pts2d;
+    TranslatePntToPnt2d(pts,coordAx,pts2d);
     gp_Pnt2d Center2d(0,0);
     Standard_Real Radius = 0;
-    if(!FitCicle(pts2d,Center2d,Radius))
+    if(!FitCicle(pts2d.Span(),Center2d,Radius))
     {
         return false;
     }
@@ -422,40 +447,27 @@ bool GeneralTools::FitCicle(list<gp_Pnt> pts,gp_Circ& cir)
 }
 bool GeneralTools::FitCicle(list<gp_Pnt2d> pts2d,gp_Pnt2d &Center, Standard_Real& Radius)
 {
-    if (pts2d.size() < 3)
+    return FitCicle(Point2dBuffer(pts2d).Span(),Center,Radius);
+}
+bool GeneralTools::FitCicle(const Point2dSpan& pts2d,gp_Pnt2d &Center, Standard_Real& Radius)
+{
+    if (pts2d.Size() < 3)
         return false;
-    double X1,X2, X3,Y1,Y2,Y3,X1Y1,X1Y2,X2Y1;
-    X1=X2=X3=Y1=Y2=Y3=X1Y1=X1Y2=X2Y1=0;
-    int i = 0;
-    bool Equalx = false, Equaly = false;
-    for (list<gp_Pnt2d>::iterator it=pts2d.begin();it!=pts2d.end();it++)
-    {
-        X1 = X1 + it->X();
-        Y1 = Y1 + it->Y();
-        if (it->Y() != Y1 / (i + 1))
-        {
-            Equaly = true;
-        }
-        if (it->X() != X1 / (i + 1))
-        {
-            Equalx = true;
-        }
-        X2 = X2 + it->X() * it->X();
-        Y2 = Y2 + it->Y() * it->Y();
-        X3 = X3 + it->X() * it->X() * it->X();
-        Y3 = Y3 + it->Y() * it->Y() *it->Y();
-        X1Y1 = X1Y1 + it->X() * it->Y();
-        X1Y2 = X1Y2 + it->X() * it->Y() * it->Y();
-        X2Y1 = X2Y1 + it->X() * it->X() * it->Y();
-        i++;
-    }
-    if(!Equalx||!Equaly)
+    //以第一点为原点求和, 远离原点的零件也不损失精度
+    PointMoments M(gp_XYZ(pts2d.X[0],pts2d.Y[0],0));
+    M.Add(pts2d);
+    //所有点的x或y相同时无法拟合
+    if(M[PointMoments::XX] <= 0 || M[PointMoments::YY] <= 0)
     {
         return false;
     }
+    const double X1 = M[PointMoments::X], Y1 = M[PointMoments::Y];
+    const double X2 = M[PointMoments::XX], Y2 = M[PointMoments::YY];
+    const double X3 = M[PointMoments::XXX], Y3 = M[PointMoments::YYY];
+    const double X1Y1 = M[PointMoments::XY], X1Y2 = M[PointMoments::XYY], X2Y1 = M[PointMoments::XXY];
     double C, D, E, G, H, N;
     double a, b, c;
-    N = pts2d.size();
+    N = pts2d.Size();
     C = N*X2 - X1*X1;
     D = N*X1Y1 - X1*Y1;
     E = N*X3 + N*X1Y2 - (X2 + Y2)*X1;
@@ -465,7 +477,7 @@ bool GeneralTools::FitCicle(list<gp_Pnt2d> pts2d,gp_Pnt2d &Center, Standard_Real
     b = (H*C - E*D) / (D*D - G*C + 1e-10);
     c = -(a*X1 + b*Y1 + X2 + Y2) / (N + 1e-10);
 
-    Center.SetCoord(a / (-2),b / (-2));
+    Center.SetCoord(a / (-2) + M.Origin().X(),b / (-2) + M.Origin().Y());
     double dTemp = a*a + b*b - 4 * c;
     if (dTemp < 0)
     {
@@ -476,49 +488,23 @@ bool GeneralTools::FitCicle(list<gp_Pnt2d> pts2d,gp_Pnt2d &Center, Standard_Real
 }
 bool GeneralTools::FitSphere(list<gp_Pnt> pts,gp_Sphere& sphere)
 {
-    if (pts.size() < 3)
+    return FitSphere(PointBuffer(pts).Span(),sphere);
+}
+bool GeneralTools::FitSphere(const PointSpan& pts,gp_Sphere& sphere)
+{
+    if (pts.Size() < 3)
     {
         return false;
     }
-    double sum_x = 0.0f, sum_y = 0.0f, sum_z = 0.0f;
-    double sum_x2 = 0.0f, sum_y2 = 0.0f, sum_z2 = 0.0f;
-    double sum_x3 = 0.0f, sum_y3 = 0.0f, sum_z3 = 0.0f;
-    double sum_xy = 0.0f, sum_x1y2 = 0.0f, sum_x2y1 = 0.0f;
-    double sum_xz = 0.0f, sum_x1z2 = 0.0f, sum_x2z1 = 0.0f;
-    double sum_yz = 0.0f, sum_y1z2 = 0.0f, sum_y2z1 = 0.0f;
-    int N = pts.size();
-    for (list<gp_Pnt>::iterator it = pts.begin();it != pts.end();it++)
-    {
-        double x = it->X();
-        double y = it->Y();
-        double z = it->Z();
-        double x2 = x * x;
-        double y2 = y * y;
-        double z2 = z * z;
-        sum_x += x;
-        sum_y += y;
-        sum_z += z;
-
-        sum_x2 += x2;
-        sum_y2 += y2;
-        sum_z2 += z2;
-
-        sum_x3 += x2 * x;
-        sum_y3 += y2 * y;
-        sum_z3 += z2 * z;
-
-        sum_xy += x * y;
-        sum_x1y2 += x * y2;
-        sum_x2y1 += x2 * y;
-
-        sum_xz += x * z;
-        sum_x1z2 += x * z2;
-        sum_x2z1 += x2 * z;
-
-        sum_yz += y * z;
-        sum_y1z2 += y * z2;
-        sum_y2z1 += y2 * z;
-    }
+    PointMoments M(pts.Value(0).XYZ());
+    M.Add(pts);
+    const double sum_x = M[PointMoments::X], sum_y = M[PointMoments::Y], sum_z = M[PointMoments::Z];
+    const double sum_x2 = M[PointMoments::XX], sum_y2 = M[PointMoments::YY], sum_z2 = M[PointMoments::ZZ];
+    const double sum_x3 = M[PointMoments::XXX], sum_y3 = M[PointMoments::YYY], sum_z3 = M[PointMoments::ZZZ];
+    const double sum_xy = M[PointMoments::XY], sum_x1y2 = M[PointMoments::XYY], sum_x2y1 = M[PointMoments::XXY];
+    const double sum_xz = M[PointMoments::XZ], sum_x1z2 = M[PointMoments::XZZ], sum_x2z1 = M[PointMoments::XXZ];
+    const double sum_yz = M[PointMoments::YZ], sum_y1z2 = M[PointMoments::YZZ], sum_y2z1 = M[PointMoments::YYZ];
+    int N = int(pts.Size());
     double C, D, E, P, G, F, H, J, K;
     double a, b, c, d;
     C = N * sum_x2 - sum_x * sum_x;
@@ -557,7 +543,7 @@ bool GeneralTools::FitSphere(list<gp_Pnt> pts,gp_Sphere& sphere)
     }
     d = -(a * sum_x + b * sum_y + c * sum_z + sum_x2 + sum_y2 + sum_z2) / N;
 
-    gp_Pnt centerP(a / (-2),b / (-2),c / (-2));
+    gp_Pnt centerP(gp_XYZ(a / (-2),b / (-2),c / (-2)) + M.Origin());
     gp_Ax2 ax2(centerP,gp::OZ().Direction());
     Standard_Real R = sqrt(a * a + b * b + c * c - 4 * d) / 2;
     gp_Sphere sphere1(ax2,R);
@@ -565,6 +551,99 @@ bool GeneralTools::FitSphere(list<gp_Pnt> pts,gp_Sphere& sphere)
     return true;
 }
 
+bool GeneralTools::FitPlane(const PointSpan& pts,gp_Pln& pln)
+{
+    if (pts.Size() < 3)
+        return false;
+    PCA pca;
+    pca.Add(pts.X,pts.Y,pts.Z,pts.Count);
+    if(!pca.Run())
+        return false;
+    //点共线时平面不确定
+    vector<double> aValues = pca.GetEigenvalue();
+    if(aValues[1] <= Precision::SquareConfusion())
+        return false;
+    vector<gp_Vec> aVectors = pca.GetEigenVector();
+    pln = gp_Pln(pca.GetCenterPoint(),gp_Dir(aVectors[2]));
+    return true;
+}
+bool GeneralTools::FitLine(const PointSpan& pts,gp_Lin& lin)
+{
+    if (pts.Size() < 2)
+        return false;
+    PCA pca;
+    pca.Add(pts.X,pts.Y,pts.Z,pts.Count);
+    if(!pca.Run())
+        return false;
+    vector<double> aValues = pca.GetEigenvalue();
+    if(aValues[0] <= Precision::SquareConfusion())
+        return false;
+    vector<gp_Vec> aVectors = pca.GetEigenVector();
+    lin = gp_Lin(pca.GetCenterPoint(),gp_Dir(aVectors[0]));
+    return true;
+}
+
+//! Fit one point set in each call, a set that fails or throws isn't fitted
+template<typename Shape, typename Input>
+struct FitFunctor
+{
+    typedef bool (*Fit)(const Input&, Shape&);
+
+    FitFunctor(Fit fit, const std::vector<Input>& inputs, Shape* shapes, char* fitted)
+        : myFit(fit), myInputs(inputs), myShapes(shapes), myFitted(fitted) {}
+
+    void operator()(int index) const {
+        try {
+            myFitted[index] = myFit(myInputs[index], myShapes[index]) ? 1 : 0;
+        }
+        catch(const Standard_Failure&) {
+            // such as a direction of null length
+            myFitted[index] = 0;
+        }
+    }
+
+    Fit myFit;
+    const std::vector<Input>& myInputs;
+    Shape* myShapes;
+    char* myFitted;
+};
+
+template<typename Shape, typename Input>
+static void fitAll(bool (*fit)(const Input&, Shape&), const std::vector<Input>& inputs,
+                   std::vector<Shape>& shapes, std::vector<char>& fitted)
+{
+    shapes.assign(inputs.size(), Shape());
+    fitted.assign(inputs.size(), 0);
+    if(inputs.empty())
+        return;
+    OSD_Parallel::For(0, int(inputs.size()), FitFunctor<Shape, Input>(fit, inputs, shapes.data(), fitted.data()));
+}
+
+//! Sample an edge and fit a circle to the points
+static bool fitEdgeCicle(const TopoDS_Edge& edge,gp_Circ& cir)
+{
+    PointBuffer pts;
+    GeneralTools::EdgeConvertToPnts(edge,true,pts);
+    return GeneralTools::FitCicle(pts.Span(),cir);
+}
+
+void GeneralTools::FitCicles(const std::vector<PointSpan>& sets,std::vector<gp_Circ>& circles,std::vector<char>& fitted)
+{
+    fitAll<gp_Circ, PointSpan>(&GeneralTools::FitCicle,sets,circles,fitted);
+}
+void GeneralTools::FitCicles(const std::vector<TopoDS_Edge>& edges,std::vector<gp_Circ>& circles,std::vector<char>& fitted)
+{
+    fitAll<gp_Circ, TopoDS_Edge>(&fitEdgeCicle,edges,circles,fitted);
+}
+void GeneralTools::FitSpheres(const std::vector<PointSpan>& sets,std::vector<gp_Sphere>& spheres,std::vector<char>& fitted)
+{
+    fitAll<gp_Sphere, PointSpan>(&GeneralTools::FitSphere,sets,spheres,fitted);
+}
+void GeneralTools::FitPlanes(const std::vector<PointSpan>& sets,std::vector<gp_Pln>& planes,std::vector<char>& fitted)
+{
+    fitAll<gp_Pln, PointSpan>(&GeneralTools::FitPlane,sets,planes,fitted);
+}
+
 gp_Pnt GeneralTools::getViewPointForm3DPoint(gp_Pnt P,Handle(V3d_View) myView)
 {
     Standard_Real x,y,z;
@@ -867,10 +946,64 @@ void GeneralTools::TrsfPointByCoordinate(gp_Ax2 axA,gp_Ax2 axB,gp_Pnt &P)
 }
 
 bool GeneralTools::FitEllips(list<gp_Pnt> pts,gp_Elips& aElips)
+{
+    return FitEllips(PointBuffer(pts).Span(),aElips);
+}
+//! The real roots of x^3 + a x^2 + b x + c, there are 1 or 3 of them
+static int cubicRoots(double a, double b, double c, double roots[3])
+{
+    const double q = (a*a - 3*b) / 9;
+    const double r = (2*a*a*a - 9*a*b + 27*c) / 54;
+    const double q3 = q*q*q;
+    if(r*r < q3)
+    {
+        const double t = acos(std::max(-1.0, std::min(1.0, r / sqrt(q3))));
+        const double s = -2 * sqrt(q);
+        roots[0] = s * cos(t / 3) - a / 3;
+        roots[1] = s * cos((t + 2*M_PI) / 3) - a / 3;
+        roots[2] = s * cos((t - 2*M_PI) / 3) - a / 3;
+        return 3;
+    }
+    double u = -cbrt(fabs(r) + sqrt(r*r - q3));
+    if(r < 0)
+        u = -u;
+    roots[0] = (u != 0 ? u + q / u : 0) - a / 3;
+    return 1;
+}
+
+//! Invert the 3x3 matrix m by its cofactors, false if it's singular
+static bool invert3(const double m[3][3], double inv[3][3])
+{
+    double c[3][3];
+    c[0][0] = m[1][1]*m[2][2] - m[1][2]*m[2][1];
+    c[0][1] = m[0][2]*m[2][1] - m[0][1]*m[2][2];
+    c[0][2] = m[0][1]*m[1][2] - m[0][2]*m[1][1];
+    c[1][0] = m[1][2]*m[2][0] - m[1][0]*m[2][2];
+    c[1][1] = m[0][0]*m[2][2] - m[0][2]*m[2][0];
+    c[1][2] = m[0][2]*m[1][0] - m[0][0]*m[1][2];
+    c[2][0] = m[1][0]*m[2][1] - m[1][1]*m[2][0];
+    c[2][1] = m[0][1]*m[2][0] - m[0][0]*m[2][1];
+    c[2][2] = m[0][0]*m[1][1] - m[0][1]*m[1][0];
+    const double det = m[0][0]*c[0][0] + m[0][1]*c[1][0] + m[0][2]*c[2][0];
+    double norm = 0;
+    for(int i=0;i<3;i++)
+        for(int j=0;j<3;j++)
+            norm = std::max(norm, fabs(m[i][j]));
+    if(fabs(det) <= 1e-12 * norm*norm*norm)
+        return false;
+    for(int i=0;i<3;i++)
+        for(int j=0;j<3;j++)
+            inv[i][j] = c[i][j] / det;
+    return true;
+}
+
+bool GeneralTools::FitEllips(const PointSpan& pts,gp_Elips& aElips)
 {
     double tot = 0.001;
-    PCA pca(pts);
-    pca.Run();
+    PCA pca;
+    pca.Add(pts.X,pts.Y,pts.Z,pts.Count);
+    if(!pca.Run())
+        return false;
     vector<gp_Vec> aVectors = pca.GetEigenVector();
     gp_Pnt acenter = pca.GetCenterPoint();
     if(aVectors.size() < 2)
@@ -881,138 +1014,138 @@ bool GeneralTools::FitEllips(list<gp_Pnt> pts,gp_Elips& aElips)
     gp_Vec normalV = aVectors[0].Crossed(aVectors[1]);
     normalV.Normalize();
     gp_Ax2 coordAx(acenter,normalV,aVectors[0]);
-    list<gp_Pnt2d> pts2d = TranslatePntToPnt2d(pts,coordAx);
+    Point2dBuffer pts2d;
+    TranslatePntToPnt2d(pts,coordAx,pts2d);
 
-    long double A = 0.00,B = 0.00,C = 0.00,D = 0.00,E = 0.00;
-    long double x2y2=0.0,x1y3=0.0,x2y1=0.0,x1y2=0.0,x1y1=0.0,yyy4=0.0,yyy3=0.0,yyy2=0.0,xxx2=0.0,xxx1=0.0,yyy1=0.0,x3y1=0.0,xxx3=0.0;
-    long double N = pts2d.size();
-    for(list<gp_Pnt2d>::iterator it=pts2d.begin();it!=pts2d.end();it++)
-    {
-        long double xi = it->X(), yi = it->Y();
-
-        x2y2 += xi*xi*yi*yi;
-        x1y3 += xi*yi*yi*yi;
-        x2y1 += xi*xi*yi;
-        x1y2 += xi*yi*yi;
-        x1y1 += xi*yi;
-        yyy4 += yi*yi*yi*yi;
-        yyy3 += yi*yi*yi;
-        yyy2 += yi*yi;
-        xxx2 += xi*xi;
-        xxx1 += xi;
-        yyy1 += yi;
-        x3y1 += xi*xi*xi*yi;
-        xxx3 += xi*xi*xi;
-    }
-    long double matrix[5][5]={{x2y2,x1y3,x2y1,x1y2,x1y1},
-                              {x1y3,yyy4,x1y2,yyy3,yyy2},
-                              {x2y1,x1y2,xxx2,x1y1,xxx1},
-                              {x1y2,yyy3,x1y1,yyy2,yyy1},
-                              {x1y1,yyy2,xxx1,yyy1,N}
-                             };
-
-    long double matrix2[5][1]={x3y1,x2y2,xxx3,x2y1,xxx2};
-    long double matrix3[5][1] = {A,B,C,D,E};
-
-    ////求矩阵matrix的逆，结果为InverseMatrix
-    ///单位矩阵
-    int n = 5;
-    long double E_Matrix[5][5];
-    long double mik;
-    long double m = 2*n;
-    for(int i = 0; i < n; i++)
-    {
-        for(int j = 0; j < n; j++)
-        {
-            if(i == j)
-                E_Matrix[i][j] = 1.00;
-            else
-                E_Matrix[i][j] = 0.00;
-        }
-    }
-    long double CalcuMatrix[5][2*5];
-    for(int i = 0; i < n; i++)
-    {
-        for(int j = 0; j < n; j++)
-        {
-            CalcuMatrix[i][j] = matrix[i][j];
-        }
-        for(int k = n; k < m; k++)
-        {
-            CalcuMatrix[i][k] = E_Matrix[i][k-n];
-        }
-    }
+    gp_Elips2d aElips2d;
+    if(!FitEllips(pts2d.Span(),aElips2d))
+        return false;
+    //二维的长轴方向在平面上的方向
+    const gp_Dir2d xDir2d = aElips2d.XAxis().Direction();
+    const gp_Dir xDir(coordAx.XDirection().XYZ()*xDir2d.X() + coordAx.YDirection().XYZ()*xDir2d.Y());
+    gp_Pnt centerP = TranslatePnt2dToPnt(aElips2d.Location(),coordAx);
+    aElips = gp_Elips(gp_Ax2(centerP,coordAx.Direction(),xDir),aElips2d.MajorRadius(),aElips2d.MinorRadius());
+    return true;
+}
+bool GeneralTools::FitEllips(const Point2dSpan& pts2d,gp_Elips2d& aElips)
+{//Fitzgibbon直接最小二乘, 按Halir和Flusser的方法拆成3x3的矩阵求解
+    const size_t N = pts2d.Size();
+    if(N < 5)
+        return false;
+    //平移缩放到单位尺度, 方程组的条件数与零件的大小和位置无关
+    double mx = 0, my = 0;
+    for(size_t i=0;i<N;i++)
+    {
+        mx += pts2d.X[i];
+        my += pts2d.Y[i];
+    }
+    mx /= N;
+    my /= N;
+    double s2 = 0;
+    for(size_t i=0;i<N;i++)
+        s2 += (pts2d.X[i]-mx)*(pts2d.X[i]-mx) + (pts2d.Y[i]-my)*(pts2d.Y[i]-my);
+    const double scale = sqrt(s2 / N);
+    if(scale <= Precision::Confusion())
+        return false;
 
-    for(int i = 1; i <= n-1; i++)
-    {
-        for(int j = i+1; j <= n; j++)
+    //散布矩阵S1 = D1'D1, S2 = D1'D2, S3 = D2'D2, 其中D1 = [x² xy y²], D2 = [x y 1]
+    double S1[3][3] = {{0}}, S2[3][3] = {{0}}, S3[3][3] = {{0}};
+    for(size_t i=0;i<N;i++)
+    {
+        const double x = (pts2d.X[i]-mx) / scale, y = (pts2d.Y[i]-my) / scale;
+        const double d1[3] = {x*x, x*y, y*y};
+        const double d2[3] = {x, y, 1};
+        for(int j=0;j<3;j++)
         {
-            mik = CalcuMatrix[j-1][i-1]/CalcuMatrix[i-1][i-1];
-            for(int k = i+1;k <= m; k++)
+            for(int k=0;k<3;k++)
             {
-                CalcuMatrix[j-1][k-1] -= mik*CalcuMatrix[i-1][k-1];
+                S1[j][k] += d1[j]*d1[k];
+                S2[j][k] += d1[j]*d2[k];
+                S3[j][k] += d2[j]*d2[k];
             }
         }
     }
-    for(int i=1;i<=n;i++)
-    {
-        long double temp = CalcuMatrix[i-1][i-1];
-        for(int j=1;j<=m;j++)
-        {
-            CalcuMatrix[i-1][j-1] = CalcuMatrix[i-1][j-1]/temp;
-        }
-    }
-    for(int k=n-1;k>=1;k--)
-    {
-        for(int i=k;i>=1;i--)
-        {
-            mik = CalcuMatrix[i-1][k];
-            for(int j=k+1;j<=m;j++)
-            {
-                CalcuMatrix[i-1][j-1] -= mik*CalcuMatrix[k][j-1];
-            }
-        }
-    }
-    long double InverseMatrix[5][5];
-    for(int i=0;i<n;i++)
-    {
-        for(int j=0;j<n;j++)
-        {
-            InverseMatrix[i][j] = CalcuMatrix[i][j+n];
-        }
-    }
-    for(int i=0;i<5;i++)
-    {
-        for(int j=0;j<5;j++)
-        {
-            if(fabs(InverseMatrix[i][j]) < 0.0000001)
-                InverseMatrix[i][j] = 0.00;
-        }
+    //点共线时S3奇异
+    double S3inv[3][3];
+    if(!invert3(S3,S3inv))
+        return false;
+    //一次项系数 a2 = T a1, T = -S3^-1 S2'
+    double T[3][3];
+    for(int i=0;i<3;i++)
+        for(int j=0;j<3;j++)
+            T[i][j] = -(S3inv[i][0]*S2[j][0] + S3inv[i][1]*S2[j][1] + S3inv[i][2]*S2[j][2]);
+    //约束4AC-B²=1的逆乘以(S1 + S2 T)
+    double M[3][3];
+    for(int i=0;i<3;i++)
+        for(int j=0;j<3;j++)
+            M[i][j] = S1[i][j] + S2[i][0]*T[0][j] + S2[i][1]*T[1][j] + S2[i][2]*T[2][j];
+    double R[3][3];
+    for(int j=0;j<3;j++)
+    {
+        R[0][j] = M[2][j] / 2;
+        R[1][j] = -M[1][j];
+        R[2][j] = M[0][j] / 2;
     }
-    ///求参数A,B,C,D,E
-    for(int i=0;i<5;i++)
-    {
-        for(int j=0;j<5;j++)
+
+    //特征向量中满足4AC-B²>0的是椭圆
+    const double tr = R[0][0] + R[1][1] + R[2][2];
+    const double minors = R[0][0]*R[1][1] - R[0][1]*R[1][0] + R[0][0]*R[2][2] - R[0][2]*R[2][0]
+            + R[1][1]*R[2][2] - R[1][2]*R[2][1];
+    const double det = R[0][0]*(R[1][1]*R[2][2] - R[1][2]*R[2][1])
+            - R[0][1]*(R[1][0]*R[2][2] - R[1][2]*R[2][0])
+            + R[0][2]*(R[1][0]*R[2][1] - R[1][1]*R[2][0]);
+    double roots[3];
+    const int nbRoots = cubicRoots(-tr, minors, -det, roots);
+    double a1[3] = {0, 0, 0};
+    double bestCond = 0;
+    for(int r=0;r<nbRoots;r++)
+    {
+        //(R - λI)的两行叉乘得到零空间, 取最长的一个
+        gp_XYZ rows[3];
+        for(int i=0;i<3;i++)
+            rows[i].SetCoord(R[i][0], R[i][1], R[i][2]);
+        for(int i=0;i<3;i++)
+            rows[i].SetCoord(i+1, rows[i].Coord(i+1) - roots[r]);
+        gp_XYZ v = rows[0].Crossed(rows[1]);
+        const gp_XYZ v2 = rows[0].Crossed(rows[2]), v3 = rows[1].Crossed(rows[2]);
+        if(v2.SquareModulus() > v.SquareModulus())
+            v = v2;
+        if(v3.SquareModulus() > v.SquareModulus())
+            v = v3;
+        const double len2 = v.SquareModulus();
+        if(len2 <= 0)
+            continue;
+        const double cond = (4*v.X()*v.Z() - v.Y()*v.Y()) / len2;
+        if(cond > bestCond)
         {
-            matrix3[i][0] += InverseMatrix[i][j]*(-matrix2[j][0]);
+            bestCond = cond;
+            a1[0] = v.X(); a1[1] = v.Y(); a1[2] = v.Z();
         }
     }
-    A = matrix3[0][0];
-    B = matrix3[1][0];
-    C = matrix3[2][0];
-    D = matrix3[3][0];
-    E = matrix3[4][0];
-    ///求拟合结果重要参数
-    double Xc = (2*B*C-A*D)/(A*A-4*B);
-    double Yc = (2*D-A*D)/(A*A-4*B);
-    double a = sqrt(fabs(2*(A*C*D-B*C*C-D*D+4*B*E-A*A*E)/((A*A-4*B)*(B-sqrt(A*A+(1-B)*(1-B))+1))));
-    double b = sqrt(fabs(2*(A*C*D-B*C*C-D*D+4*B*E-A*A*E)/((A*A-4*B)*(B+sqrt(A*A+(1-B)*(1-B))+1))));
-    double theta = atan2(a*a-b*b*B,a*a*B-b*b);
-    gp_Pnt centerP = TranslatePnt2dToPnt(gp_Pnt2d(Xc,Yc),coordAx);
-    coordAx.Translate(acenter,centerP);
-    gp_Ax2 otherAx = coordAx.Rotated(coordAx.Axis(),theta);
-    gp_Elips aElips1(otherAx,a>b?a:b,a>b?b:a);
-    aElips = aElips1;
+    if(bestCond <= 0)
+        return false;
+    double a2[3];
+    for(int i=0;i<3;i++)
+        a2[i] = T[i][0]*a1[0] + T[i][1]*a1[1] + T[i][2]*a1[2];
+
+    //Ax² + Bxy + Cy² + Dx + Ey + F = 0 的中心、轴向和半轴
+    const double A = a1[0], B = a1[1], C = a1[2], D = a2[0], E = a2[1], F = a2[2];
+    const double den = 4*A*C - B*B;
+    const double x0 = (B*E - 2*C*D) / den;
+    const double y0 = (B*D - 2*A*E) / den;
+    const double F0 = F + (D*x0 + E*y0) / 2;
+    const double theta = atan2(B, A - C) / 2;
+    const double c = cos(theta), s = sin(theta);
+    const double l1 = A*c*c + B*c*s + C*s*s;
+    const double l2 = A*s*s - B*c*s + C*c*c;
+    if(-F0/l1 <= 0 || -F0/l2 <= 0)
+        return false;
+    const double r1 = sqrt(-F0/l1) * scale, r2 = sqrt(-F0/l2) * scale;
+    const gp_Pnt2d center(x0*scale + mx, y0*scale + my);
+    if(r1 >= r2)
+        aElips = gp_Elips2d(gp_Ax2d(center,gp_Dir2d(c,s)),r1,r2);
+    else
+        aElips = gp_Elips2d(gp_Ax2d(center,gp_Dir2d(-s,c)),r2,r1);
     return true;
 }
 /// <summary>
@@ -1020,42 +1153,25 @@ bool GeneralTools::FitEllips(list<gp_Pnt> pts,gp_Elips& aElips)
 /// </summary>
 list<gp_Pnt2d> GeneralTools::TranslatePntToPnt2d(list<gp_Pnt> points,gp_Ax2 coordAx)
 {
-    list<gp_Pnt2d> points2d;
-    //int count = points.size();
-    //points2d.reserve(count);
-    math_Matrix matrix(0,3,0,3);  //变换矩阵
-    matrix(0,0) = coordAx.XDirection().X();
-    matrix(0,1) = coordAx.YDirection().X();
-    matrix(0,2) = coordAx.Direction().X();
-    matrix(0,3) = coordAx.Location().X();
-    matrix(1,0) = coordAx.XDirection().Y();
-    matrix(1,1) = coordAx.YDirection().Y();
-    matrix(1,2) = coordAx.Direction().Y();
-    matrix(1,3) = coordAx.Location().Y();
-    matrix(2,0) = coordAx.XDirection().Z();
-    matrix(2,1) = coordAx.YDirection().Z();
-    matrix(2,2) = coordAx.Direction().Z();
-    matrix(2,3) = coordAx.Location().Z();
-    matrix(3,0) = 0;
-    matrix(3,1) = 0;
-    matrix(3,2) = 0;
-    matrix(3,3) = 1;
-
-    math_Matrix matrixInv(0,3,0,3);
-    matrixInv = matrix.Inverse();
-    for (list<gp_Pnt>::iterator it=points.begin();it != points.end();it++)
+    Point2dBuffer points2d;
+    TranslatePntToPnt2d(PointBuffer(points).Span(),coordAx,points2d);
+    return points2d.ToList();
+}
+/// <summary>
+/// 将3维点转化为2维点, 追加到points2d
+/// </summary>
+void GeneralTools::TranslatePntToPnt2d(const PointSpan& points,const gp_Ax2& coordAx,Point2dBuffer& points2d)
+{
+    //坐标系是正交的, 逆变换即在X、Y方向上的投影
+    const gp_XYZ O = coordAx.Location().XYZ();
+    const gp_XYZ VX = coordAx.XDirection().XYZ();
+    const gp_XYZ VY = coordAx.YDirection().XYZ();
+    points2d.Reserve(points2d.Size() + points.Count);
+    for (size_t i=0;i<points.Count;i++)
     {
-        math_Matrix matrixP(0,3,0,0);
-        matrixP(0,0) = it->X();
-        matrixP(1,0) = it->Y();
-        matrixP(2,0) = it->Z();
-        matrixP(3,0) = 1;
-        math_Matrix matrixP2(0,3,0,0);
-        matrixP2 = matrixInv * matrixP;
-        gp_Pnt2d P2d(matrixP2(0,0),matrixP2(1,0));
-        points2d.push_back(P2d);
+        const double dx = points.X[i]-O.X(), dy = points.Y[i]-O.Y(), dz = points.Z[i]-O.Z();
+        points2d.Append(dx*VX.X()+dy*VX.Y()+dz*VX.Z(), dx*VY.X()+dy*VY.Y()+dz*VY.Z());
     }
-    return points2d;
 }
 /// <summary>
 /// 将2维点转化为3维点
@@ -1417,13 +1533,14 @@ bool GeneralTools::GetEllips(Handle(Geom_Curve) anEdgeCurve,gp_Elips& aElips)
     {
         Standard_Real FirstDummy = anEdgeCurve->FirstParameter();
         Standard_Real LastDummy = anEdgeCurve->LastParameter();
-        list<gp_Pnt> pts;
+        PointBuffer pts;
+        pts.Reserve(100);
         for (int i=0;i<100;i++)
         {
             Standard_Real Upara = FirstDummy + (LastDummy - FirstDummy) / 99 * i;
-            pts.push_back(anEdgeCurve->Value(Upara));
+            pts.Append(anEdgeCurve->Value(Upara));
         }
-        if(FitEllips(pts,aElips))
+        if(FitEllips(pts.Span(),aElips))
         {
             return true;
         }
@@ -1546,3 +1663,62 @@ bool GeneralTools::GetShapeNormal(const TopoDS_Shape &shape, const gp_Pnt &p, gp
     }
     return false;
 }
+
+// slab test in the frame of box, o/d are the ray origin and direction, [lo,hi] is the box
+static bool IntersectSlabs(const double o[3], const double d[3], const double lo[3], const double hi[3],
+                           Standard_Real& tmin, Standard_Real& tmax)
+{
+    tmin = -RealLast();
+    tmax = RealLast();
+    for(int i=0;i<3;++i)
+    {
+        if(Abs(d[i]) < gp::Resolution())
+        {
+            // parallel to the slab, the origin must be between the planes
+            if(o[i] < lo[i] || o[i] > hi[i])
+                return false;
+            continue;
+        }
+
+        Standard_Real t1 = (lo[i] - o[i]) / d[i];
+        Standard_Real t2 = (hi[i] - o[i]) / d[i];
+        if(t1 > t2)
+            std::swap(t1, t2);
+        tmin = Max(tmin, t1);
+        tmax = Min(tmax, t2);
+        if(tmin > tmax)
+            return false;
+    }
+    return true;
+}
+
+bool GeneralTools::IntersectRayBox(const gp_Lin &ray, const Bnd_Box &box, Standard_Real &tmin, Standard_Real &tmax)
+{
+    if(box.IsVoid())
+        return false;
+
+    double lo[3], hi[3];
+    box.Get(lo[0],lo[1],lo[2],hi[0],hi[1],hi[2]);
+    const double o[3] = { ray.Location().X(), ray.Location().Y(), ray.Location().Z() };
+    const double d[3] = { ray.Direction().X(), ray.Direction().Y(), ray.Direction().Z() };
+    return IntersectSlabs(o, d, lo, hi, tmin, tmax);
+}
+
+bool GeneralTools::IntersectRayBox(const gp_Lin &ray, const Bnd_OBB &box, Standard_Real &tmin, Standard_Real &tmax)
+{
+    if(box.IsVoid())
+        return false;
+
+    // express the ray in the axes of box
+    const gp_XYZ axes[3] = { box.XDirection(), box.YDirection(), box.ZDirection() };
+    const double hi[3] = { box.XHSize(), box.YHSize(), box.ZHSize() };
+    const double lo[3] = { -hi[0], -hi[1], -hi[2] };
+    const gp_XYZ pos = ray.Location().XYZ() - box.Center();
+    double o[3], d[3];
+    for(int i=0;i<3;++i)
+    {
+        o[i] = pos.Dot(axes[i]);
+        d[i] = ray.Direction().XYZ().Dot(axes[i]);
+    }
+    return IntersectSlabs(o, d, lo, hi, tmin, tmax);
+}
@@ -13,10 +13,19 @@
 #include <gp_Cylinder.hxx>
 #include <gp_Sphere.hxx>
 #include <gp_Cone.hxx>
+#include <gp_Pln.hxx>
+#include <gp_Lin.hxx>
+#include <gp_Elips.hxx>
+#include <gp_Elips2d.hxx>
+#include <TopoDS_Edge.hxx>
+#include <Bnd_Box.hxx>
+#include <Bnd_OBB.hxx>
 
 #include <list>
 #include <map>
 #include <vector>
+
+#include "PointBuffer.h"
 using namespace std;
 class GeneralTools
 {
@@ -47,6 +56,32 @@ public:
     static bool FitCicle(list<gp_Pnt> pts,gp_Circ& cir);
     static bool FitSphere(list<gp_Pnt> pts,gp_Sphere& sphere);
 
+    //! The overloads on PointBuffer append to the buffer or read a span of it
+    //! without copying, the ones on list copy the points into a buffer
+    static void EdgeConvertToPnts(const TopoDS_Edge& aEdge,bool isF,PointBuffer& pts);
+    static void FaceConvertToPnts(const TopoDS_Face& aface,PointBuffer& pts);
+    static void DiscreteShapeToPoints(const TopoDS_Shape& shape,bool isEdge,PointBuffer& pts);
+    static void TranslatePntToPnt2d(const PointSpan& points,const gp_Ax2& coordAx,Point2dBuffer& points2d);
+    static bool FitEllips(const PointSpan& pts,gp_Elips& aElips);
+    //! Direct least squares fit of an ellipse (Fitzgibbon), false if the
+    //! points are nearer to another conic
+    static bool FitEllips(const Point2dSpan& pts2d,gp_Elips2d& aElips);
+    static bool FitCicle(const Point2dSpan& pts2d,gp_Pnt2d &Center, Standard_Real& Radius);
+    static bool FitCicle(const PointSpan& pts,gp_Circ& cir);
+    static bool FitSphere(const PointSpan& pts,gp_Sphere& sphere);
+    //! The plane through the mean with the direction of least variance as normal
+    static bool FitPlane(const PointSpan& pts,gp_Pln& pln);
+    //! The line through the mean along the direction of most variance
+    static bool FitLine(const PointSpan& pts,gp_Lin& lin);
+
+    //! Fit every set on all the cores, fitted[i] is 1 if the set i is fitted.
+    //! The spans must stay valid until the call returns
+    static void FitCicles(const vector<PointSpan>& sets,vector<gp_Circ>& circles,vector<char>& fitted);
+    //! Sample every edge and fit a circle to it on all the cores
+    static void FitCicles(const vector<TopoDS_Edge>& edges,vector<gp_Circ>& circles,vector<char>& fitted);
+    static void FitSpheres(const vector<PointSpan>& sets,vector<gp_Sphere>& spheres,vector<char>& fitted);
+    static void FitPlanes(const vector<PointSpan>& sets,vector<gp_Pln>& planes,vector<char>& fitted);
+
 
     static bool CompareCylinder(gp_Cylinder cylind1,gp_Cylinder cylind2);
     static list<gp_Pnt> DiscreteShapeToPoints(TopoDS_Shape shape,bool isEdge);
@@ -70,4 +105,9 @@ public:
     static bool GetAxis(const Handle(Geom_Surface)& aSurface, gp_Ax1& ax);
     static bool GetCenter(const Handle(Geom_Curve)& aCurve, gp_Ax2& ax2);
     static bool GetShapeNormal(const TopoDS_Shape& shape, const gp_Pnt& p, gp_Dir& normal);
+
+    //! slab test of ray and box, return false if the ray misses the box,
+    //! otherwise [tmin,tmax] is the parameter range of ray inside the box, tmin may be negative
+    static bool IntersectRayBox(const gp_Lin& ray, const Bnd_Box& box, Standard_Real& tmin, Standard_Real& tmax);
+    static bool IntersectRayBox(const gp_Lin& ray, const Bnd_OBB& box, Standard_Real& tmin, Standard_Real& tmax);
 };
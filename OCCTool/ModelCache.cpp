@@ -0,0 +1,267 @@
+#include "ModelCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <BinTools.hxx>
+#include <Standard_Failure.hxx>
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+// header of the cache file, followed by the BinTools data
+static const char CACHE_MAGIC[8] = { 'P','M','I','C','A','C','H','E' };
+static const quint32 CACHE_VERSION = 1;
+static const int CACHE_HEADER_SIZE = sizeof(CACHE_MAGIC) + sizeof(CACHE_VERSION);
+// the entries are trimmed to this size, the least recently used first
+static const qint64 CACHE_MAX_SIZE = qint64(4) * 1024 * 1024 * 1024;
+
+//! Read only stream buffer over a block of memory, such as a mapped file
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+    MemoryStreamBuf(const char* data, size_t size)
+    {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+
+protected:
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+    {
+        if(!(which & std::ios_base::in))
+            return pos_type(off_type(-1));
+
+        char* target = nullptr;
+        if(dir == std::ios_base::beg)
+            target = eback() + off;
+        else if(dir == std::ios_base::cur)
+            target = gptr() + off;
+        else
+            target = egptr() + off;
+
+        if(target < eback() || target > egptr())
+            return pos_type(off_type(-1));
+
+        setg(eback(), target, egptr());
+        return pos_type(target - eback());
+    }
+
+    virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+    {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+//! Write only stream buffer over a device, the data goes to the device
+//! through a small buffer instead of being kept in memory
+class DeviceStreamBuf : public std::streambuf
+{
+public:
+    explicit DeviceStreamBuf(QIODevice* device)
+        : myDevice(device),
+          myBuffer(1024 * 1024),
+          myWritten(0)
+    {
+        setp(myBuffer.data(), myBuffer.data() + myBuffer.size());
+    }
+
+protected:
+    virtual int_type overflow(int_type ch) override
+    {
+        if(!flushBuffer())
+            return traits_type::eof();
+        if(!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    virtual int sync() override
+    {
+        return flushBuffer() ? 0 : -1;
+    }
+
+    // only tellp() is supported, the data is written in order
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+    {
+        if(off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out))
+            return pos_type(off_type(-1));
+        return pos_type(myWritten + (pptr() - pbase()));
+    }
+
+private:
+    bool flushBuffer()
+    {
+        const qint64 count = pptr() - pbase();
+        if(count > 0 && myDevice->write(pbase(), count) != count)
+            return false;
+        myWritten += count;
+        setp(myBuffer.data(), myBuffer.data() + myBuffer.size());
+        return true;
+    }
+
+    QIODevice* myDevice;
+    std::vector<char> myBuffer;
+    qint64 myWritten;
+};
+
+ModelCache::ModelCache(const QString &dir)
+    : myDir(dir),
+      myMaxSize(CACHE_MAX_SIZE)
+{
+    if(myDir.isEmpty())
+        myDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/models";
+}
+
+QByteArray ModelCache::FileKey(const QString &fileName)
+{
+    QFileInfo info(fileName);
+    QFile file(fileName);
+    if(!info.exists() || !file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash content(QCryptographicHash::Sha1);
+    uchar* data = file.map(0, file.size());
+    if(data) {
+        // feed the hash in chunks, addData() takes an int length
+        const qint64 chunk = 64 * 1024 * 1024;
+        for(qint64 pos = 0; pos < file.size(); pos += chunk)
+            content.addData(reinterpret_cast<const char*>(data) + pos, int(qMin(chunk, file.size() - pos)));
+        file.unmap(data);
+    }
+    else if(!content.addData(&file)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash key(QCryptographicHash::Sha1);
+    key.addData(info.absoluteFilePath().toUtf8());
+    key.addData(QByteArray::number(info.size()));
+    key.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    key.addData(content.result());
+
+    // the entries of a path share the prefix, so an old entry can be found
+    // and dropped when the file changes
+    const QByteArray path = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+    return path.toHex().left(16) + "-" + key.result().toHex();
+}
+
+bool ModelCache::Load(const QByteArray &key, TopoDS_Shape &shape) const
+{
+    if(key.isEmpty())
+        return false;
+
+    QFile file(cacheFile(key));
+    if(!file.open(QIODevice::ReadOnly) || file.size() <= CACHE_HEADER_SIZE)
+        return false;
+
+    // read the file through a memory map if possible
+    QByteArray buffer;
+    const char* data = reinterpret_cast<const char*>(file.map(0, file.size()));
+    qint64 size = file.size();
+    if(!data) {
+        buffer = file.readAll();
+        data = buffer.constData();
+        size = buffer.size();
+    }
+
+    quint32 version = 0;
+    memcpy(&version, data + sizeof(CACHE_MAGIC), sizeof(version));
+    if(memcmp(data, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || version != CACHE_VERSION)
+        return false;
+
+    MemoryStreamBuf streamBuf(data + CACHE_HEADER_SIZE, size_t(size - CACHE_HEADER_SIZE));
+    std::istream stream(&streamBuf);
+    try {
+        TopoDS_Shape aShape;
+        BinTools::Read(aShape, stream);
+        if(aShape.IsNull())
+            return false;
+        shape = aShape;
+    }
+    catch(const Standard_Failure&) {
+        return false;
+    }
+
+    // mark the entry as used, the least recently used ones are trimmed first
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+bool ModelCache::Store(const QByteArray &key, const TopoDS_Shape &shape) const
+{
+    if(key.isEmpty() || shape.IsNull() || !QDir().mkpath(myDir))
+        return false;
+
+    // write to a temporary file first, a half written entry is never seen
+    QSaveFile file(cacheFile(key));
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+
+    // the shape is streamed into the file, not built up in memory first
+    DeviceStreamBuf streamBuf(&file);
+    std::ostream stream(&streamBuf);
+    try {
+        BinTools::Write(shape, stream);
+    }
+    catch(const Standard_Failure&) {
+        file.cancelWriting();
+        return false;
+    }
+    stream.flush();
+    if(!stream || !file.commit())
+        return false;
+
+    removeStale(key);
+    trim();
+    return true;
+}
+
+void ModelCache::removeStale(const QByteArray &key) const
+{
+    const int dash = key.indexOf('-');
+    if(dash <= 0)
+        return;
+
+    QDir dir(myDir);
+    const QString pattern = QString::fromLatin1(key.left(dash + 1)) + "*.bin";
+    const QString current = QFileInfo(cacheFile(key)).fileName();
+    const QStringList names = dir.entryList(QStringList() << pattern, QDir::Files);
+    for(int i=0;i<names.size();++i) {
+        if(names[i] != current)
+            dir.remove(names[i]);
+    }
+}
+
+void ModelCache::trim() const
+{
+    if(myMaxSize <= 0)
+        return;
+
+    // the most recently used first
+    QDir dir(myDir);
+    const QFileInfoList entries = dir.entryInfoList(QStringList() << "*.bin", QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for(int i=0;i<entries.size();++i) {
+        total += entries[i].size();
+        if(total > myMaxSize)
+            dir.remove(entries[i].fileName());
+    }
+}
+
+QString ModelCache::cacheFile(const QByteArray &key) const
+{
+    return myDir + "/" + QString::fromLatin1(key) + ".bin";
+}
@@ -0,0 +1,49 @@
+#ifndef MODELCACHE_H
+#define MODELCACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <TopoDS_Shape.hxx>
+
+//! Binary cache of imported models.
+//! Each entry holds the transferred shape with its triangulation in
+//! OCCT binary format, it's keyed by the path, size, modification time
+//! and content hash of the source file. A path keeps only its latest
+//! entry, and the directory is trimmed to its size limit after a store.
+class ModelCache
+{
+public:
+    //! Use the given directory, or the application cache location if empty
+    explicit ModelCache(const QString& dir = QString());
+
+    //! Return the key of source file, empty if the file can't be read
+    static QByteArray FileKey(const QString& fileName);
+
+    //! Load the shape of key, return false if there is no valid entry
+    bool Load(const QByteArray& key, TopoDS_Shape& shape) const;
+
+    //! Store the shape and its triangulation under the key, the older
+    //! entries of the same source path are removed
+    bool Store(const QByteArray& key, const TopoDS_Shape& shape) const;
+
+    //! The least recently used entries are removed above size bytes,
+    //! 4 GB by default, 0 keeps all of them
+    void SetMaxSize(qint64 size) {
+        myMaxSize = size;
+    }
+
+    QString Directory() const {
+        return myDir;
+    }
+
+private:
+    QString cacheFile(const QByteArray& key) const;
+    void removeStale(const QByteArray& key) const;
+    void trim() const;
+
+    QString myDir;
+    qint64 myMaxSize;
+};
+
+#endif // MODELCACHE_H
@@ -0,0 +1,277 @@
+#include "ModelImporter.h"
+
+#include <QFileInfo>
+
+#include <BRep_Builder.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTools.hxx>
+#include <IGESControl_Reader.hxx>
+#include <Message_ProgressIndicator.hxx>
+#include <Standard_Version.hxx>
+#include <STEPControl_Reader.hxx>
+#include <XSControl_WorkSession.hxx>
+#include <Transfer_TransientProcess.hxx>
+
+#include <memory>
+
+#include "PMIModel.h"
+#include "ModelCache.h"
+#include "GeneralTools.h"
+
+//! Forward the OCCT progress to the importer, and its cancel flag back to OCCT
+class ModelImporterProgress : public Message_ProgressIndicator
+{
+public:
+    ModelImporterProgress(ModelImporter* theImporter) : myImporter(theImporter) {}
+
+    virtual Standard_Boolean UserBreak() Standard_OVERRIDE
+    {
+        return myImporter->IsCanceled();
+    }
+
+#if OCC_VERSION_HEX >= 0x070500
+    virtual void Show(const Message_ProgressScope& /*theScope*/, const Standard_Boolean /*isForce*/) Standard_OVERRIDE
+    {
+        myImporter->reportProgress(GetPosition());
+    }
+#else
+    virtual Standard_Boolean Show(const Standard_Boolean /*force*/) Standard_OVERRIDE
+    {
+        myImporter->reportProgress(GetPosition());
+        return Standard_True;
+    }
+#endif
+
+private:
+    ModelImporter* myImporter;
+};
+
+// the range of overall progress taken by each stage
+static const int STAGE_RANGES[] = { 0, 30, 70, 95, 100 };
+
+ModelImporter::ModelImporter(QObject *parent)
+    : QObject(parent),
+      myCancel(0),
+      myLinearRatio(0.001),
+      myAngular(20.0 * M_PI / 180.0),
+      myMeshInParallel(true),
+      myCacheEnabled(true),
+      myPickIndexEnabled(true),
+      myStageFrom(0),
+      myStageTo(0),
+      myLastPercent(-1),
+      myModel(nullptr)
+{
+}
+
+ModelImporter::~ModelImporter()
+{
+    delete myModel;
+}
+
+void ModelImporter::SetMeshDeflection(double linearRatio, double angular)
+{
+    myLinearRatio = linearRatio;
+    myAngular = angular;
+}
+
+void ModelImporter::SetMeshInParallel(bool inParallel)
+{
+    myMeshInParallel = inParallel;
+}
+
+void ModelImporter::SetPickIndexEnabled(bool enabled)
+{
+    myPickIndexEnabled = enabled;
+}
+
+void ModelImporter::SetCacheEnabled(bool enabled)
+{
+    myCacheEnabled = enabled;
+}
+
+void ModelImporter::Cancel()
+{
+    myCancel = 1;
+}
+
+bool ModelImporter::IsCanceled() const
+{
+    return myCancel != 0;
+}
+
+PMIModel *ModelImporter::TakeModel()
+{
+    PMIModel* model = myModel;
+    myModel = nullptr;
+    return model;
+}
+
+QString ModelImporter::StageName(int stage)
+{
+    switch(stage)
+    {
+    case Parse:    return tr("Reading file...");
+    case Transfer: return tr("Transferring shapes...");
+    case Mesh:     return tr("Meshing...");
+    case Index:    return tr("Indexing faces and edges...");
+    }
+    return QString();
+}
+
+void ModelImporter::Import(const QString &fileName)
+{
+    myShape.Nullify();
+    delete myModel;
+    myModel = nullptr;
+    myLastPercent = -1;
+
+    // 0.the cached copy replaces parsing and transferring
+    ModelCache cache;
+    QByteArray cacheKey;
+    bool fromCache = false;
+    if(myCacheEnabled) {
+        beginStage(Parse);
+        emit stageChanged(tr("Loading cache..."));
+        cacheKey = ModelCache::FileKey(fileName);
+        fromCache = cache.Load(cacheKey, myShape);
+    }
+
+    QString message;
+    if(!fromCache && !parseAndTransfer(fileName, message)) {
+        emit importFinished(IsCanceled() ? Canceled : Failed, message);
+        return;
+    }
+
+    // the cached triangulation is kept, meshing only checks it
+    if(!meshShape() || !indexShape()) {
+        emit importFinished(Canceled, QString());
+        return;
+    }
+
+    if(myCacheEnabled && !fromCache) {
+        emit stageChanged(tr("Writing cache..."));
+        cache.Store(cacheKey, myShape);
+    }
+
+    emit importFinished(Done, QString());
+}
+
+bool ModelImporter::parseAndTransfer(const QString &fileName, QString &message)
+{
+    TCollection_AsciiString theAscii(fileName.toUtf8().data());
+
+    QFileInfo info(fileName);
+    const QString suffix = info.suffix().toLower();
+    std::shared_ptr<XSControl_Reader> aReader;
+    if(suffix=="step"||suffix=="stp")
+    {
+        aReader = std::make_shared<STEPControl_Reader>();
+    }
+    else if(suffix=="iges"||suffix=="igs")
+    {
+        aReader = std::make_shared<IGESControl_Reader>();
+    }
+    else if(suffix=="brep"||suffix=="brp")
+    {
+        beginStage(Parse);
+        BRep_Builder aBuilder;
+        if(!BRepTools::Read(myShape,theAscii.ToCString(),aBuilder) || myShape.IsNull())
+        {
+            message = tr("Import failed!");
+            return false;
+        }
+        reportProgress(1);
+        return !IsCanceled();
+    }
+    else
+    {
+        message = tr("Unknown file type!");
+        return false;
+    }
+
+    // 1.parse
+    beginStage(Parse);
+    if(aReader->ReadFile(theAscii.ToCString()) != IFSelect_RetDone)
+    {
+        message = tr("Import failed!");
+        return false;
+    }
+    reportProgress(1);
+    if(IsCanceled())
+        return false;
+
+    // 2.transfer
+    beginStage(Transfer);
+    Handle(ModelImporterProgress) aProgress = new ModelImporterProgress(this);
+#if OCC_VERSION_HEX >= 0x070500
+    const Standard_Integer nbRoots = aReader->TransferRoots(aProgress->Start());
+#else
+    aReader->WS()->MapReader()->SetProgress(aProgress);
+    const Standard_Integer nbRoots = aReader->TransferRoots();
+    aReader->WS()->MapReader()->SetProgress(Handle(Message_ProgressIndicator)());
+#endif
+    if(IsCanceled())
+        return false;
+
+    if(nbRoots == 0)
+    {
+        message = tr("Empty file!");
+        return false;
+    }
+
+    myShape = aReader->OneShape();
+    reportProgress(1);
+    return true;
+}
+
+bool ModelImporter::meshShape()
+{
+    beginStage(Mesh);
+
+    // mesh all the faces at once on every core, the display then uses this triangulation
+    IMeshTools_Parameters aParams;
+    aParams.Deflection = myLinearRatio * GeneralTools::CalcBoundingBoxDiam(myShape);
+    aParams.Angle = myAngular;
+    aParams.InParallel = myMeshInParallel;
+    if(aParams.Deflection <= Precision::Confusion())
+        aParams.Deflection = Precision::Confusion();
+
+#if OCC_VERSION_HEX >= 0x070500
+    Handle(ModelImporterProgress) aProgress = new ModelImporterProgress(this);
+    BRepMesh_IncrementalMesh aMesher(myShape, aParams, aProgress->Start());
+#else
+    BRepMesh_IncrementalMesh aMesher(myShape, aParams);
+#endif
+
+    reportProgress(1);
+    return !IsCanceled();
+}
+
+bool ModelImporter::indexShape()
+{
+    beginStage(Index);
+    myModel = new PMIModel(myShape, myMeshInParallel);
+    if(myPickIndexEnabled)
+        myModel->BuildPickIndex();
+    reportProgress(1);
+    return !IsCanceled();
+}
+
+void ModelImporter::beginStage(Stage stage)
+{
+    myStageFrom = STAGE_RANGES[stage];
+    myStageTo = STAGE_RANGES[stage+1];
+    emit stageChanged(StageName(stage));
+    reportProgress(0);
+}
+
+void ModelImporter::reportProgress(double position)
+{
+    const int percent = myStageFrom + qRound(qBound(0.0, position, 1.0) * (myStageTo - myStageFrom));
+    if(percent == myLastPercent)
+        return;
+
+    myLastPercent = percent;
+    emit progressChanged(percent);
+}
@@ -0,0 +1,102 @@
+#ifndef MODELIMPORTER_H
+#define MODELIMPORTER_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QString>
+
+#include <TopoDS_Shape.hxx>
+
+class PMIModel;
+
+//! Import a STEP/IGES/BREP model in stages: parse, transfer, mesh and index.
+//! The importer is meant to live in a worker thread, it reports the
+//! progress by signals and can be canceled from any thread.
+class ModelImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Stage {
+        Parse = 0,
+        Transfer,
+        Mesh,
+        Index
+    };
+
+    enum Status {
+        Done = 0,
+        Failed,
+        Canceled
+    };
+
+    explicit ModelImporter(QObject *parent = nullptr);
+    ~ModelImporter();
+
+    //! Set the deflection of meshing stage, the linear deflection is
+    //! linearRatio * diameter of model bounding box, the angular one is in radian
+    void SetMeshDeflection(double linearRatio, double angular);
+
+    //! Mesh and classify the faces on every core, it's enabled by default,
+    //! disable it if several models are imported at once
+    void SetMeshInParallel(bool inParallel);
+
+    //! Build the pick index of model after meshing, it's enabled by default,
+    //! disable it if the model is never picked in a viewer
+    void SetPickIndexEnabled(bool enabled);
+
+    //! Enable the binary cache of imported models, it's enabled by default
+    void SetCacheEnabled(bool enabled);
+
+    //! Request to stop the running import, it stops at the next check point
+    void Cancel();
+    bool IsCanceled() const;
+
+    //! The imported shape, valid after importFinished(Done)
+    TopoDS_Shape GetShape() const {
+        return myShape;
+    }
+
+    //! Give the indexed model to the caller, valid after importFinished(Done)
+    PMIModel* TakeModel();
+
+    //! Return the name of stage
+    static QString StageName(int stage);
+
+public slots:
+    //! Run all the stages on the file, the type is detected by the suffix
+    void Import(const QString& fileName);
+
+signals:
+    void stageChanged(const QString& name);
+    //! the overall progress in percent
+    void progressChanged(int percent);
+    void importFinished(int status, const QString& message);
+
+private:
+    friend class ModelImporterProgress;
+
+    bool parseAndTransfer(const QString& fileName, QString& message);
+    bool meshShape();
+    bool indexShape();
+
+    //! Begin a stage, the stage takes the range [from,to] of overall progress
+    void beginStage(Stage stage);
+    //! Report the position inside the current stage, 0 to 1
+    void reportProgress(double position);
+
+    QAtomicInt myCancel;
+    double myLinearRatio;
+    double myAngular;
+    bool myMeshInParallel;
+    bool myCacheEnabled;
+    bool myPickIndexEnabled;
+    int myStageFrom;
+    int myStageTo;
+    int myLastPercent;
+
+    TopoDS_Shape myShape;
+    PMIModel* myModel;
+};
+
+#endif // MODELIMPORTER_H
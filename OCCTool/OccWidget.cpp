@@ -2,6 +2,7 @@
 
 #include <QApplication>
 #include <QMouseEvent>
+#include <QTimer>
 #include <QWheelEvent>
 #include <QDebug>
 
@@ -9,21 +10,46 @@
 #include <Aspect_DisplayConnection.hxx>
 #include <Graphic3d_GraphicDriver.hxx>
 #include <OpenGl_GraphicDriver.hxx>
+#ifdef _WIN32
 #include <WNT_Window.hxx>
+#elif defined(__APPLE__)
+#include <Cocoa_Window.hxx>
+#else
+#include <Xw_Window.hxx>
+#endif
+#include <AIS_ListOfInteractive.hxx>
 #include <AIS_ViewCube.hxx>
+#include <AIS_TextLabel.hxx>
 
 #include <ProjLib.hxx>
 #include <ElSLib.hxx>
 
 #include "AIS_DraftShape.hxx"
 
-OccWidget::OccWidget(QWidget *parent) :QWidget(parent)
+OccWidget::OccWidget(QWidget *parent) :QWidget(parent),
+    myHoverTimer(new QTimer(this)),
+    myHoverPending(false),
+    myHoverRate(0),
+    myHoverCount(0),
+    mySkippedHoverCount(0),
+    myImmediateDrag(true),
+    myDragLayerChanged(false),
+    myAutoLayout(true),
+    myLayoutValid(false)
 {
+    myLayout.SetLazyDisplay(&myLazyDisplay);
+
     // 1.create the viewer
     Handle(Aspect_DisplayConnection) m_display_donnection = new Aspect_DisplayConnection();
     Handle(OpenGl_GraphicDriver) aGraphicDriver = new OpenGl_GraphicDriver(m_display_donnection);
     WId window_handle =  winId();
+#ifdef _WIN32
     Handle(WNT_Window) wind = new WNT_Window((Aspect_Handle) window_handle);
+#elif defined(__APPLE__)
+    Handle(Cocoa_Window) wind = new Cocoa_Window((NSView *) window_handle);
+#else
+    Handle(Xw_Window) wind = new Xw_Window(m_display_donnection, (Window) window_handle);
+#endif
     if (!wind->IsMapped())
     {
         wind->Map();
@@ -83,6 +109,12 @@ OccWidget::OccWidget(QWidget *parent) :QWidget(parent)
     setBackgroundRole( QPalette::NoRole );
     setFocusPolicy( Qt::StrongFocus );
     setMouseTracking(true);
+
+    // 6.hover once for each frame by default
+    myHoverTimer->setSingleShot(true);
+    myHoverTimer->setTimerType(Qt::PreciseTimer);
+    connect(myHoverTimer,&QTimer::timeout,this,&OccWidget::flushHover);
+    SetHoverRate(60);
 }
 
 OccWidget::~OccWidget()
@@ -92,11 +124,134 @@ OccWidget::~OccWidget()
     myManipulator.Nullify();
 }
 
-void OccWidget::paintEvent(QPaintEvent *)
+void OccWidget::SetHoverRate(int rate)
+{
+    myHoverRate = qMax(0, rate);
+    if(myHoverRate == 0)
+        flushHover();
+}
+
+void OccWidget::SetProfiling(bool enabled)
+{
+    myProfiler.SetEnabled(enabled,myView);
+}
+
+void OccWidget::SetProfilerOverlay(bool shown)
 {
+    if(!shown)
+    {
+        if(!myProfilerLabel.IsNull())
+            myContext->Remove(myProfilerLabel,Standard_False);
+        myProfilerLabel.Nullify();
+        myView->Redraw();
+        return;
+    }
+    if(!myProfilerLabel.IsNull())
+        return;
+
+    // a text in pixels over the scene, it can't be selected
+    myProfilerLabel = new AIS_TextLabel();
+    myProfilerLabel->SetColor(Quantity_NOC_WHITE);
+    myProfilerLabel->SetHeight(14);
+    myProfilerLabel->SetVJustification(Graphic3d_VTA_TOP);
+    myProfilerLabel->SetText(TCollection_ExtendedString(myProfiler.Summary().toUtf8().constData(),Standard_True));
+    myProfilerLabel->SetTransformPersistence(
+                new Graphic3d_TransformPers(
+                    Graphic3d_TMF_2d,
+                    Aspect_TOTP_LEFT_UPPER,
+                    Graphic3d_Vec2i(10, 10)));
+    myProfilerLabel->SetZLayer(Graphic3d_ZLayerId_TopOSD);
+    myContext->Display(myProfilerLabel,0,-1,Standard_False);
+    myProfilerLabelClock.start();
     myView->Redraw();
 }
 
+void OccWidget::DisplayLabel(const Handle(Label_PMI) &label, bool update)
+{
+    myLazyDisplay.Display(myContext,myView,myLevelOfDetail,label);
+    if(myLayoutValid)
+        myLayout.Add(label);
+    if(update)
+        myContext->UpdateCurrentViewer();
+}
+
+void OccWidget::DisplayLabels(const QList<Handle(Label_PMI)> &labels)
+{
+    for(int i=0;i<labels.size();++i)
+    {
+        myLazyDisplay.Display(myContext,myView,myLevelOfDetail,labels[i]);
+        if(myLayoutValid)
+            myLayout.Add(labels[i]);
+    }
+    myContext->UpdateCurrentViewer();
+}
+
+void OccWidget::UpdateLabels()
+{
+    if(updateLabels())
+        redraw(false);
+}
+
+void OccWidget::PlaceLabel(const Handle(Label_PMI) &label)
+{
+    if(!myAutoLayout || label.IsNull())
+        return;
+    ensureLayout();
+    myLayout.Place(label);
+}
+
+int OccWidget::LayoutLabels()
+{
+    ensureLayout();
+    int moved = myLayout.Solve();
+    if(moved > 0)
+    {
+        // the kept labels moved into the view are displayed
+        updateLabels();
+        redraw(false);
+    }
+    return moved;
+}
+
+void OccWidget::resetLayout()
+{
+    QList<Handle(Label_PMI)> labels = myLazyDisplay.Pending();
+    AIS_ListOfInteractive displayed;
+    myContext->DisplayedObjects(displayed);
+    for(AIS_ListOfInteractive::Iterator anIter(displayed); anIter.More(); anIter.Next())
+    {
+        Handle(Label_PMI) label = Handle(Label_PMI)::DownCast(anIter.Value());
+        if(!label.IsNull())
+            labels.append(label);
+    }
+
+    Standard_Integer width = 0, height = 0;
+    myView->Window()->Size(width, height);
+    myLayout.Reset(labels, myView->Camera(), width, height);
+    myLayoutValid = true;
+}
+
+void OccWidget::ensureLayout()
+{
+    Standard_Integer width = 0, height = 0;
+    myView->Window()->Size(width, height);
+    if(!myLayoutValid || !myLayout.IsCurrent(myView->Camera(), width, height))
+        resetLayout();
+}
+
+bool OccWidget::updateLabels()
+{
+    bool displayed = myLazyDisplay.Update(myContext,myView,myLevelOfDetail);
+    bool switched = myLevelOfDetail.Update(myContext,myView);
+    return displayed || switched;
+}
+
+void OccWidget::paintEvent(QPaintEvent *)
+{
+    updateLabels();
+    redraw(false);
+}
+
 void OccWidget::resizeEvent(QResizeEvent *)
 {
     if( !myView.IsNull() )
@@ -107,6 +262,7 @@ void OccWidget::resizeEvent(QResizeEvent *)
 
 void OccWidget::mousePressEvent(QMouseEvent *event)
 {
+    cancelHover();
     if(event->button()==Qt::RightButton)
     {
         setCursor(Qt::ClosedHandCursor);
@@ -117,7 +273,11 @@ void OccWidget::mousePressEvent(QMouseEvent *event)
         myContext->MoveTo(event->pos().x(),event->pos().y(),myView,Standard_True);
 
         if(myManipulator->IsAttached())
+        {
+            raiseForDrag(myManipulator);
+            raiseForDrag(myManipulator->Object());
             myManipulator->StartTransform(event->pos().x(),event->pos().y(),myView);
+        }
     }
     else if(event->button() == Qt::MidButton)
     {
@@ -128,7 +288,11 @@ void OccWidget::mousePressEvent(QMouseEvent *event)
 
 void OccWidget::mouseReleaseEvent(QMouseEvent *event)
 {
+    QElapsedTimer aClock;
+    aClock.start();
+    cancelHover();
     unsetCursor();
+    endDrag();
     myContext->MoveTo(event->pos().x(),event->pos().y(),myView,Standard_True);
 
     if(event->button()==Qt::LeftButton)
@@ -145,6 +309,7 @@ void OccWidget::mouseReleaseEvent(QMouseEvent *event)
         {
             t_pick_status = myContext->Select(true);
         }
+        sample(ViewProfiler::Select,aClock);
 
         if(t_pick_status == AIS_SOP_OneSelected || t_pick_status == AIS_SOP_SeveralSelected)
         {
@@ -160,44 +325,219 @@ void OccWidget::mouseMoveEvent(QMouseEvent *event)
     if(event->buttons()&Qt::RightButton)
     {
         myView->Rotation(event->x(),event->y());
+        UpdateLabels();
     }
     else if(event->buttons()&Qt::MidButton)
     {
         myView->Pan(event->pos().x()-myPanStartPoint.x()
                     ,myPanStartPoint.y()-event->pos().y());
         myPanStartPoint = event->pos();
+        UpdateLabels();
     }
     else if(event->buttons()&Qt::LeftButton)
     {
+        QElapsedTimer aClock;
+        aClock.start();
         if(!myManipulator->IsAttached())
         {
             gp_Pnt pos = convertClickToPoint(event->x(),event->y());
+            bool moved = false;
             for(myContext->InitSelected();myContext->MoreSelected();myContext->NextSelected())
             {
                 Handle(AIS_DraftShape) shape = Handle(AIS_DraftShape)::DownCast(myContext->SelectedInteractive());
                 if(!shape.IsNull())
                 {
+                    if(!myDraggedShapes.contains(shape))
+                    {
+                        shape->BeginDrag();
+                        myDraggedShapes.append(shape);
+                        raiseForDrag(shape);
+                    }
                     shape->SetLocation(pos);
-                    myView->Update();
+                    moved = true;
                 }
             }
+            if(moved)
+            {
+                redrawDrag();
+                sample(ViewProfiler::Drag,aClock);
+            }
         }
         else
         {
             myManipulator->Transform(event->pos().x(),event->pos().y(),myView);
-            myView->Update();
+            redrawDrag();
+            sample(ViewProfiler::Drag,aClock);
         }
     }
     else
     {
-        myContext->MoveTo(event->pos().x(),event->pos().y(),myView,Standard_True);
+        hover(event->pos());
     }
 }
 
 void OccWidget::wheelEvent(QWheelEvent *event)
 {
+    // the view is redrawn by the zoom itself
+    QElapsedTimer aClock;
+    aClock.start();
     myView->StartZoomAtPoint(event->pos().x(),event->pos().y());
     myView->ZoomAtPoint(0, 0, event->angleDelta().y()/5, 0);
+    UpdateLabels();
+    sample(ViewProfiler::Zoom,aClock);
+}
+
+void OccWidget::endDrag()
+{
+    QList<Handle(Label_PMI)> dragged;
+    for(int i=0;i<myDraggedShapes.size();++i)
+    {
+        myDraggedShapes[i]->EndDrag();
+        Handle(Label_PMI) label = Handle(Label_PMI)::DownCast(myDraggedShapes[i]);
+        if(!label.IsNull())
+            dragged.append(label);
+    }
+    myDraggedShapes.clear();
+
+    // the dragged labels stay where they are dropped, the covered ones make way
+    int moved = 0;
+    if(myAutoLayout && !dragged.isEmpty())
+    {
+        ensureLayout();
+        for(int i=0;i<dragged.size();++i)
+        {
+            moved += myLayout.Pin(dragged[i]);
+        }
+        if(moved > 0)
+            updateLabels();
+    }
+
+    // back to their own layers, the whole scene is redrawn once
+    if(myRaisedObjects.isEmpty())
+    {
+        if(moved > 0)
+            redraw(false);
+        return;
+    }
+    for(int i=0;i<myRaisedObjects.size();++i)
+    {
+        myContext->SetZLayer(myRaisedObjects[i],myRaisedLayers[i]);
+    }
+    myRaisedObjects.clear();
+    myRaisedLayers.clear();
+    myDragLayerChanged = false;
+    redraw(false);
+}
+
+void OccWidget::raiseForDrag(const Handle(AIS_InteractiveObject) &object)
+{
+    if(!myImmediateDrag || object.IsNull() || myRaisedObjects.contains(object))
+        return;
+
+    // the manipulator is already drawn over the scene
+    const Graphic3d_ZLayerId layer = object->ZLayer();
+    if(layer == Graphic3d_ZLayerId_Top || layer == Graphic3d_ZLayerId_Topmost)
+        return;
+
+    myRaisedObjects.append(object);
+    myRaisedLayers.append(layer);
+    myContext->SetZLayer(object,Graphic3d_ZLayerId_Top);
+    myDragLayerChanged = true;
+}
+
+void OccWidget::redrawDrag()
+{
+    if(!myImmediateDrag)
+    {
+        QElapsedTimer aClock;
+        aClock.start();
+        myView->Update();
+        frameDrawn(aClock);
+    }
+    else if(myDragLayerChanged)
+    {
+        // the cached scene still has the raised objects, draw it once without them
+        myDragLayerChanged = false;
+        redraw(false);
+    }
+    else
+    {
+        redraw(true);
+    }
+}
+
+void OccWidget::redraw(bool immediateOnly)
+{
+    QElapsedTimer aClock;
+    aClock.start();
+    if(immediateOnly)
+        myView->RedrawImmediate();
+    else
+        myView->Redraw();
+    frameDrawn(aClock);
+}
+
+void OccWidget::frameDrawn(const QElapsedTimer &clock)
+{
+    if(!myProfiler.IsEnabled())
+        return;
+    myProfiler.AddFrame(clock.nsecsElapsed() / 1.0e6,myView);
+
+    // the overlay is in an immediate layer, the new text is shown by the next frame
+    if(!myProfilerLabel.IsNull() && myProfilerLabelClock.elapsed() >= 500)
+    {
+        myProfilerLabel->SetText(TCollection_ExtendedString(myProfiler.Summary().toUtf8().constData(),Standard_True));
+        myContext->Redisplay(myProfilerLabel,Standard_False);
+        myProfilerLabelClock.start();
+    }
+}
+
+void OccWidget::sample(ViewProfiler::Event event, const QElapsedTimer &clock)
+{
+    myProfiler.AddSample(event,clock.nsecsElapsed() / 1.0e6);
+}
+
+void OccWidget::hover(const QPoint &pos)
+{
+    if(myHoverPending)
+        ++mySkippedHoverCount;
+    myHoverPos = pos;
+    myHoverEventClock.start();
+    myHoverPending = true;
+
+    if(myHoverRate == 0) {
+        flushHover();
+        return;
+    }
+
+    // the first move of a frame is detected at once, the later ones wait for the frame end
+    const qint64 interval = 1000 / myHoverRate;
+    const qint64 elapsed = myHoverClock.isValid() ? myHoverClock.elapsed() : interval;
+    if(elapsed >= interval)
+        flushHover();
+    else if(!myHoverTimer->isActive())
+        myHoverTimer->start(int(interval - elapsed));
+}
+
+void OccWidget::cancelHover()
+{
+    myHoverTimer->stop();
+    myHoverPending = false;
+}
+
+void OccWidget::flushHover()
+{
+    myHoverTimer->stop();
+    if(!myHoverPending)
+        return;
+    myHoverPending = false;
+
+    // the highlight lives in the immediate layer, the scene is kept
+    myContext->MoveTo(myHoverPos.x(),myHoverPos.y(),myView,Standard_False);
+    redraw(true);
+    sample(ViewProfiler::Hover,myHoverEventClock);
+    myHoverClock.start();
+    ++myHoverCount;
 }
 
 QPaintEngine *OccWidget::paintEngine() const
@@ -1,17 +1,26 @@
 ﻿#ifndef OCCWIDGET_H
 #define OCCWIDGET_H
 
+#include <QElapsedTimer>
 #include <QWidget>
 
 #include <AIS_InteractiveContext.hxx>
 #include <V3d_View.hxx>
 #include <AIS_Manipulator.hxx>
 
+#include "AIS_DraftShape.hxx"
+#include "ViewProfiler.h"
+#include "Label/Label_Layout.h"
+#include "Label/Label_LazyDisplay.h"
+#include "Label/Label_LevelOfDetail.h"
+
 class AIS_InteractiveContext;
 class V3d_View;
 class AIS_Manipulator;
 
 class AIS_Shape;
+class AIS_TextLabel;
+class QTimer;
 
 class OccWidget:public QWidget
 {
@@ -36,6 +45,99 @@ public:
         return myManipulator;
     }
 
+    //! Limit the hover highlighting to rate detections per second, only the
+    //! latest cursor position of a frame is detected. 0 detects on every move.
+    void SetHoverRate(int rate);
+    int HoverRate() const
+    {
+        return myHoverRate;
+    }
+
+    //! The number of hover detections and of the moves dropped by the rate limit
+    quint64 HoverCount() const
+    {
+        return myHoverCount;
+    }
+    quint64 SkippedHoverCount() const
+    {
+        return mySkippedHoverCount;
+    }
+    void ResetHoverCount()
+    {
+        myHoverCount = mySkippedHoverCount = 0;
+    }
+
+    //! Move the dragged labels and the manipulator into the top layer while
+    //! dragging, only that layer is redrawn over the cached scene. It's enabled
+    //! by default, otherwise the whole scene is redrawn on every move.
+    void SetImmediateDrag(bool enabled)
+    {
+        myImmediateDrag = enabled;
+    }
+
+    //! Record the frame times and the latencies of hover, selection, drag
+    //! and zoom. It's disabled by default.
+    void SetProfiling(bool enabled);
+    bool IsProfiling() const
+    {
+        return myProfiler.IsEnabled();
+    }
+    ViewProfiler& Profiler()
+    {
+        return myProfiler;
+    }
+
+    //! Show the summary of the profiler in the upper left corner of the view
+    void SetProfilerOverlay(bool shown);
+
+    //! The text height where the labels switch between the glyphs and the font texture
+    Label_LevelOfDetail& LevelOfDetail()
+    {
+        return myLevelOfDetail;
+    }
+
+    //! The labels kept out of the view until the camera turns to them
+    Label_LazyDisplay& LazyDisplay()
+    {
+        return myLazyDisplay;
+    }
+
+    //! Display the label when it comes into the view, see Label_LazyDisplay
+    void DisplayLabel(const Handle(Label_PMI)& label, bool update);
+
+    //! Display all the labels as DisplayLabel(), the viewer is updated once at the end
+    void DisplayLabels(const QList<Handle(Label_PMI)>& labels);
+
+    //! Display the labels which came into the view and switch the labels by
+    //! their size on the screen after the camera changed, the view is redrawn
+    //! if any label is displayed or switched
+    void UpdateLabels();
+
+    //! Move the new labels and the labels covered by a dragged one out of the
+    //! way of the others, see Label_Layout
+    void SetAutoLayout(bool enabled)
+    {
+        myAutoLayout = enabled;
+    }
+    bool IsAutoLayout() const
+    {
+        return myAutoLayout;
+    }
+
+    //! Move the label to a free place if the auto layout is on, before it's displayed
+    void PlaceLabel(const Handle(Label_PMI)& label);
+
+    //! Place all the labels again for the current camera and redraw,
+    //! return the number of moved labels
+    int LayoutLabels();
+
+    //! The labels were removed from the context, the layout is taken
+    //! again from the displayed labels when it's needed next
+    void InvalidateLayout()
+    {
+        myLayoutValid = false;
+    }
+
 protected:
     void paintEvent(QPaintEvent *);
     void resizeEvent(QResizeEvent *);
@@ -53,8 +155,70 @@ private:
 
     QPoint myPanStartPoint;
 
+    //! the hover waiting for the next frame
+    QTimer* myHoverTimer;
+    QElapsedTimer myHoverClock;
+    QPoint myHoverPos;
+    bool myHoverPending;
+    int myHoverRate;
+    quint64 myHoverCount;
+    quint64 mySkippedHoverCount;
+
+    //! the shapes moved by the left button, until it is released
+    QList<Handle(AIS_DraftShape)> myDraggedShapes;
+
+    //! the objects raised to the top layer for the drag, with their own layers
+    bool myImmediateDrag;
+    bool myDragLayerChanged;
+    QList<Handle(AIS_InteractiveObject)> myRaisedObjects;
+    QList<Graphic3d_ZLayerId> myRaisedLayers;
+
+    //! the latest hover event, the latency is counted from it
+    QElapsedTimer myHoverEventClock;
+
+    Label_LevelOfDetail myLevelOfDetail;
+    Label_LazyDisplay myLazyDisplay;
+    Label_Layout myLayout;
+    bool myAutoLayout;
+    //! false until the layout is taken from all the labels, and after labels are removed
+    bool myLayoutValid;
+
+    ViewProfiler myProfiler;
+    Handle(AIS_TextLabel) myProfilerLabel;
+    QElapsedTimer myProfilerLabelClock;
+
     gp_Pnt convertClickToPoint(Standard_Real x, Standard_Real y);
 
+    //! finish the drag of all the dragged shapes
+    void endDrag();
+
+    //! put the object into the top layer until endDrag()
+    void raiseForDrag(const Handle(AIS_InteractiveObject)& object);
+    //! redraw after the dragged objects moved
+    void redrawDrag();
+
+    //! draw the whole scene or only the immediate layers, and record the frame
+    void redraw(bool immediateOnly);
+    //! record a frame drawn since clock started
+    void frameDrawn(const QElapsedTimer& clock);
+    void sample(ViewProfiler::Event event, const QElapsedTimer& clock);
+
+    //! display and switch the labels for the camera, return true if any changed
+    bool updateLabels();
+
+    //! take all the labels, displayed or not, as seen by the current camera
+    void resetLayout();
+    //! reset the layout only if labels were removed or the camera or the view size
+    //! changed since, otherwise the labels are added and placed one by one
+    void ensureLayout();
+
+    //! detect at the cursor position, or wait for the next frame
+    void hover(const QPoint& pos);
+    void cancelHover();
+
+private slots:
+    void flushHover();
+
 signals:
     void pickPixel(int x ,int y);
     void selectShapeChanged();
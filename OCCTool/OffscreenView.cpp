@@ -0,0 +1,128 @@
+#include "OffscreenView.h"
+
+#include <QImage>
+
+#include <Aspect_DisplayConnection.hxx>
+#include <Image_PixMap.hxx>
+#include <Graphic3d_Camera.hxx>
+#include <OpenGl_GraphicDriver.hxx>
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
+#include <V3d_ImageDumpOptions.hxx>
+#include <V3d_Viewer.hxx>
+
+#ifdef _WIN32
+#include <WNT_WClass.hxx>
+#include <WNT_Window.hxx>
+#else
+#include <Xw_Window.hxx>
+#endif
+
+OffscreenView::OffscreenView(int width, int height)
+    : myWidth(width),
+      myHeight(height)
+{
+    try {
+        // 1.create the viewer
+        Handle(Aspect_DisplayConnection) aDisplay = new Aspect_DisplayConnection();
+        Handle(OpenGl_GraphicDriver) aGraphicDriver = new OpenGl_GraphicDriver(aDisplay);
+        // nothing is shown, don't swap or wait for the vertical sync
+        aGraphicDriver->ChangeOptions().buffersNoSwap = Standard_True;
+        aGraphicDriver->ChangeOptions().swapInterval = 0;
+        Handle(V3d_Viewer) aViewer = new V3d_Viewer(aGraphicDriver);
+        aViewer->SetDefaultLights();
+        aViewer->SetLightOn();
+
+        // 2.a hidden window, it's never mapped on the screen
+#ifdef _WIN32
+        Handle(WNT_WClass) aClass = new WNT_WClass("PMIOffscreen", (Standard_Address)DefWindowProcW,
+                                                   CS_VREDRAW | CS_HREDRAW, 0, 0,
+                                                   ::LoadCursor(NULL, IDC_ARROW));
+        Handle(WNT_Window) aWindow = new WNT_Window("PMIOffscreen", aClass, WS_POPUP,
+                                                    0, 0, width, height, Quantity_NOC_WHITE);
+#else
+        Handle(Xw_Window) aWindow = new Xw_Window(aDisplay, "PMIOffscreen", 0, 0, width, height);
+#endif
+        aWindow->SetVirtual(Standard_True);
+
+        // 3.create the view and the context
+        Handle(V3d_View) aView = aViewer->CreateView();
+        aView->SetWindow(aWindow);
+        aView->ChangeRenderingParams().Method = Graphic3d_RM_RASTERIZATION;
+        aView->ChangeRenderingParams().IsAntialiasingEnabled = Standard_True;
+        aView->SetBackgroundColor(Quantity_NOC_WHITE);
+
+        myContext = new AIS_InteractiveContext(aViewer);
+        myContext->SetDisplayMode(AIS_Shaded, Standard_False);
+        myView = aView;
+    }
+    catch(const Standard_Failure&) {
+        // no display or no OpenGL, IsValid() tells it
+        myContext.Nullify();
+        myView.Nullify();
+    }
+}
+
+OffscreenView::~OffscreenView()
+{
+    myContext.Nullify();
+    myView.Nullify();
+}
+
+void OffscreenView::SetProjection(V3d_TypeOfOrientation orientation)
+{
+    if(myView.IsNull())
+        return;
+
+    myView->SetProj(orientation, Standard_False);
+    myView->FitAll(0.05, Standard_False);
+}
+
+void OffscreenView::SetCamera(const gp_Pnt &eye, const gp_Pnt &at, const gp_Dir &up, bool fit)
+{
+    if(myView.IsNull() || eye.IsEqual(at, Precision::Confusion()))
+        return;
+
+    Handle(Graphic3d_Camera) aCamera = myView->Camera();
+    aCamera->SetEyeAndCenter(eye, at);
+    aCamera->SetUp(up);
+    // an up direction along the view would make the camera degenerate
+    aCamera->OrthogonalizeUp();
+    if(fit)
+        myView->FitAll(0.05, Standard_False);
+    myView->Invalidate();
+}
+
+bool OffscreenView::Dump(const QString &fileName, int width, int height)
+{
+    if(myView.IsNull())
+        return false;
+
+    if(width <= 0 || height <= 0) {
+        width = myWidth;
+        height = myHeight;
+    }
+
+    // the frame buffer of ToPixMap gets the size of image, the aspect of camera follows it
+    if(myPixMap.IsEmpty() || int(myPixMap.SizeX()) != width || int(myPixMap.SizeY()) != height) {
+        myPixMap.SetTopDown(true);
+        if(!myPixMap.InitZero(Image_Format_RGBA, width, height)) {
+            myPixMap.Clear();
+            return false;
+        }
+    }
+
+    V3d_ImageDumpOptions anOptions;
+    anOptions.Width = width;
+    anOptions.Height = height;
+    anOptions.BufferType = Graphic3d_BT_RGBA;
+    anOptions.StereoOptions = V3d_SDO_MONO;
+    anOptions.ToAdjustAspect = Standard_True;
+    if(!myView->ToPixMap(myPixMap, anOptions))
+        return false;
+
+    QImage image(myPixMap.Data(), width, height, int(myPixMap.SizeRowBytes()), QImage::Format_RGBA8888);
+    if(!myPixMap.IsTopDown())
+        image = image.mirrored();
+    return image.save(fileName);
+}
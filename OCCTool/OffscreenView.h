@@ -0,0 +1,57 @@
+#ifndef OFFSCREENVIEW_H
+#define OFFSCREENVIEW_H
+
+#include <QString>
+
+#include <AIS_InteractiveContext.hxx>
+#include <Image_PixMap.hxx>
+#include <V3d_View.hxx>
+
+//! A viewer drawing into a hidden window, used to take snapshots without a widget.
+//! The images are drawn into a frame buffer of their own size, the window is
+//! only there for the OpenGL context. On Linux it needs an X display, a virtual
+//! one such as Xvfb is enough, and Mesa draws it in software without a GPU.
+//! The context and the displayed objects are kept between the snapshots, so
+//! the views of a scene are drawn without computing it again.
+class OffscreenView
+{
+public:
+    OffscreenView(int width, int height);
+    ~OffscreenView();
+
+    //! Return false if the graphic driver or the window can't be created
+    bool IsValid() const {
+        return !myView.IsNull();
+    }
+
+    Handle(V3d_View) GetView() const {
+        return myView;
+    }
+
+    Handle(AIS_InteractiveContext) GetContext() const {
+        return myContext;
+    }
+
+    //! Fit all the displayed objects in the given view direction
+    void SetProjection(V3d_TypeOfOrientation orientation);
+
+    //! Look from eye at the point at, and fit all the displayed objects
+    //! in that direction if fit is set
+    void SetCamera(const gp_Pnt& eye, const gp_Pnt& at, const gp_Dir& up, bool fit = false);
+
+    //! Render the scene and write the image, the format is given by the suffix.
+    //! The image has the size of view unless a width and a height are given.
+    bool Dump(const QString& fileName, int width = 0, int height = 0);
+
+private:
+    int myWidth;
+    int myHeight;
+
+    //! reused while the size of images doesn't change
+    Image_PixMap myPixMap;
+
+    Handle(AIS_InteractiveContext) myContext;
+    Handle(V3d_View) myView;
+};
+
+#endif // OFFSCREENVIEW_H
@@ -2,47 +2,117 @@
 
 #include <TopExp_Explorer.hxx>
 #include <TopExp.hxx>
+#include <BRepBndLib.hxx>
+#include <OSD_Parallel.hxx>
+#include <TopoDS.hxx>
 
-int PMIModel::shapeNb = 0;
+//! Classify the unique shapes of a model, one shape in each call
+struct ClassifyFunctor
+{
+    ClassifyFunctor(const QVector<TopoDS_Shape>& shapes, ShapeFeature* features)
+        : myShapes(shapes), myFeatures(features) {}
+
+    void operator()(int index) const {
+        myFeatures[index] = ShapeFeature::Classify(myShapes[index]);
+    }
+
+    const QVector<TopoDS_Shape>& myShapes;
+    ShapeFeature* myFeatures;
+};
 
 PMIModel::PMIModel()
 {
 }
 
-PMIModel::PMIModel(const TopoDS_Shape &origin)
+PMIModel::PMIModel(const TopoDS_Shape &origin, bool inParallel)
 {
-    SetOriginShape(origin);
+    SetOriginShape(origin, inParallel);
 }
 
-void PMIModel::SetOriginShape(const TopoDS_Shape &shape)
+void PMIModel::SetOriginShape(const TopoDS_Shape &shape, bool inParallel)
 {
     myOriginShape = shape;
     mappingShape(shape);
+    boundingShape(shape);
+    classifyShape(inParallel);
+    // the triangulation may change after this, BuildPickIndex() is called later
+    myPickIndex.Clear();
 }
 
 int PMIModel::FindShape(const TopoDS_Shape &shape) const
 {
-    QHash<int, TopoDS_Shape>::ConstIterator ite = myShapeMap.constBegin();
-    for( ; ite != myShapeMap.constEnd(); ++ite) {
-        if(ite.value().IsSame(shape))
-            return ite.key();
+    if(shape.IsNull())
+        return -1;
+
+    const Standard_Integer* index = myIndexMap.Seek(shape);
+    return index ? *index : -1;
+}
+
+QList<int> PMIModel::FindShapes(const QList<TopoDS_Shape> &shapes) const
+{
+    QList<int> indices;
+    indices.reserve(shapes.size());
+    for(int i=0;i<shapes.size();++i) {
+        indices.append(FindShape(shapes[i]));
+    }
+    return indices;
+}
+
+QSet<int> PMIModel::FindFaces(const TopoDS_Shape &shape) const
+{
+    QSet<int> faces;
+    if(shape.IsNull())
+        return faces;
+
+    for(TopExp_Explorer anExp(shape, TopAbs_FACE); anExp.More(); anExp.Next()) {
+        const int index = FindShape(anExp.Current());
+        if(index >= 0)
+            faces.insert(index);
     }
-    return -1;
+    return faces;
+}
+
+TopoDS_Shape PMIModel::GetShape(int index) const
+{
+    return myShapeMap.value(index);
+}
+
+ShapeFeature PMIModel::Feature(const TopoDS_Shape &shape) const
+{
+    int index = FindShape(shape);
+    if(index >= 0 && index < myFeatures.size())
+        return myFeatures[index];
+    return ShapeFeature::Classify(shape);
+}
+
+void PMIModel::BuildPickIndex()
+{
+    myPickIndex.Clear();
+    for(TopTools_DataMapOfShapeInteger::Iterator it(myIndexMap);it.More();it.Next())
+    {
+        if(it.Key().ShapeType() == TopAbs_FACE)
+            myPickIndex.Add(it.Value(), TopoDS::Face(it.Key()));
+    }
+    myPickIndex.Build();
 }
 
 void PMIModel::mappingShape(const TopoDS_Shape &shape)
 {
+    myShapeMap.clear();
+    myIndexMap.Clear();
     if(shape.IsNull())
         return;
 
-    myShapeMap.clear();
-    shapeNb = 0;
+    // a local counter, models may be indexed in several threads at once
+    int shapeNb = 0;
 
     //face
     TopExp_Explorer aExplorer(shape,TopAbs_FACE);
     for(;aExplorer.More();aExplorer.Next())
     {
         myShapeMap.insert(shapeNb,aExplorer.Current());
+        if(!myIndexMap.IsBound(aExplorer.Current()))
+            myIndexMap.Bind(aExplorer.Current(),shapeNb);
         shapeNb++;
     }
 
@@ -50,6 +120,43 @@ void PMIModel::mappingShape(const TopoDS_Shape &shape)
     for(aExplorer.Init(shape,TopAbs_EDGE);aExplorer.More();aExplorer.Next())
     {
         myShapeMap.insert(shapeNb,aExplorer.Current());
+        if(!myIndexMap.IsBound(aExplorer.Current()))
+            myIndexMap.Bind(aExplorer.Current(),shapeNb);
         shapeNb++;
     }
 }
+
+void PMIModel::boundingShape(const TopoDS_Shape &shape)
+{
+    myBox.SetVoid();
+    myOBB.SetVoid();
+    if(shape.IsNull())
+        return;
+
+    // the same box as AIS_Shape::BoundingBox()
+    BRepBndLib::Add(shape, myBox, Standard_False);
+    BRepBndLib::AddOBB(shape, myOBB);
+}
+
+void PMIModel::classifyShape(bool inParallel)
+{
+    myFeatures.clear();
+    myFeatures.resize(myShapeMap.size());
+
+    // the shared edges appear once for each face, classify the first one only
+    QVector<int> indices;
+    QVector<TopoDS_Shape> shapes;
+    for(TopTools_DataMapOfShapeInteger::Iterator it(myIndexMap);it.More();it.Next())
+    {
+        indices.append(it.Value());
+        shapes.append(it.Key());
+    }
+    if(shapes.isEmpty())
+        return;
+
+    QVector<ShapeFeature> features(shapes.size());
+    OSD_Parallel::For(0, shapes.size(), ClassifyFunctor(shapes, features.data()), !inParallel);
+
+    for(int i=0;i<indices.size();++i)
+        myFeatures[indices[i]] = features[i];
+}
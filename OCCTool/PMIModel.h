@@ -2,28 +2,80 @@
 #define PMIMODEL_H
 
 #include <QHash>
+#include <QList>
+#include <QSet>
+#include <QVector>
 
+#include <Bnd_Box.hxx>
+#include <Bnd_OBB.hxx>
 #include <TopoDS_Shape.hxx>
+#include <TopTools_DataMapOfShapeInteger.hxx>
+
+#include "PickIndex.h"
+#include "ShapeFeature.h"
 
 class PMIModel
 {
 public:
     PMIModel();
-    PMIModel(const TopoDS_Shape& origin);
+    PMIModel(const TopoDS_Shape& origin, bool inParallel = true);
 
     TopoDS_Shape GetOriginShape() const {
         return myOriginShape;
     }
-    void SetOriginShape(const TopoDS_Shape& shape);
+    //! Index, bound and classify the faces and edges of shape,
+    //! the classification runs on every core if inParallel is true
+    void SetOriginShape(const TopoDS_Shape& shape, bool inParallel = true);
+
+    //! Return the axis aligned bounding box of origin shape
+    const Bnd_Box& BoundingBox() const {
+        return myBox;
+    }
+    //! Return the oriented bounding box of origin shape
+    const Bnd_OBB& OrientedBox() const {
+        return myOBB;
+    }
+
+    //! Return the index of face or edge, -1 if it's not in the model
     int FindShape(const TopoDS_Shape& shape) const;
+    //! Return the indices of shapes in the same order, -1 for the missing ones
+    QList<int> FindShapes(const QList<TopoDS_Shape>& shapes) const;
+    //! Return the indices of the faces of shape which are in the model
+    QSet<int> FindFaces(const TopoDS_Shape& shape) const;
+    //! Return the face or edge by index, null shape if the index is invalid
+    TopoDS_Shape GetShape(int index) const;
+
+    //! Return the classification of face or edge made by SetOriginShape,
+    //! a shape out of the model is classified on demand
+    ShapeFeature Feature(const TopoDS_Shape& shape) const;
+
+    //! Build the pick index over the triangulation of faces,
+    //! it must be called after meshing, the model isn't pickable without it
+    void BuildPickIndex();
+    //! Find the nearest face hit by ray, only the face of given index is hit if face isn't -1
+    bool Pick(const gp_Lin& ray, PickIndex::Result& result, int face = -1) const {
+        return myPickIndex.Pick(ray, result, face);
+    }
+    //! Find the nearest face hit by ray among the faces of given indices
+    bool Pick(const gp_Lin& ray, PickIndex::Result& result, const QSet<int>& faces) const {
+        return myPickIndex.Pick(ray, result, faces);
+    }
 
 private:
     TopoDS_Shape myOriginShape;
+    Bnd_Box myBox;
+    Bnd_OBB myOBB;
 
     void mappingShape(const TopoDS_Shape& shape);
+    void boundingShape(const TopoDS_Shape& shape);
+    void classifyShape(bool inParallel);
 
     QHash<int, TopoDS_Shape> myShapeMap;
-    static int shapeNb;
+    //! reverse index of myShapeMap, a shape shared by several faces keeps its first index
+    TopTools_DataMapOfShapeInteger myIndexMap;
+    //! features by shape index, only the first index of a shared shape is classified
+    QVector<ShapeFeature> myFeatures;
+    PickIndex myPickIndex;
 
 };
 
@@ -0,0 +1,348 @@
+#include "PickIndex.h"
+
+#include <BRepAdaptor_Surface.hxx>
+#include <BRep_Tool.hxx>
+#include <GeomAPI_ProjectPointOnSurf.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Precision.hxx>
+#include <Standard_Version.hxx>
+#include <gp.hxx>
+
+#include <algorithm>
+
+// triangles in a leaf, a few of them are cheaper than another level of boxes
+static const int LEAF_SIZE = 4;
+// the depth of a median split tree stays far below it
+static const int STACK_SIZE = 64;
+
+PickIndex::PickIndex()
+{
+}
+
+void PickIndex::Clear()
+{
+    myEntries.clear();
+    myTriangles.clear();
+    myPoints.clear();
+    myUVs.clear();
+    myOrder.clear();
+    myNodes.clear();
+}
+
+void PickIndex::Add(int index, const TopoDS_Face &face)
+{
+    TopLoc_Location aLoc;
+    Handle(Poly_Triangulation) aTriangulation = BRep_Tool::Triangulation(face, aLoc);
+    if(aTriangulation.IsNull())
+        return;
+
+    Entry anEntry;
+    anEntry.Index = index;
+    anEntry.Face = face;
+    anEntry.HasUV = aTriangulation->HasUVNodes();
+    const int entry = myEntries.size();
+    myEntries.append(anEntry);
+
+    // the nodes are in the frame of face, move them into the model
+    const gp_Trsf aTrsf = aLoc.Transformation();
+    const int base = myPoints.size();
+    for(int i=1;i<=aTriangulation->NbNodes();++i)
+    {
+#if OCC_VERSION_HEX >= 0x070600
+        myPoints.append(aTriangulation->Node(i).Transformed(aTrsf).XYZ());
+        myUVs.append(anEntry.HasUV ? aTriangulation->UVNode(i).XY() : gp_XY());
+#else
+        myPoints.append(aTriangulation->Nodes()(i).Transformed(aTrsf).XYZ());
+        myUVs.append(anEntry.HasUV ? aTriangulation->UVNodes()(i).XY() : gp_XY());
+#endif
+    }
+
+    for(int i=1;i<=aTriangulation->NbTriangles();++i)
+    {
+        Standard_Integer n1, n2, n3;
+#if OCC_VERSION_HEX >= 0x070600
+        aTriangulation->Triangle(i).Get(n1, n2, n3);
+#else
+        aTriangulation->Triangles()(i).Get(n1, n2, n3);
+#endif
+        Triangle aTriangle;
+        aTriangle.Nodes[0] = base + n1 - 1;
+        aTriangle.Nodes[1] = base + n2 - 1;
+        aTriangle.Nodes[2] = base + n3 - 1;
+        aTriangle.Entry = entry;
+        myTriangles.append(aTriangle);
+    }
+}
+
+void PickIndex::Build()
+{
+    myNodes.clear();
+    myOrder.resize(myTriangles.size());
+    if(myTriangles.isEmpty())
+        return;
+
+    QVector<gp_XYZ> centers(myTriangles.size());
+    for(int i=0;i<myTriangles.size();++i)
+    {
+        const Triangle& tri = myTriangles[i];
+        centers[i] = (myPoints[tri.Nodes[0]] + myPoints[tri.Nodes[1]] + myPoints[tri.Nodes[2]]) / 3.0;
+        myOrder[i] = i;
+    }
+
+    myNodes.reserve(2 * myTriangles.size() / LEAF_SIZE + 1);
+    buildNode(0, myTriangles.size(), centers);
+}
+
+int PickIndex::buildNode(int first, int last, QVector<gp_XYZ> &centers)
+{
+    const int index = myNodes.size();
+    myNodes.append(Node());
+
+    // bounds of the triangles and of their centers
+    Node node;
+    double centerMin[3], centerMax[3];
+    for(int i=0;i<3;++i) {
+        node.Min[i] = centerMin[i] = RealLast();
+        node.Max[i] = centerMax[i] = -RealLast();
+    }
+    for(int k=first;k<last;++k)
+    {
+        const Triangle& tri = myTriangles[myOrder[k]];
+        for(int n=0;n<3;++n) {
+            const gp_XYZ& p = myPoints[tri.Nodes[n]];
+            for(int i=0;i<3;++i) {
+                node.Min[i] = Min(node.Min[i], p.Coord(i+1));
+                node.Max[i] = Max(node.Max[i], p.Coord(i+1));
+            }
+        }
+        const gp_XYZ& c = centers[myOrder[k]];
+        for(int i=0;i<3;++i) {
+            centerMin[i] = Min(centerMin[i], c.Coord(i+1));
+            centerMax[i] = Max(centerMax[i], c.Coord(i+1));
+        }
+    }
+
+    // split at the median of the longest axis of the centers
+    int axis = 0;
+    for(int i=1;i<3;++i) {
+        if(centerMax[i] - centerMin[i] > centerMax[axis] - centerMin[axis])
+            axis = i;
+    }
+
+    if(last - first <= LEAF_SIZE || centerMax[axis] - centerMin[axis] <= 0) {
+        node.First = first;
+        node.Count = last - first;
+        node.Right = -1;
+        myNodes[index] = node;
+        return index;
+    }
+
+    const int middle = (first + last) / 2;
+    std::nth_element(myOrder.begin() + first, myOrder.begin() + middle, myOrder.begin() + last,
+                     [&](int a, int b) { return centers[a].Coord(axis+1) < centers[b].Coord(axis+1); });
+
+    buildNode(first, middle, centers);
+    node.First = first;
+    node.Count = 0;
+    node.Right = buildNode(middle, last, centers);
+    myNodes[index] = node;
+    return index;
+}
+
+//! Slab test of a node, tmin is where the ray enters the box
+static bool hitBox(const double boxMin[3], const double boxMax[3],
+                   const gp_XYZ& origin, const double inv[3], double tmax, double& tmin)
+{
+    tmin = 0;
+    for(int i=0;i<3;++i)
+    {
+        double t1 = (boxMin[i] - origin.Coord(i+1)) * inv[i];
+        double t2 = (boxMax[i] - origin.Coord(i+1)) * inv[i];
+        if(t1 > t2)
+            std::swap(t1, t2);
+        tmin = Max(tmin, t1);
+        tmax = Min(tmax, t2);
+        if(tmin > tmax)
+            return false;
+    }
+    return true;
+}
+
+bool PickIndex::Pick(const gp_Lin &ray, Result &result, int face) const
+{
+    return pick(ray, result, face, nullptr);
+}
+
+bool PickIndex::Pick(const gp_Lin &ray, Result &result, const QSet<int> &faces) const
+{
+    if(faces.isEmpty())
+        return false;
+    return pick(ray, result, -1, &faces);
+}
+
+bool PickIndex::pick(const gp_Lin &ray, Result &result, int face, const QSet<int> *faces) const
+{
+    if(myNodes.isEmpty())
+        return false;
+
+    const gp_XYZ origin = ray.Location().XYZ();
+    const gp_XYZ dir = ray.Direction().XYZ();
+    double inv[3];
+    for(int i=0;i<3;++i) {
+        const double d = dir.Coord(i+1);
+        inv[i] = Abs(d) > gp::Resolution() ? 1.0 / d : (d < 0 ? -1.0 : 1.0) / gp::Resolution();
+    }
+
+    double best = RealLast();
+    int bestTriangle = -1;
+    double bestU = 0, bestV = 0;
+
+    int stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0)
+    {
+        const int index = stack[--top];
+        const Node& node = myNodes[index];
+        double tmin;
+        if(!hitBox(node.Min, node.Max, origin, inv, best, tmin))
+            continue;
+
+        if(node.Count > 0) {
+            for(int k=node.First;k<node.First+node.Count;++k)
+            {
+                const Triangle& tri = myTriangles[myOrder[k]];
+                const int index = myEntries[tri.Entry].Index;
+                if((face >= 0 && index != face) || (faces && !faces->contains(index)))
+                    continue;
+
+                double t, u, v;
+                if(hitTriangle(tri, origin, dir, t, u, v) && t < best) {
+                    best = t;
+                    bestTriangle = myOrder[k];
+                    bestU = u;
+                    bestV = v;
+                }
+            }
+            continue;
+        }
+
+        // visit the nearer child first, it's pushed last
+        const int left = index + 1;
+        const int right = node.Right;
+        double tLeft, tRight;
+        const bool hitLeft = hitBox(myNodes[left].Min, myNodes[left].Max, origin, inv, best, tLeft);
+        const bool hitRight = hitBox(myNodes[right].Min, myNodes[right].Max, origin, inv, best, tRight);
+        if(hitLeft && hitRight) {
+            stack[top++] = tLeft < tRight ? right : left;
+            stack[top++] = tLeft < tRight ? left : right;
+        }
+        else if(hitLeft) {
+            stack[top++] = left;
+        }
+        else if(hitRight) {
+            stack[top++] = right;
+        }
+    }
+
+    if(bestTriangle < 0)
+        return false;
+
+    const Triangle& tri = myTriangles[bestTriangle];
+    const Entry& entry = myEntries[tri.Entry];
+    result.Face = entry.Index;
+    result.Distance = best;
+    result.Point = gp_Pnt(origin + best * dir);
+
+    // the parameters by the barycentric coordinates, or by projection if the mesh has none
+    if(entry.HasUV) {
+        gp_XY uv = (1 - bestU - bestV) * myUVs[tri.Nodes[0]] + bestU * myUVs[tri.Nodes[1]] + bestV * myUVs[tri.Nodes[2]];
+        result.UV.SetXY(uv);
+    }
+    else {
+        GeomAPI_ProjectPointOnSurf aProjector(result.Point, BRep_Tool::Surface(entry.Face));
+        if(aProjector.NbPoints() > 0) {
+            Standard_Real u, v;
+            aProjector.LowerDistanceParameters(u, v);
+            result.UV.SetCoord(u, v);
+        }
+    }
+
+    // the surface is within the deflection of mesh, far less than the triangle
+    double size = 0;
+    for(int n=0;n<3;++n)
+        size = Max(size, (myPoints[tri.Nodes[n]] - myPoints[tri.Nodes[(n+1)%3]]).Modulus());
+    refine(entry, ray, size, result);
+    return true;
+}
+
+bool PickIndex::hitTriangle(const Triangle &tri, const gp_XYZ &origin, const gp_XYZ &dir,
+                            double &t, double &u, double &v) const
+{
+    // Moller-Trumbore, a small tolerance keeps the rays on the shared edges
+    static const double EPS = 1e-9;
+
+    const gp_XYZ& p0 = myPoints[tri.Nodes[0]];
+    const gp_XYZ e1 = myPoints[tri.Nodes[1]] - p0;
+    const gp_XYZ e2 = myPoints[tri.Nodes[2]] - p0;
+
+    const gp_XYZ pv = dir ^ e2;
+    const double det = e1.Dot(pv);
+    if(Abs(det) <= gp::Resolution())
+        return false;
+
+    const double invDet = 1.0 / det;
+    const gp_XYZ tv = origin - p0;
+    u = tv.Dot(pv) * invDet;
+    if(u < -EPS || u > 1 + EPS)
+        return false;
+
+    const gp_XYZ qv = tv ^ e1;
+    v = dir.Dot(qv) * invDet;
+    if(v < -EPS || u + v > 1 + EPS)
+        return false;
+
+    t = e2.Dot(qv) * invDet;
+    return t >= 0;
+}
+
+void PickIndex::refine(const Entry &entry, const gp_Lin &ray, double limit, Result &result) const
+{
+    // Newton iterations of S(u,v) = origin + t*dir from the hit on the mesh,
+    // the mesh hit is kept if they don't converge
+    static const int MAX_ITERATIONS = 8;
+
+    const gp_XYZ origin = ray.Location().XYZ();
+    const gp_XYZ dir = ray.Direction().XYZ();
+    BRepAdaptor_Surface aSurface(entry.Face);
+
+    double u = result.UV.X(), v = result.UV.Y(), t = result.Distance;
+    for(int i=0;i<MAX_ITERATIONS;++i)
+    {
+        gp_Pnt P;
+        gp_Vec Su, Sv;
+        aSurface.D1(u, v, P, Su, Sv);
+
+        const gp_XYZ F = P.XYZ() - (origin + t * dir);
+        if(F.Modulus() < Precision::Confusion()) {
+            // another sheet of a periodic or a folded surface
+            if(t < 0 || Abs(t - result.Distance) > limit)
+                return;
+            result.Point = P;
+            result.UV.SetCoord(u, v);
+            result.Distance = t;
+            return;
+        }
+
+        // solve [Su Sv -dir] * delta = -F by Cramer's rule
+        const gp_XYZ a = Su.XYZ(), b = Sv.XYZ(), c = -dir;
+        const double det = a.Dot(b ^ c);
+        if(Abs(det) <= gp::Resolution())
+            return;
+
+        const gp_XYZ r = -F;
+        u += r.Dot(b ^ c) / det;
+        v += a.Dot(r ^ c) / det;
+        t += a.Dot(b ^ r) / det;
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef PICKINDEX_H
+#define PICKINDEX_H
+
+#include <QSet>
+#include <QVector>
+
+#include <gp_Lin.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Pnt2d.hxx>
+#include <gp_XY.hxx>
+#include <gp_XYZ.hxx>
+#include <TopoDS_Face.hxx>
+
+//! A bounding volume hierarchy over the triangulation of faces, used to
+//! find the point under the cursor. One query costs log(triangles) box tests,
+//! the hit on the triangle is then refined on the surface of the face.
+class PickIndex
+{
+public:
+    //! The nearest hit of a ray
+    struct Result
+    {
+        Result() : Face(-1), Distance(0) {}
+
+        gp_Pnt Point;            //!< the point on the surface
+        int Face;                //!< the index given to Add()
+        gp_Pnt2d UV;             //!< the parameters of point on the surface
+        Standard_Real Distance;  //!< from the ray origin to the point
+    };
+
+    PickIndex();
+
+    void Clear();
+
+    //! Add the triangulation of face, a face without triangulation is skipped
+    void Add(int index, const TopoDS_Face& face);
+
+    //! Build the hierarchy of the added faces, it must be called before Pick()
+    void Build();
+
+    bool IsEmpty() const {
+        return myNodes.isEmpty();
+    }
+
+    //! Find the nearest hit of ray in its direction,
+    //! only the face of given index is hit if face isn't -1
+    bool Pick(const gp_Lin& ray, Result& result, int face = -1) const;
+    //! Find the nearest hit of ray in its direction among the faces of given indices
+    bool Pick(const gp_Lin& ray, Result& result, const QSet<int>& faces) const;
+
+private:
+    struct Triangle
+    {
+        int Nodes[3];
+        int Entry;  //!< index in myEntries
+    };
+
+    struct Entry
+    {
+        int Index;
+        TopoDS_Face Face;
+        bool HasUV;
+    };
+
+    //! a node covers myOrder[First, First+Count) if Count > 0,
+    //! otherwise its children are the next node and the node Right
+    struct Node
+    {
+        double Min[3];
+        double Max[3];
+        int First;
+        int Count;
+        int Right;
+    };
+
+    //! The nearest hit of the face if face isn't -1, or of the faces if faces isn't null
+    bool pick(const gp_Lin& ray, Result& result, int face, const QSet<int>* faces) const;
+
+    int buildNode(int first, int last, QVector<gp_XYZ>& centers);
+    bool hitTriangle(const Triangle& tri, const gp_XYZ& origin, const gp_XYZ& dir,
+                     double& t, double& u, double& v) const;
+    void refine(const Entry& entry, const gp_Lin& ray, double limit, Result& result) const;
+
+    QVector<Entry> myEntries;
+    QVector<Triangle> myTriangles;
+    QVector<gp_XYZ> myPoints;
+    QVector<gp_XY> myUVs;
+    QVector<int> myOrder;
+    QVector<Node> myNodes;
+};
+
+#endif // PICKINDEX_H
@@ -0,0 +1,83 @@
+#include "PointBuffer.h"
+
+#include <algorithm>
+
+PointBuffer::PointBuffer(const std::list<gp_Pnt> &pts)
+{
+    Reserve(pts.size());
+    for(std::list<gp_Pnt>::const_iterator it=pts.begin();it!=pts.end();++it)
+        Append(*it);
+}
+
+void PointBuffer::Clear()
+{
+    myX.clear();
+    myY.clear();
+    myZ.clear();
+}
+
+void PointBuffer::Reserve(size_t count)
+{
+    // grow by doubling, so appending shape after shape doesn't copy the buffer each time
+    if(count <= myX.capacity())
+        return;
+    count = std::max(count, 2*myX.capacity());
+    myX.reserve(count);
+    myY.reserve(count);
+    myZ.reserve(count);
+}
+
+void PointBuffer::Append(const PointSpan &pts, bool reversed)
+{
+    if(!reversed) {
+        myX.insert(myX.end(), pts.X, pts.X + pts.Count);
+        myY.insert(myY.end(), pts.Y, pts.Y + pts.Count);
+        myZ.insert(myZ.end(), pts.Z, pts.Z + pts.Count);
+        return;
+    }
+
+    Reserve(Size() + pts.Count);
+    for(size_t i=pts.Count;i>0;--i) {
+        myX.push_back(pts.X[i-1]);
+        myY.push_back(pts.Y[i-1]);
+        myZ.push_back(pts.Z[i-1]);
+    }
+}
+
+std::list<gp_Pnt> PointBuffer::ToList() const
+{
+    std::list<gp_Pnt> pts;
+    for(size_t i=0;i<Size();++i)
+        pts.push_back(Value(i));
+    return pts;
+}
+
+Point2dBuffer::Point2dBuffer(const std::list<gp_Pnt2d> &pts)
+{
+    Reserve(pts.size());
+    for(std::list<gp_Pnt2d>::const_iterator it=pts.begin();it!=pts.end();++it)
+        Append(*it);
+}
+
+void Point2dBuffer::Clear()
+{
+    myX.clear();
+    myY.clear();
+}
+
+void Point2dBuffer::Reserve(size_t count)
+{
+    if(count <= myX.capacity())
+        return;
+    count = std::max(count, 2*myX.capacity());
+    myX.reserve(count);
+    myY.reserve(count);
+}
+
+std::list<gp_Pnt2d> Point2dBuffer::ToList() const
+{
+    std::list<gp_Pnt2d> pts;
+    for(size_t i=0;i<Size();++i)
+        pts.push_back(Value(i));
+    return pts;
+}
@@ -0,0 +1,170 @@
+#ifndef POINTBUFFER_H
+#define POINTBUFFER_H
+
+#include <cstddef>
+#include <list>
+#include <vector>
+
+#include <gp_Pnt.hxx>
+#include <gp_Pnt2d.hxx>
+
+//! A view of count points whose coordinates are in separate arrays,
+//! it doesn't own the points and is passed by value
+struct PointSpan
+{
+    PointSpan() : X(nullptr), Y(nullptr), Z(nullptr), Count(0) {}
+    PointSpan(const double* x, const double* y, const double* z, size_t count)
+        : X(x), Y(y), Z(z), Count(count) {}
+
+    size_t Size() const {
+        return Count;
+    }
+    bool IsEmpty() const {
+        return Count == 0;
+    }
+    gp_Pnt Value(size_t i) const {
+        return gp_Pnt(X[i], Y[i], Z[i]);
+    }
+    //! The count points from the point of index from
+    PointSpan Sub(size_t from, size_t count) const {
+        return PointSpan(X + from, Y + from, Z + from, count);
+    }
+
+    const double* X;
+    const double* Y;
+    const double* Z;
+    size_t Count;
+};
+
+//! A view of count 2D points whose coordinates are in separate arrays
+struct Point2dSpan
+{
+    Point2dSpan() : X(nullptr), Y(nullptr), Count(0) {}
+    Point2dSpan(const double* x, const double* y, size_t count)
+        : X(x), Y(y), Count(count) {}
+
+    size_t Size() const {
+        return Count;
+    }
+    bool IsEmpty() const {
+        return Count == 0;
+    }
+    gp_Pnt2d Value(size_t i) const {
+        return gp_Pnt2d(X[i], Y[i]);
+    }
+    Point2dSpan Sub(size_t from, size_t count) const {
+        return Point2dSpan(X + from, Y + from, count);
+    }
+
+    const double* X;
+    const double* Y;
+    size_t Count;
+};
+
+//! Points stored as one contiguous array for each coordinate, so the points
+//! are sampled and fitted without a node for each point, and a loop over one
+//! coordinate reads consecutive memory. A span of it stays valid until the
+//! buffer grows.
+class PointBuffer
+{
+public:
+    PointBuffer() {}
+    explicit PointBuffer(const std::list<gp_Pnt>& pts);
+
+    void Clear();
+    //! Make room for count points, the capacity at least doubles when it grows
+    void Reserve(size_t count);
+
+    void Append(const gp_Pnt& pnt) {
+        myX.push_back(pnt.X());
+        myY.push_back(pnt.Y());
+        myZ.push_back(pnt.Z());
+    }
+    //! Append the points of span, in reversed order if reversed is true
+    void Append(const PointSpan& pts, bool reversed = false);
+
+    size_t Size() const {
+        return myX.size();
+    }
+    bool IsEmpty() const {
+        return myX.empty();
+    }
+    gp_Pnt Value(size_t i) const {
+        return gp_Pnt(myX[i], myY[i], myZ[i]);
+    }
+    gp_Pnt First() const {
+        return Value(0);
+    }
+    gp_Pnt Last() const {
+        return Value(Size() - 1);
+    }
+
+    const double* X() const {
+        return myX.data();
+    }
+    const double* Y() const {
+        return myY.data();
+    }
+    const double* Z() const {
+        return myZ.data();
+    }
+
+    PointSpan Span() const {
+        return PointSpan(myX.data(), myY.data(), myZ.data(), myX.size());
+    }
+    operator PointSpan() const {
+        return Span();
+    }
+
+    std::list<gp_Pnt> ToList() const;
+
+private:
+    std::vector<double> myX;
+    std::vector<double> myY;
+    std::vector<double> myZ;
+};
+
+//! 2D points stored as one contiguous array for each coordinate
+class Point2dBuffer
+{
+public:
+    Point2dBuffer() {}
+    explicit Point2dBuffer(const std::list<gp_Pnt2d>& pts);
+
+    void Clear();
+    void Reserve(size_t count);
+
+    void Append(const gp_Pnt2d& pnt) {
+        myX.push_back(pnt.X());
+        myY.push_back(pnt.Y());
+    }
+    void Append(double x, double y) {
+        myX.push_back(x);
+        myY.push_back(y);
+    }
+
+    size_t Size() const {
+        return myX.size();
+    }
+    bool IsEmpty() const {
+        return myX.empty();
+    }
+    gp_Pnt2d Value(size_t i) const {
+        return gp_Pnt2d(myX[i], myY[i]);
+    }
+
+    Point2dSpan Span() const {
+        return Point2dSpan(myX.data(), myY.data(), myX.size());
+    }
+    operator Point2dSpan() const {
+        return Span();
+    }
+
+    std::list<gp_Pnt2d> ToList() const;
+
+private:
+    std::vector<double> myX;
+    std::vector<double> myY;
+};
+
+#endif // POINTBUFFER_H
@@ -0,0 +1,150 @@
+#include "PointMoments.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POINTMOMENTS_SSE2
+#endif
+
+// the lanes of one register and the operations the kernel needs, double is the scalar fallback
+
+template<typename T>
+struct Lanes;
+
+template<>
+struct Lanes<double>
+{
+    static const size_t Width = 1;
+    static double Load(const double* p) { return *p; }
+    static double Fill(double d) { return d; }
+    static double Sum(double v) { return v; }
+};
+
+#if defined(__AVX2__)
+struct Vector
+{
+    __m256d v;
+};
+inline Vector operator+(const Vector& a, const Vector& b) { Vector r; r.v = _mm256_add_pd(a.v, b.v); return r; }
+inline Vector operator-(const Vector& a, const Vector& b) { Vector r; r.v = _mm256_sub_pd(a.v, b.v); return r; }
+inline Vector operator*(const Vector& a, const Vector& b) { Vector r; r.v = _mm256_mul_pd(a.v, b.v); return r; }
+
+template<>
+struct Lanes<Vector>
+{
+    static const size_t Width = 4;
+    static Vector Load(const double* p) { Vector r; r.v = _mm256_loadu_pd(p); return r; }
+    static Vector Fill(double d) { Vector r; r.v = _mm256_set1_pd(d); return r; }
+    static double Sum(const Vector& a) {
+        double t[4];
+        _mm256_storeu_pd(t, a.v);
+        return (t[0] + t[1]) + (t[2] + t[3]);
+    }
+};
+#elif defined(POINTMOMENTS_SSE2)
+struct Vector
+{
+    __m128d v;
+};
+inline Vector operator+(const Vector& a, const Vector& b) { Vector r; r.v = _mm_add_pd(a.v, b.v); return r; }
+inline Vector operator-(const Vector& a, const Vector& b) { Vector r; r.v = _mm_sub_pd(a.v, b.v); return r; }
+inline Vector operator*(const Vector& a, const Vector& b) { Vector r; r.v = _mm_mul_pd(a.v, b.v); return r; }
+
+template<>
+struct Lanes<Vector>
+{
+    static const size_t Width = 2;
+    static Vector Load(const double* p) { Vector r; r.v = _mm_loadu_pd(p); return r; }
+    static Vector Fill(double d) { Vector r; r.v = _mm_set1_pd(d); return r; }
+    static double Sum(const Vector& a) {
+        double t[2];
+        _mm_storeu_pd(t, a.v);
+        return t[0] + t[1];
+    }
+};
+#else
+typedef double Vector;
+#endif
+
+//! Add the sums of n points relative to origin, the vector loop leaves the
+//! last points to the scalar one. HasZ is false for 2D points
+template<typename T, bool HasZ>
+static void accumulate(const double* x, const double* y, const double* z, size_t n,
+                       const gp_XYZ& origin, double sums[PointMoments::SumCount])
+{
+    typedef Lanes<T> L;
+
+    T acc[PointMoments::SumCount];
+    for(int k=0;k<PointMoments::SumCount;++k)
+        acc[k] = L::Fill(0);
+
+    const T ox = L::Fill(origin.X());
+    const T oy = L::Fill(origin.Y());
+    const T oz = L::Fill(origin.Z());
+    size_t i = 0;
+    for(;i+L::Width<=n;i+=L::Width) {
+        const T dx = L::Load(x+i) - ox;
+        const T dy = L::Load(y+i) - oy;
+        const T xx = dx*dx;
+        const T yy = dy*dy;
+        acc[PointMoments::X] = acc[PointMoments::X] + dx;
+        acc[PointMoments::Y] = acc[PointMoments::Y] + dy;
+        acc[PointMoments::XX] = acc[PointMoments::XX] + xx;
+        acc[PointMoments::YY] = acc[PointMoments::YY] + yy;
+        acc[PointMoments::XY] = acc[PointMoments::XY] + dx*dy;
+        acc[PointMoments::XXX] = acc[PointMoments::XXX] + xx*dx;
+        acc[PointMoments::YYY] = acc[PointMoments::YYY] + yy*dy;
+        acc[PointMoments::XXY] = acc[PointMoments::XXY] + xx*dy;
+        acc[PointMoments::XYY] = acc[PointMoments::XYY] + dx*yy;
+        if(!HasZ)
+            continue;
+
+        const T dz = L::Load(z+i) - oz;
+        const T zz = dz*dz;
+        acc[PointMoments::Z] = acc[PointMoments::Z] + dz;
+        acc[PointMoments::ZZ] = acc[PointMoments::ZZ] + zz;
+        acc[PointMoments::XZ] = acc[PointMoments::XZ] + dx*dz;
+        acc[PointMoments::YZ] = acc[PointMoments::YZ] + dy*dz;
+        acc[PointMoments::ZZZ] = acc[PointMoments::ZZZ] + zz*dz;
+        acc[PointMoments::XXZ] = acc[PointMoments::XXZ] + xx*dz;
+        acc[PointMoments::XZZ] = acc[PointMoments::XZZ] + dx*zz;
+        acc[PointMoments::YYZ] = acc[PointMoments::YYZ] + yy*dz;
+        acc[PointMoments::YZZ] = acc[PointMoments::YZZ] + dy*zz;
+    }
+
+    for(int k=0;k<PointMoments::SumCount;++k)
+        sums[k] += L::Sum(acc[k]);
+    if(L::Width > 1 && i < n)
+        accumulate<double, HasZ>(x+i, y+i, HasZ ? z+i : nullptr, n-i, origin, sums);
+}
+
+PointMoments::PointMoments(const gp_XYZ &origin)
+    : myOrigin(origin)
+{
+    Clear();
+}
+
+void PointMoments::Clear()
+{
+    myCount = 0;
+    std::fill(mySums, mySums + SumCount, 0.0);
+}
+
+void PointMoments::Add(const PointSpan &pts)
+{
+    if(pts.IsEmpty())
+        return;
+    accumulate<Vector, true>(pts.X, pts.Y, pts.Z, pts.Count, myOrigin, mySums);
+    myCount += pts.Count;
+}
+
+void PointMoments::Add(const Point2dSpan &pts)
+{
+    if(pts.IsEmpty())
+        return;
+    accumulate<Vector, false>(pts.X, pts.Y, nullptr, pts.Count, myOrigin, mySums);
+    myCount += pts.Count;
+}
@@ -0,0 +1,51 @@
+#ifndef POINTMOMENTS_H
+#define POINTMOMENTS_H
+
+#include <cstddef>
+
+#include <gp_XYZ.hxx>
+
+#include "PointBuffer.h"
+
+//! The power sums of points up to the third order, which are all the circle
+//! and sphere fits need. The points are taken relative to an origin near
+//! them, such as their first point, so the sums of a part far from the global
+//! origin keep their precision; the fitted center is moved back by the origin.
+//! All the sums are accumulated in one pass over the coordinate arrays, with
+//! AVX2 or SSE2 if the build enables them.
+class PointMoments
+{
+public:
+    enum Sum {
+        X, Y, Z,
+        XX, YY, ZZ, XY, XZ, YZ,
+        XXX, YYY, ZZZ, XXY, XYY, XXZ, XZZ, YYZ, YZZ,
+        SumCount
+    };
+
+    explicit PointMoments(const gp_XYZ& origin = gp_XYZ(0,0,0));
+
+    void Clear();
+
+    void Add(const PointSpan& pts);
+    //! Add the 2D points of span with z = 0
+    void Add(const Point2dSpan& pts);
+
+    size_t Count() const {
+        return myCount;
+    }
+    const gp_XYZ& Origin() const {
+        return myOrigin;
+    }
+    //! The sum of the points relative to the origin
+    double operator[](Sum sum) const {
+        return mySums[sum];
+    }
+
+private:
+    size_t myCount;
+    gp_XYZ myOrigin;
+    double mySums[SumCount];
+};
+
+#endif // POINTMOMENTS_H
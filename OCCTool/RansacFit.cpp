@@ -0,0 +1,672 @@
+#include "RansacFit.h"
+#include "GeneralTools.h"
+#include "pca.h"
+
+#include <OSD_Parallel.hxx>
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
+#include <gp.hxx>
+#include <gp_Ax2.hxx>
+#include <gp_Ax3.hxx>
+
+#include <QAtomicInt>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+// all the points are scored in blocks of this size, one block in each task
+static const size_t BLOCK_SIZE = 65536;
+// rounds of least squares on the inliers, stopped early when the cost doesn't drop
+static const int REFINE_ROUNDS = 3;
+
+static gp_XYZ pointOf(const PointSpan& pts, size_t i)
+{
+    return gp_XYZ(pts.X[i], pts.Y[i], pts.Z[i]);
+}
+
+//! The unit normal of point i, false if it has no direction
+static bool normalOf(const PointSpan& normals, size_t i, gp_XYZ& n)
+{
+    n = pointOf(normals, i);
+    const double aLength = n.Modulus();
+    if(aLength <= gp::Resolution())
+        return false;
+    n /= aLength;
+    return true;
+}
+
+//! True if cross, the cross product of a and b, is too short for a and b to give a direction
+static bool isParallel(const gp_XYZ& cross, const gp_XYZ& a, const gp_XYZ& b)
+{
+    return cross.Modulus() <= 1e-9 * a.Modulus() * b.Modulus();
+}
+
+//! Solve the system of rows x = b, false if it's singular
+static bool solve3(const gp_XYZ rows[3], const double b[3], gp_XYZ& x)
+{
+    const gp_XYZ c0 = rows[1].Crossed(rows[2]);
+    const gp_XYZ c1 = rows[2].Crossed(rows[0]);
+    const gp_XYZ c2 = rows[0].Crossed(rows[1]);
+    const double det = rows[0].Dot(c0);
+    if(std::abs(det) <= 1e-12 * rows[0].Modulus() * rows[1].Modulus() * rows[2].Modulus())
+        return false;
+    x = (c0 * b[0] + c1 * b[1] + c2 * b[2]) / det;
+    return true;
+}
+
+//! The direction all the normals of a cylinder or a cone are at the same angle
+//! to, which is the one of least variance. The normals are turned to the side
+//! of hint first, so normals pointing in and out give the same axis
+static bool normalAxis(const PointSpan& normals, const gp_XYZ& hint, gp_XYZ& axis)
+{
+    PointBuffer aNormals;
+    aNormals.Reserve(normals.Size());
+    for(size_t i=0;i<normals.Count;++i) {
+        gp_XYZ n;
+        if(!normalOf(normals, i, n))
+            continue;
+        aNormals.Append(gp_Pnt(n.Dot(hint) < 0 ? n.Reversed() : n));
+    }
+    PCA pca;
+    pca.Add(aNormals.X(), aNormals.Y(), aNormals.Z(), aNormals.Size());
+    if(!pca.Run())
+        return false;
+    // the normals of a strip along the axis don't turn around it
+    if(pca.GetEigenvalue()[1] <= 1e-8)
+        return false;
+    axis = pca.GetEigenVector()[2].XYZ();
+    if(axis.Dot(hint) < 0)
+        axis.Reverse();
+    return true;
+}
+
+// The models give a model of a minimal sample, the distance of a point to it,
+// and a least squares model of the inliers
+
+struct PlaneModel
+{
+    enum { SampleSize = 3, NeedsNormals = 0 };
+
+    bool Make(const gp_XYZ* p, const gp_XYZ*) {
+        const gp_XYZ a = p[1] - p[0], b = p[2] - p[0];
+        const gp_XYZ n = a.Crossed(b);
+        if(isParallel(n, a, b))
+            return false;
+        Origin = p[0];
+        Normal = n / n.Modulus();
+        return true;
+    }
+    double Distance(const gp_XYZ& p) const {
+        return std::abs((p - Origin).Dot(Normal));
+    }
+    bool Refine(const PointSpan& pts, const PointSpan&) {
+        gp_Pln pln;
+        if(!GeneralTools::FitPlane(pts, pln))
+            return false;
+        Origin = pln.Location().XYZ();
+        Normal = pln.Axis().Direction().XYZ();
+        return true;
+    }
+
+    gp_XYZ Origin;
+    gp_XYZ Normal;
+};
+
+struct SphereModel
+{
+    enum { SampleSize = 4, NeedsNormals = 0 };
+
+    bool Make(const gp_XYZ* p, const gp_XYZ*) {
+        // the center is as far from the 4 points, relative to the first one
+        gp_XYZ rows[3];
+        double b[3];
+        for(int i=0;i<3;++i) {
+            const gp_XYZ d = p[i+1] - p[0];
+            rows[i] = d * 2.0;
+            b[i] = d.SquareModulus();
+        }
+        gp_XYZ c;
+        if(!solve3(rows, b, c))
+            return false;
+        Center = p[0] + c;
+        Radius = c.Modulus();
+        return true;
+    }
+    double Distance(const gp_XYZ& p) const {
+        return std::abs((p - Center).Modulus() - Radius);
+    }
+    bool Refine(const PointSpan& pts, const PointSpan&) {
+        gp_Sphere sphere;
+        if(!GeneralTools::FitSphere(pts, sphere))
+            return false;
+        if(!(sphere.Radius() > 0 && sphere.Radius() < Precision::Infinite()))
+            return false;
+        Center = sphere.Location().XYZ();
+        Radius = sphere.Radius();
+        return true;
+    }
+
+    gp_XYZ Center;
+    double Radius;
+};
+
+struct CircleModel
+{
+    enum { SampleSize = 3, NeedsNormals = 0 };
+
+    bool Make(const gp_XYZ* p, const gp_XYZ*) {
+        const gp_XYZ a = p[1] - p[0], b = p[2] - p[0];
+        const gp_XYZ n = a.Crossed(b);
+        if(isParallel(n, a, b))
+            return false;
+        const double nn = n.SquareModulus();
+        const gp_XYZ c = (b * a.SquareModulus() - a * b.SquareModulus()).Crossed(n) / (2 * nn);
+        Center = p[0] + c;
+        Normal = n / std::sqrt(nn);
+        Radius = c.Modulus();
+        return true;
+    }
+    double Distance(const gp_XYZ& p) const {
+        const gp_XYZ w = p - Center;
+        const double h = w.Dot(Normal);
+        const double rho = (w - Normal * h).Modulus();
+        return std::sqrt(h*h + (rho - Radius)*(rho - Radius));
+    }
+    bool Refine(const PointSpan& pts, const PointSpan&) {
+        gp_Circ cir;
+        if(!GeneralTools::FitCicle(pts, cir))
+            return false;
+        Center = cir.Location().XYZ();
+        Normal = cir.Axis().Direction().XYZ();
+        Radius = cir.Radius();
+        return true;
+    }
+
+    gp_XYZ Center;
+    gp_XYZ Normal;
+    double Radius;
+};
+
+struct CylinderModel
+{
+    enum { SampleSize = 2, NeedsNormals = 1 };
+
+    bool Make(const gp_XYZ* p, const gp_XYZ* n) {
+        const gp_XYZ a = n[0].Crossed(n[1]);
+        if(isParallel(a, n[0], n[1]))
+            return false;
+        Axis = a / a.Modulus();
+        // the axis is where the normal lines meet, seen along the axis
+        const gp_XYZ m0 = n[0] - Axis * n[0].Dot(Axis);
+        const gp_XYZ m1 = n[1] - Axis * n[1].Dot(Axis);
+        const gp_XYZ d = (p[1] - p[0]) - Axis * (p[1] - p[0]).Dot(Axis);
+        const double den = m0.Crossed(m1).Dot(Axis);
+        if(std::abs(den) <= Precision::Confusion() * m0.Modulus() * m1.Modulus())
+            return false;
+        Origin = p[0] + m0 * (d.Crossed(m1).Dot(Axis) / den);
+        Radius = 0.5 * (axisDistance(p[0]) + axisDistance(p[1]));
+        return true;
+    }
+    double Distance(const gp_XYZ& p) const {
+        return std::abs(axisDistance(p) - Radius);
+    }
+    bool Refine(const PointSpan& pts, const PointSpan& normals) {
+        // the axis of the normals, then the circle of the points seen along it
+        gp_XYZ axis;
+        if(!normalAxis(normals, Axis, axis))
+            return false;
+        const gp_Ax2 ax(gp_Pnt(Origin), gp_Dir(axis.X(), axis.Y(), axis.Z()));
+        Point2dBuffer pts2d;
+        GeneralTools::TranslatePntToPnt2d(pts, ax, pts2d);
+        gp_Pnt2d center;
+        Standard_Real radius = 0;
+        if(!GeneralTools::FitCicle(pts2d.Span(), center, radius))
+            return false;
+        Origin = GeneralTools::TranslatePnt2dToPnt(center, ax).XYZ();
+        Axis = axis;
+        Radius = radius;
+        return true;
+    }
+
+    double axisDistance(const gp_XYZ& p) const {
+        const gp_XYZ w = p - Origin;
+        return (w - Axis * w.Dot(Axis)).Modulus();
+    }
+
+    gp_XYZ Origin;
+    gp_XYZ Axis;
+    double Radius;
+};
+
+struct ConeModel
+{
+    enum { SampleSize = 3, NeedsNormals = 1 };
+
+    bool Make(const gp_XYZ* p, const gp_XYZ* n) {
+        // the apex is on the tangent planes of the 3 points, relative to the first one
+        const double b[3] = { 0, n[1].Dot(p[1] - p[0]), n[2].Dot(p[2] - p[0]) };
+        gp_XYZ x;
+        if(!solve3(n, b, x))
+            return false;
+        Apex = p[0] + x;
+        // the normals are at the same angle to the axis
+        const gp_XYZ d1 = n[0] - n[1], d2 = n[0] - n[2];
+        const gp_XYZ a = d1.Crossed(d2);
+        if(isParallel(a, d1, d2))
+            return false;
+        Axis = a / a.Modulus();
+        if((p[0] + p[1] + p[2] - Apex * 3.0).Dot(Axis) < 0)
+            Axis.Reverse();
+        return setAngle(p, SampleSize);
+    }
+    double Distance(const gp_XYZ& p) const {
+        const gp_XYZ v = p - Apex;
+        const double h = v.Dot(Axis);
+        const double rho = (v - Axis * h).Modulus();
+        // behind the apex the nearest point of the cone is the apex
+        if(h * Cos + rho * Sin < 0)
+            return v.Modulus();
+        return std::abs(rho * Cos - h * Sin);
+    }
+    bool Refine(const PointSpan& pts, const PointSpan& normals) {
+        gp_XYZ axis;
+        if(!normalAxis(normals, Axis, axis))
+            return false;
+        // the apex nearest to the tangent planes of all the points
+        gp_XYZ rows[3] = { gp_XYZ(0,0,0), gp_XYZ(0,0,0), gp_XYZ(0,0,0) };
+        double b[3] = { 0, 0, 0 };
+        for(size_t i=0;i<pts.Count;++i) {
+            gp_XYZ n;
+            if(!normalOf(normals, i, n))
+                continue;
+            const double d = n.Dot(pointOf(pts, i) - Apex);
+            for(int k=0;k<3;++k) {
+                rows[k] += n * n.Coord(k+1);
+                b[k] += d * n.Coord(k+1);
+            }
+        }
+        gp_XYZ x;
+        if(!solve3(rows, b, x))
+            return false;
+        ConeModel aRefined = *this;
+        aRefined.Apex = Apex + x;
+        aRefined.Axis = axis;
+        gp_XYZ aSide(0,0,0);
+        for(size_t i=0;i<pts.Count;++i)
+            aSide += pointOf(pts, i) - aRefined.Apex;
+        if(aSide.Dot(axis) < 0)
+            aRefined.Axis.Reverse();
+        std::vector<gp_XYZ> aPoints(pts.Count);
+        for(size_t i=0;i<pts.Count;++i)
+            aPoints[i] = pointOf(pts, i);
+        if(!aRefined.setAngle(aPoints.data(), aPoints.size()))
+            return false;
+        *this = aRefined;
+        return true;
+    }
+
+    //! The mean angle of the points from the axis at the apex
+    bool setAngle(const gp_XYZ* p, size_t count) {
+        double aSum = 0;
+        for(size_t i=0;i<count;++i) {
+            const gp_XYZ v = p[i] - Apex;
+            const double h = v.Dot(Axis);
+            aSum += std::atan2((v - Axis * h).Modulus(), h);
+        }
+        Angle = aSum / count;
+        if(Angle <= 1e-3 || Angle >= M_PI/2 - 1e-3)
+            return false;
+        Cos = std::cos(Angle);
+        Sin = std::sin(Angle);
+        return true;
+    }
+
+    gp_XYZ Apex;
+    gp_XYZ Axis;
+    double Angle;
+    double Cos;
+    double Sin;
+};
+
+//! The MSAC cost of model on the points of subset, or on all the points if
+//! subset is empty. Scoring stops when the cost reaches limit, then it's false
+template<typename Model>
+static bool score(const Model& model, const PointSpan& pts, const std::vector<size_t>& subset,
+                  double threshold, double limit, double& cost, size_t& inliers)
+{
+    const double t2 = threshold * threshold;
+    const size_t n = subset.empty() ? pts.Count : subset.size();
+    cost = 0;
+    inliers = 0;
+    for(size_t k=0;k<n;++k) {
+        const double d = model.Distance(pointOf(pts, subset.empty() ? k : subset[k]));
+        if(d*d < t2) {
+            cost += d*d;
+            ++inliers;
+        }
+        else
+            cost += t2;
+        if(cost >= limit)
+            return false;
+    }
+    return true;
+}
+
+//! The samples needed to draw one of inliers with the confidence
+static int neededIterations(double inlierRatio, int sampleSize, double confidence, int maxIterations)
+{
+    const double aGood = std::pow(inlierRatio, sampleSize);
+    if(aGood <= 0)
+        return maxIterations;
+    if(aGood >= 1)
+        return 1;
+    const double n = std::log(1 - confidence) / std::log(1 - aGood);
+    return n < maxIterations ? std::max(1, int(std::ceil(n))) : maxIterations;
+}
+
+//! Lower value to limit unless another task has lowered it more
+static void lower(QAtomicInt& value, int limit)
+{
+    int aCurrent = value.loadAcquire();
+    while(limit < aCurrent && !value.testAndSetOrdered(aCurrent, limit))
+        aCurrent = value.loadAcquire();
+}
+
+//! The best model drawn by one task
+template<typename Model>
+struct Candidate
+{
+    Candidate() : Cost(std::numeric_limits<double>::max()), IsValid(false) {}
+
+    Model Best;
+    double Cost;
+    bool IsValid;
+};
+
+//! The counters shared by the tasks of a search
+struct SearchState
+{
+    QAtomicInt Drawn;   //!< the samples drawn by all the tasks
+    QAtomicInt Needed;  //!< the samples needed for the confidence, lowered by better models
+};
+
+//! Draw and score samples until the tasks have drawn the needed ones, one task
+//! in each call with its own random generator
+template<typename Model>
+struct SearchFunctor
+{
+    SearchFunctor(const PointSpan& pts, const PointSpan& normals, const std::vector<size_t>& subset,
+                  double threshold, double confidence, int maxIterations, unsigned int seed,
+                  SearchState& state, Candidate<Model>* candidates)
+        : myPts(pts), myNormals(normals), mySubset(subset), myThreshold(threshold),
+          myConfidence(confidence), myMaxIterations(maxIterations), mySeed(seed),
+          myState(state), myCandidates(candidates) {}
+
+    void operator()(int task) const {
+        std::seed_seq aSeq{ mySeed, static_cast<unsigned int>(task) };
+        std::mt19937 aRandom(aSeq);
+        std::uniform_int_distribution<size_t> aPick(0, myPts.Count - 1);
+        const size_t aScored = mySubset.empty() ? myPts.Count : mySubset.size();
+        Candidate<Model>& aBest = myCandidates[task];
+
+        size_t index[Model::SampleSize];
+        gp_XYZ p[Model::SampleSize];
+        gp_XYZ n[Model::SampleSize];
+        while(myState.Drawn.fetchAndAddOrdered(1) < myState.Needed.loadAcquire()) {
+            bool hasNormals = true;
+            for(int k=0;k<Model::SampleSize;++k) {
+                do {
+                    index[k] = aPick(aRandom);
+                } while(std::find(index, index + k, index[k]) != index + k);
+                p[k] = pointOf(myPts, index[k]);
+                if(Model::NeedsNormals && !normalOf(myNormals, index[k], n[k]))
+                    hasNormals = false;
+            }
+
+            Model aModel;
+            double aCost = 0;
+            size_t anInliers = 0;
+            if(!hasNormals || !aModel.Make(p, n) || !score(aModel, myPts, mySubset, myThreshold, aBest.Cost, aCost, anInliers))
+                continue;
+            aBest.Best = aModel;
+            aBest.Cost = aCost;
+            aBest.IsValid = true;
+            lower(myState.Needed, neededIterations(double(anInliers) / aScored, Model::SampleSize,
+                                                   myConfidence, myMaxIterations));
+        }
+    }
+
+    const PointSpan& myPts;
+    const PointSpan& myNormals;
+    const std::vector<size_t>& mySubset;
+    double myThreshold;
+    double myConfidence;
+    int myMaxIterations;
+    unsigned int mySeed;
+    SearchState& myState;
+    Candidate<Model>* myCandidates;
+};
+
+//! The inliers and the squared distances of one block of points
+struct BlockSum
+{
+    BlockSum() : Inliers(0), Squares(0) {}
+
+    size_t Inliers;
+    double Squares;
+};
+
+//! Mark the inliers of model in one block of points in each call
+template<typename Model>
+struct MaskFunctor
+{
+    MaskFunctor(const Model& model, const PointSpan& pts, double threshold, char* mask, BlockSum* sums)
+        : myModel(model), myPts(pts), myThreshold(threshold), myMask(mask), mySums(sums) {}
+
+    void operator()(int block) const {
+        const double t2 = myThreshold * myThreshold;
+        const size_t from = size_t(block) * BLOCK_SIZE;
+        const size_t to = std::min(from + BLOCK_SIZE, myPts.Count);
+        BlockSum aSum;
+        for(size_t i=from;i<to;++i) {
+            const double d = myModel.Distance(pointOf(myPts, i));
+            myMask[i] = d*d < t2 ? 1 : 0;
+            if(myMask[i]) {
+                ++aSum.Inliers;
+                aSum.Squares += d*d;
+            }
+        }
+        mySums[block] = aSum;
+    }
+
+    const Model& myModel;
+    const PointSpan& myPts;
+    double myThreshold;
+    char* myMask;
+    BlockSum* mySums;
+};
+
+//! Mark the inliers of model in all the points and measure the fit
+template<typename Model>
+static void markInliers(const Model& model, const PointSpan& pts, double threshold, bool inParallel,
+                        std::vector<char>& mask, RansacFit::Result& result)
+{
+    mask.resize(pts.Count);
+    const int aBlocks = int((pts.Count + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    std::vector<BlockSum> aSums(aBlocks);
+    OSD_Parallel::For(0, aBlocks, MaskFunctor<Model>(model, pts, threshold, mask.data(), aSums.data()), !inParallel);
+
+    BlockSum aTotal;
+    for(size_t i=0;i<aSums.size();++i) {
+        aTotal.Inliers += aSums[i].Inliers;
+        aTotal.Squares += aSums[i].Squares;
+    }
+    result.InlierCount = aTotal.Inliers;
+    result.Rms = aTotal.Inliers > 0 ? std::sqrt(aTotal.Squares / aTotal.Inliers) : 0;
+    result.Cost = (aTotal.Squares + double(pts.Count - aTotal.Inliers) * threshold * threshold) / pts.Count;
+}
+
+static void gatherInliers(const PointSpan& pts, const std::vector<char>& mask, size_t count, PointBuffer& inliers)
+{
+    inliers.Reserve(count);
+    for(size_t i=0;i<pts.Count;++i) {
+        if(mask[i])
+            inliers.Append(pts.Value(i));
+    }
+}
+
+RansacFit::RansacFit(double threshold)
+    : myThreshold(threshold), myConfidence(0.99), myMaxIterations(10000),
+      myScoreSamples(20000), mySeed(5489u), myParallel(true)
+{
+}
+
+void RansacFit::SetThreshold(double threshold)
+{
+    myThreshold = threshold;
+}
+
+void RansacFit::SetConfidence(double confidence)
+{
+    myConfidence = std::min(std::max(confidence, 0.0), 1.0 - 1e-9);
+}
+
+void RansacFit::SetMaxIterations(int count)
+{
+    myMaxIterations = std::max(1, count);
+}
+
+void RansacFit::SetScoreSamples(size_t count)
+{
+    myScoreSamples = count;
+}
+
+void RansacFit::SetSeed(unsigned int seed)
+{
+    mySeed = seed;
+}
+
+void RansacFit::SetParallel(bool inParallel)
+{
+    myParallel = inParallel;
+}
+
+template<typename Model>
+bool RansacFit::fit(const PointSpan& pts, const PointSpan& normals, Model& model)
+{
+    myResult = Result();
+    myInliers.clear();
+    if(pts.Size() < size_t(Model::SampleSize) || myThreshold <= 0)
+        return false;
+    if(Model::NeedsNormals && normals.Size() != pts.Size())
+        return false;
+
+    // the samples are scored on the same random points in all the tasks,
+    // sorted to read them in the order of memory
+    std::vector<size_t> aSubset;
+    if(myScoreSamples > 0 && pts.Size() > myScoreSamples) {
+        std::mt19937 aRandom(mySeed);
+        std::uniform_int_distribution<size_t> aPick(0, pts.Size() - 1);
+        aSubset.resize(myScoreSamples);
+        for(size_t k=0;k<aSubset.size();++k)
+            aSubset[k] = aPick(aRandom);
+        std::sort(aSubset.begin(), aSubset.end());
+    }
+
+    const int aTasks = myParallel ? std::max(1, OSD_Parallel::NbLogicalProcessors()) : 1;
+    std::vector<Candidate<Model> > aCandidates(aTasks);
+    SearchState aState;
+    aState.Drawn.storeRelease(0);
+    aState.Needed.storeRelease(myMaxIterations);
+    OSD_Parallel::For(0, aTasks, SearchFunctor<Model>(pts, normals, aSubset, myThreshold, myConfidence,
+                                                      myMaxIterations, mySeed, aState, aCandidates.data()),
+                      !myParallel);
+
+    const Candidate<Model>* aBest = nullptr;
+    for(size_t i=0;i<aCandidates.size();++i) {
+        if(aCandidates[i].IsValid && (!aBest || aCandidates[i].Cost < aBest->Cost))
+            aBest = &aCandidates[i];
+    }
+    if(!aBest)
+        return false;
+    model = aBest->Best;
+    const int anIterations = std::min(aState.Drawn.loadAcquire(), aState.Needed.loadAcquire());
+
+    // least squares on the inliers of all the points, kept while the cost drops
+    markInliers(model, pts, myThreshold, myParallel, myInliers, myResult);
+    for(int aRound=0;aRound<REFINE_ROUNDS;++aRound) {
+        if(myResult.InlierCount < size_t(Model::SampleSize))
+            break;
+        PointBuffer aPts, aNormals;
+        gatherInliers(pts, myInliers, myResult.InlierCount, aPts);
+        if(Model::NeedsNormals)
+            gatherInliers(normals, myInliers, myResult.InlierCount, aNormals);
+
+        Model aRefined = model;
+        try {
+            if(!aRefined.Refine(aPts.Span(), aNormals.Span()))
+                break;
+        }
+        catch(const Standard_Failure&) {
+            // the inliers are degenerate, such as a direction of null length
+            break;
+        }
+        std::vector<char> aMask;
+        Result aResult;
+        markInliers(aRefined, pts, myThreshold, myParallel, aMask, aResult);
+        if(aResult.Cost >= myResult.Cost)
+            break;
+        model = aRefined;
+        myInliers.swap(aMask);
+        myResult = aResult;
+    }
+    myResult.Iterations = anIterations;
+    return true;
+}
+
+bool RansacFit::FitPlane(const PointSpan &pts, gp_Pln &pln)
+{
+    PlaneModel aModel;
+    if(!fit(pts, PointSpan(), aModel))
+        return false;
+    pln = gp_Pln(gp_Pnt(aModel.Origin), gp_Dir(aModel.Normal));
+    return true;
+}
+
+bool RansacFit::FitSphere(const PointSpan &pts, gp_Sphere &sphere)
+{
+    SphereModel aModel;
+    if(!fit(pts, PointSpan(), aModel))
+        return false;
+    sphere = gp_Sphere(gp_Ax3(gp_Pnt(aModel.Center), gp::DZ()), aModel.Radius);
+    return true;
+}
+
+bool RansacFit::FitCicle(const PointSpan &pts, gp_Circ &cir)
+{
+    CircleModel aModel;
+    if(!fit(pts, PointSpan(), aModel))
+        return false;
+    cir = gp_Circ(gp_Ax2(gp_Pnt(aModel.Center), gp_Dir(aModel.Normal)), aModel.Radius);
+    return true;
+}
+
+bool RansacFit::FitCylinder(const PointSpan &pts, const PointSpan &normals, gp_Cylinder &cylinder)
+{
+    CylinderModel aModel;
+    if(!fit(pts, normals, aModel))
+        return false;
+    cylinder = gp_Cylinder(gp_Ax3(gp_Pnt(aModel.Origin), gp_Dir(aModel.Axis)), aModel.Radius);
+    return true;
+}
+
+bool RansacFit::FitCone(const PointSpan &pts, const PointSpan &normals, gp_Cone &cone)
+{
+    ConeModel aModel;
+    if(!fit(pts, normals, aModel))
+        return false;
+    cone = gp_Cone(gp_Ax3(gp_Pnt(aModel.Apex), gp_Dir(aModel.Axis)), aModel.Angle, 0.0);
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef RANSACFIT_H
+#define RANSACFIT_H
+
+#include <cstddef>
+#include <vector>
+
+#include <gp_Circ.hxx>
+#include <gp_Cone.hxx>
+#include <gp_Cylinder.hxx>
+#include <gp_Pln.hxx>
+#include <gp_Sphere.hxx>
+
+#include "PointBuffer.h"
+
+//! Robust fitting of primitives to measured points with outliers, such as the
+//! points of a CMM or a scanner. Models of random minimal samples are scored
+//! by the MSAC cost, where a point costs its squared distance up to the
+//! threshold. The samples are drawn on all the cores, each task with its own
+//! random generator, until the best model has been drawn with the confidence.
+//! The best model is then refined by least squares on its inliers.
+//! Cylinders and cones need the normals of the points, as their minimal
+//! samples are 2 and 3 points with their normals.
+class RansacFit
+{
+public:
+    //! The quality of the last fit
+    struct Result
+    {
+        Result() : InlierCount(0), Rms(0), Cost(0), Iterations(0) {}
+
+        size_t InlierCount;  //!< the points within the threshold of the model
+        double Rms;          //!< root mean square distance of the inliers
+        double Cost;         //!< the MSAC cost of the points divided by their count
+        int Iterations;      //!< the samples drawn
+    };
+
+    //! threshold is the largest distance of an inlier from the model
+    explicit RansacFit(double threshold);
+
+    void SetThreshold(double threshold);
+    //! The probability to draw a sample of inliers at least once, 0.99 by default
+    void SetConfidence(double confidence);
+    //! The most samples drawn, 10000 by default
+    void SetMaxIterations(int count);
+    //! The samples are scored on a random subset of count points, the inliers
+    //! and the refinement use all the points. 20000 by default, 0 scores on all
+    void SetScoreSamples(size_t count);
+    //! The random generators of the tasks are seeded from seed
+    void SetSeed(unsigned int seed);
+    void SetParallel(bool inParallel);
+
+    bool FitPlane(const PointSpan& pts, gp_Pln& pln);
+    bool FitSphere(const PointSpan& pts, gp_Sphere& sphere);
+    bool FitCicle(const PointSpan& pts, gp_Circ& cir);
+    //! normals has a normal for each point, their orientation doesn't matter.
+    //! The normals are normalized, the points with a null normal are left out
+    //! of the samples
+    bool FitCylinder(const PointSpan& pts, const PointSpan& normals, gp_Cylinder& cylinder);
+    //! normals has a normal for each point, all pointing out or all in,
+    //! the cone is placed at its apex. The normals are normalized as for
+    //! FitCylinder
+    bool FitCone(const PointSpan& pts, const PointSpan& normals, gp_Cone& cone);
+
+    const Result& GetResult() const {
+        return myResult;
+    }
+    //! 1 for the inliers of the last fit, in the order of the points
+    const std::vector<char>& Inliers() const {
+        return myInliers;
+    }
+
+private:
+    template<typename Model>
+    bool fit(const PointSpan& pts, const PointSpan& normals, Model& model);
+
+    double myThreshold;
+    double myConfidence;
+    int myMaxIterations;
+    size_t myScoreSamples;
+    unsigned int mySeed;
+    bool myParallel;
+
+    Result myResult;
+    std::vector<char> myInliers;
+};
+
+#endif // RANSACFIT_H
@@ -0,0 +1,162 @@
+#include "ShapeFeature.h"
+
+#include <BRep_Tool.hxx>
+#include <GeomAdaptor_Surface.hxx>
+#include <TopoDS.hxx>
+#include <gp_Cylinder.hxx>
+#include <gp_Elips.hxx>
+
+#include "GeneralTools.h"
+
+ShapeFeature::ShapeFeature()
+    : myKind(Unknown),
+      myRadius(0),
+      myHasPlane(false),
+      myHasAxis(false),
+      myHasCone(false),
+      myHasLine(false),
+      myHasCircle(false),
+      myHasCenter(false)
+{
+}
+
+ShapeFeature ShapeFeature::Classify(const TopoDS_Shape &shape)
+{
+    ShapeFeature feature;
+    if(shape.IsNull())
+        return feature;
+
+    if(shape.ShapeType() == TopAbs_FACE)
+        feature.classifyFace(shape);
+    else if(shape.ShapeType() == TopAbs_EDGE)
+        feature.classifyEdge(shape);
+    else if(shape.ShapeType() == TopAbs_SHELL && GeneralTools::GetPlane(shape, feature.myPlane)) {
+        // GeneralTools::GetPlane takes the first face of shell
+        feature.myHasPlane = true;
+        feature.myKind = Plane;
+    }
+    return feature;
+}
+
+bool ShapeFeature::GetPlane(gp_Pln &pln) const
+{
+    if(myHasPlane)
+        pln = myPlane;
+    return myHasPlane;
+}
+
+bool ShapeFeature::GetAxis(gp_Ax1 &axis) const
+{
+    if(myHasAxis)
+        axis = myAxis;
+    return myHasAxis;
+}
+
+bool ShapeFeature::GetCone(gp_Cone &cone) const
+{
+    if(myHasCone)
+        cone = myCone;
+    return myHasCone;
+}
+
+bool ShapeFeature::GetLine(gp_Lin &lin) const
+{
+    if(myHasLine)
+        lin = myLine;
+    return myHasLine;
+}
+
+bool ShapeFeature::GetCircle(gp_Circ &circ) const
+{
+    if(myHasCircle)
+        circ = myCircle;
+    return myHasCircle;
+}
+
+bool ShapeFeature::GetCenter(gp_Ax2 &center) const
+{
+    if(myHasCenter)
+        center = myCenter;
+    return myHasCenter;
+}
+
+void ShapeFeature::classifyFace(const TopoDS_Shape &shape)
+{
+    Handle(Geom_Surface) aSurface = BRep_Tool::Surface(TopoDS::Face(shape));
+    if(aSurface.IsNull())
+        return;
+
+    myHasPlane = GeneralTools::GetPlane(shape, myPlane);
+
+    // the same order as GeneralTools::GetAxis
+    gp_Cylinder aCylinder;
+    myHasCone = GeneralTools::GetCone(aSurface, myCone);
+    bool hasCylinder = !myHasCone && GeneralTools::GetCylinder(aSurface, aCylinder);
+    GeomAdaptor_Surface sSurface(aSurface);
+    if(myHasCone) {
+        myAxis = myCone.Axis();
+        myHasAxis = true;
+    }
+    else if(hasCylinder) {
+        myAxis = aCylinder.Axis();
+        myHasAxis = true;
+    }
+    else if(sSurface.GetType() == GeomAbs_SurfaceOfRevolution) {
+        myAxis = sSurface.AxeOfRevolution();
+        myHasAxis = true;
+    }
+
+    if(myHasPlane) {
+        myKind = Plane;
+    }
+    else if(myHasCone) {
+        myKind = Cone;
+        myRadius = myCone.RefRadius();
+    }
+    else if(hasCylinder) {
+        myKind = Cylinder;
+        myRadius = aCylinder.Radius();
+    }
+    else if(sSurface.GetType() == GeomAbs_Sphere) {
+        myKind = Sphere;
+        myRadius = sSurface.Sphere().Radius();
+    }
+    else if(myHasAxis) {
+        myKind = Revolution;
+    }
+}
+
+void ShapeFeature::classifyEdge(const TopoDS_Shape &shape)
+{
+    Standard_Real first, last;
+    Handle(Geom_Curve) aCurve = BRep_Tool::Curve(TopoDS::Edge(shape), first, last);
+    if(aCurve.IsNull())
+        return;
+
+    myHasLine = GeneralTools::GetLine(aCurve, myLine);
+    myHasCircle = GeneralTools::GetCicle(aCurve, myCircle);
+
+    // the same order as GeneralTools::GetCenter
+    gp_Elips anElips;
+    bool hasElips = !myHasCircle && GeneralTools::GetEllips(aCurve, anElips);
+    if(myHasCircle) {
+        myCenter = myCircle.Position();
+        myHasCenter = true;
+    }
+    else if(hasElips) {
+        myCenter = anElips.Position();
+        myHasCenter = true;
+    }
+
+    if(myHasLine) {
+        myKind = Line;
+    }
+    else if(myHasCircle) {
+        myKind = Circle;
+        myRadius = myCircle.Radius();
+    }
+    else if(hasElips) {
+        myKind = Ellipse;
+        myRadius = anElips.MajorRadius();
+    }
+}
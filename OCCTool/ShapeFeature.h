@@ -0,0 +1,83 @@
+#ifndef SHAPEFEATURE_H
+#define SHAPEFEATURE_H
+
+#include <gp_Ax1.hxx>
+#include <gp_Ax2.hxx>
+#include <gp_Circ.hxx>
+#include <gp_Cone.hxx>
+#include <gp_Lin.hxx>
+#include <gp_Pln.hxx>
+#include <TopoDS_Shape.hxx>
+
+//! The kind and the parameters of a face or an edge.
+//! The getters give the same results as the matching functions of
+//! GeneralTools, so the classification runs only once for a shape.
+class ShapeFeature
+{
+public:
+    enum Kind {
+        Unknown = 0,
+        Plane,
+        Cylinder,
+        Cone,
+        Sphere,
+        Revolution,
+        Line,
+        Circle,
+        Ellipse
+    };
+
+    ShapeFeature();
+
+    //! Classify a face or an edge, a shell is only checked as a plane,
+    //! the other shapes are Unknown
+    static ShapeFeature Classify(const TopoDS_Shape& shape);
+
+    Kind GetKind() const {
+        return myKind;
+    }
+
+    //! Radius of cylinder, sphere, circle, reference radius of cone
+    //! and major radius of ellipse, 0 for the others
+    Standard_Real Radius() const {
+        return myRadius;
+    }
+
+    //! The same as GeneralTools::GetPlane
+    bool GetPlane(gp_Pln& pln) const;
+    //! Axis of cone, cylinder or surface of revolution, the same as GeneralTools::GetAxis
+    bool GetAxis(gp_Ax1& axis) const;
+    //! The same as GeneralTools::GetCone
+    bool GetCone(gp_Cone& cone) const;
+    //! The same as GeneralTools::GetLine
+    bool GetLine(gp_Lin& lin) const;
+    //! The same as GeneralTools::GetCicle
+    bool GetCircle(gp_Circ& circ) const;
+    //! Position of circle or ellipse, the same as GeneralTools::GetCenter
+    bool GetCenter(gp_Ax2& center) const;
+
+private:
+    void classifyFace(const TopoDS_Shape& shape);
+    void classifyEdge(const TopoDS_Shape& shape);
+
+    Kind myKind;
+    Standard_Real myRadius;
+
+    // a face may be a plane and a surface of revolution at the same time,
+    // and an edge may be a line and a circle after fitting, so keep them all
+    bool myHasPlane;
+    bool myHasAxis;
+    bool myHasCone;
+    bool myHasLine;
+    bool myHasCircle;
+    bool myHasCenter;
+
+    gp_Pln myPlane;
+    gp_Ax1 myAxis;
+    gp_Cone myCone;
+    gp_Lin myLine;
+    gp_Circ myCircle;
+    gp_Ax2 myCenter;
+};
+
+#endif // SHAPEFEATURE_H
@@ -0,0 +1,236 @@
+#include "ViewProfiler.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <Graphic3d_CView.hxx>
+#include <Standard_Version.hxx>
+#if OCC_VERSION_HEX >= 0x070400
+#include <Graphic3d_FrameStats.hxx>
+#endif
+
+// a frame of 60Hz is 16.7ms, of 30Hz is 33.3ms
+const double ViewProfiler::BucketBounds[ViewProfiler::BucketCount - 1] = {
+    0.5, 1, 2, 4, 8, 16.7, 33.3, 50, 100, 200, 500
+};
+
+ViewProfiler::Histogram::Histogram()
+    : Count(0),
+      Sum(0),
+      Min(0),
+      Max(0)
+{
+    for(int i=0;i<BucketCount;++i)
+        Buckets[i] = 0;
+}
+
+void ViewProfiler::Histogram::Add(double ms)
+{
+    int bucket = 0;
+    while(bucket < BucketCount - 1 && ms > BucketBounds[bucket])
+        ++bucket;
+    ++Buckets[bucket];
+
+    Min = Count == 0 ? ms : qMin(Min, ms);
+    Max = Count == 0 ? ms : qMax(Max, ms);
+    Sum += ms;
+    ++Count;
+}
+
+double ViewProfiler::Histogram::Percentile(double fraction) const
+{
+    if(Count == 0)
+        return 0;
+
+    const double rank = fraction * Count;
+    quint64 below = 0;
+    for(int i=0;i<BucketCount - 1;++i) {
+        below += Buckets[i];
+        if(below >= rank)
+            return qMin(BucketBounds[i], Max);
+    }
+    return Max;
+}
+
+ViewProfiler::ViewProfiler()
+    : myEnabled(false),
+      myRateFrames(0),
+      myFrameRate(0)
+{
+}
+
+void ViewProfiler::SetEnabled(bool enabled, const Handle(V3d_View) &view)
+{
+    myEnabled = enabled;
+    myRateClock.invalidate();
+    myRateFrames = 0;
+    myFrameRate = 0;
+    if(view.IsNull())
+        return;
+
+    // the counters of OCCT are averaged over the interval, keep it short
+    Graphic3d_RenderingParams& params = view->ChangeRenderingParams();
+    params.CollectedStats = enabled ? Graphic3d_RenderingParams::PerfCounters(
+                                          Graphic3d_RenderingParams::PerfCounters_FrameRate
+                                          | Graphic3d_RenderingParams::PerfCounters_Structures
+                                          | Graphic3d_RenderingParams::PerfCounters_Groups
+                                          | Graphic3d_RenderingParams::PerfCounters_Triangles)
+                                    : Graphic3d_RenderingParams::PerfCounters_NONE;
+    params.StatsUpdateInterval = 0.25f;
+}
+
+void ViewProfiler::Reset()
+{
+    for(int i=0;i<EventCount;++i)
+        myHistograms[i] = Histogram();
+    myCounters = FrameCounters();
+    myRateClock.invalidate();
+    myRateFrames = 0;
+    myFrameRate = 0;
+}
+
+void ViewProfiler::AddSample(ViewProfiler::Event event, double ms)
+{
+    if(myEnabled)
+        myHistograms[event].Add(ms);
+}
+
+void ViewProfiler::AddFrame(double ms, const Handle(V3d_View) &view)
+{
+    if(!myEnabled)
+        return;
+    myHistograms[Frame].Add(ms);
+
+    ++myRateFrames;
+    if(!myRateClock.isValid()) {
+        myRateClock.start();
+        myRateFrames = 0;
+    }
+    else if(myRateClock.elapsed() >= 1000) {
+        myFrameRate = myRateFrames * 1000.0 / myRateClock.elapsed();
+        myRateClock.start();
+        myRateFrames = 0;
+    }
+
+#if OCC_VERSION_HEX >= 0x070400
+    if(view.IsNull() || view->View()->FrameStats().IsNull())
+        return;
+    const Graphic3d_FrameStatsData& aData = view->View()->FrameStats()->LastDataFrame();
+    myCounters.Structures = aData.CounterValue(Graphic3d_FrameStatsCounter_NbStructsNotCulled);
+    myCounters.Groups = aData.CounterValue(Graphic3d_FrameStatsCounter_NbGroupsNotCulled);
+    myCounters.Triangles = aData.CounterValue(Graphic3d_FrameStatsCounter_NbTrianglesNotCulled);
+#else
+    (void)view;
+#endif
+}
+
+const char *ViewProfiler::EventName(ViewProfiler::Event event)
+{
+    switch(event) {
+    case Frame:  return "frame";
+    case Hover:  return "hover";
+    case Select: return "select";
+    case Drag:   return "drag";
+    case Zoom:   return "zoom";
+    default:     return "";
+    }
+}
+
+QString ViewProfiler::Summary() const
+{
+    QString text;
+    QTextStream stream(&text);
+    stream.setRealNumberNotation(QTextStream::FixedNotation);
+    stream.setRealNumberPrecision(1);
+
+    stream << myFrameRate << " fps  " << myCounters.Structures << " structures  "
+           << myCounters.Groups << " groups  " << myCounters.Triangles << " triangles";
+    for(int i=0;i<EventCount;++i) {
+        const Histogram& h = myHistograms[i];
+        if(h.Count == 0)
+            continue;
+        stream << "\n" << EventName(Event(i)) << "  n " << h.Count << "  mean " << h.Mean()
+               << "  p95 " << h.Percentile(0.95) << "  max " << h.Max << " ms";
+    }
+    return text;
+}
+
+bool ViewProfiler::Write(const QString &fileName, QString &error) const
+{
+    QSaveFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly)) {
+        error = QObject::tr("Can't write the file %1").arg(fileName);
+        return false;
+    }
+
+    const QByteArray data = fileName.endsWith(".json", Qt::CaseInsensitive) ? toJson() : toCsv().toUtf8();
+    if(file.write(data) != data.size() || !file.commit()) {
+        error = QObject::tr("Can't write the file %1").arg(fileName);
+        return false;
+    }
+    return true;
+}
+
+QString ViewProfiler::toCsv() const
+{
+    QString text;
+    QTextStream stream(&text);
+
+    // one row for each event, the buckets are named by their upper bounds
+    stream << "event,count,mean_ms,min_ms,max_ms,p50_ms,p95_ms,p99_ms";
+    for(int i=0;i<BucketCount - 1;++i)
+        stream << ",le_" << BucketBounds[i];
+    stream << ",inf\n";
+
+    for(int i=0;i<EventCount;++i) {
+        const Histogram& h = myHistograms[i];
+        stream << EventName(Event(i)) << "," << h.Count << "," << h.Mean() << "," << h.Min << "," << h.Max << ","
+               << h.Percentile(0.5) << "," << h.Percentile(0.95) << "," << h.Percentile(0.99);
+        for(int k=0;k<BucketCount;++k)
+            stream << "," << h.Buckets[k];
+        stream << "\n";
+    }
+    return text;
+}
+
+QByteArray ViewProfiler::toJson() const
+{
+    QJsonObject counters;
+    counters["frameRate"] = myFrameRate;
+    counters["structures"] = double(myCounters.Structures);
+    counters["groups"] = double(myCounters.Groups);
+    counters["triangles"] = double(myCounters.Triangles);
+
+    QJsonArray bounds;
+    for(int i=0;i<BucketCount - 1;++i)
+        bounds.append(BucketBounds[i]);
+
+    QJsonObject events;
+    for(int i=0;i<EventCount;++i) {
+        const Histogram& h = myHistograms[i];
+        QJsonArray buckets;
+        for(int k=0;k<BucketCount;++k)
+            buckets.append(double(h.Buckets[k]));
+
+        QJsonObject event;
+        event["count"] = double(h.Count);
+        event["mean"] = h.Mean();
+        event["min"] = h.Min;
+        event["max"] = h.Max;
+        event["p50"] = h.Percentile(0.5);
+        event["p95"] = h.Percentile(0.95);
+        event["p99"] = h.Percentile(0.99);
+        event["buckets"] = buckets;
+        events[EventName(Event(i))] = event;
+    }
+
+    QJsonObject root;
+    root["counters"] = counters;
+    root["bucketBounds"] = bounds;
+    root["events"] = events;
+    return QJsonDocument(root).toJson();
+}
@@ -0,0 +1,106 @@
+#ifndef VIEWPROFILER_H
+#define VIEWPROFILER_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <V3d_View.hxx>
+
+//! Frame times and interaction latencies of a view, kept as histograms.
+//! A latency runs from the arrival of the input event until the redraw it
+//! caused returns, so it includes the detection, the drawing and the swap.
+//! The totals are written as CSV or JSON to compare them with a budget.
+class ViewProfiler
+{
+public:
+    enum Event {
+        Frame = 0,  //!< drawing of a frame, issued by the widget
+        Hover,      //!< MoveTo of a cursor position
+        Select,     //!< click selection
+        Drag,       //!< a move of the dragged labels or the manipulator
+        Zoom,       //!< a wheel step
+        EventCount
+    };
+
+    //! The upper bound of each bucket in milliseconds, the last one is unbounded
+    enum { BucketCount = 12 };
+    static const double BucketBounds[BucketCount - 1];
+
+    struct Histogram
+    {
+        Histogram();
+
+        void Add(double ms);
+        //! Upper bound of the bucket holding the given fraction of the samples,
+        //! the maximum if it is in the last bucket
+        double Percentile(double fraction) const;
+        double Mean() const {
+            return Count > 0 ? Sum / Count : 0;
+        }
+
+        quint64 Buckets[BucketCount];
+        quint64 Count;
+        double Sum;
+        double Min;
+        double Max;
+    };
+
+    //! OCCT counters of the latest frame
+    struct FrameCounters
+    {
+        FrameCounters() : Structures(0), Groups(0), Triangles(0) {}
+
+        quint64 Structures;
+        quint64 Groups;
+        quint64 Triangles;
+    };
+
+    ViewProfiler();
+
+    //! Nothing is recorded until it is enabled, it also turns on the
+    //! counters of the view which cost a little time for each frame
+    void SetEnabled(bool enabled, const Handle(V3d_View)& view);
+    bool IsEnabled() const {
+        return myEnabled;
+    }
+
+    void Reset();
+
+    void AddSample(Event event, double ms);
+    //! Record a frame drawn in ms and read the counters of view
+    void AddFrame(double ms, const Handle(V3d_View)& view);
+
+    const Histogram& GetHistogram(Event event) const {
+        return myHistograms[event];
+    }
+    const FrameCounters& Counters() const {
+        return myCounters;
+    }
+
+    //! Frames per second over the last second
+    double FrameRate() const {
+        return myFrameRate;
+    }
+
+    static const char* EventName(Event event);
+
+    //! A few lines for the overlay
+    QString Summary() const;
+
+    //! Write CSV, or JSON if fileName ends with .json
+    bool Write(const QString& fileName, QString& error) const;
+
+private:
+    QString toCsv() const;
+    QByteArray toJson() const;
+
+    bool myEnabled;
+    Histogram myHistograms[EventCount];
+    FrameCounters myCounters;
+
+    QElapsedTimer myRateClock;
+    int myRateFrames;
+    double myFrameRate;
+};
+
+#endif // VIEWPROFILER_H
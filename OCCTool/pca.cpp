@@ -1,91 +1,172 @@
 ﻿#include "pca.h"
 #include <math_Matrix.hxx>
-#include "Standard_Stream.hxx"
 #include <math_Vector.hxx>
 #include <math_Jacobi.hxx>
-#include "math_Jacobi.hxx"
+
+#include <algorithm>
+
+// the chunks are reduced in blocks, which stay in the cache for the second pass
+static const size_t BLOCK_SIZE = 4096;
+
+//! The mean and co-moments of n points by two passes over a block: the mean is
+//! summed relative to the first point, the co-moments are corrected by the
+//! rounding error of the mean
+template<typename Points>
+static void reduceBlock(const Points& pts, size_t from, size_t n, gp_XYZ& mean, double m2[6])
+{
+    const gp_XYZ shift = pts(from);
+    gp_XYZ sum(0,0,0);
+    for(size_t i=from;i<from+n;i++)
+        sum += pts(i) - shift;
+    mean = shift + sum / double(n);
+
+    double sx=0,sy=0,sz=0;
+    double xx=0,xy=0,xz=0,yy=0,yz=0,zz=0;
+    for(size_t i=from;i<from+n;i++)
+    {
+        const gp_XYZ d = pts(i) - mean;
+        sx+=d.X(); sy+=d.Y(); sz+=d.Z();
+        xx+=d.X()*d.X(); xy+=d.X()*d.Y(); xz+=d.X()*d.Z();
+        yy+=d.Y()*d.Y(); yz+=d.Y()*d.Z(); zz+=d.Z()*d.Z();
+    }
+    m2[0]=xx-sx*sx/n; m2[1]=xy-sx*sy/n; m2[2]=xz-sx*sz/n;
+    m2[3]=yy-sy*sy/n; m2[4]=yz-sy*sz/n; m2[5]=zz-sz*sz/n;
+}
+
+struct PntArray
+{
+    const gp_Pnt* pnts;
+    gp_XYZ operator()(size_t i) const { return pnts[i].XYZ(); }
+};
+
+struct CoordArrays
+{
+    const double* x;
+    const double* y;
+    const double* z;
+    gp_XYZ operator()(size_t i) const { return gp_XYZ(x[i],y[i],z[i]); }
+};
+
+PCA::PCA()
+{
+    Clear();
+    _eigenValues.reserve(3);
+    _eigenVectors.reserve(3);
+}
+
 PCA::PCA(const std::list<gp_Pnt>& aPts)
 {
-    _pPtsList=&aPts;
+    Clear();
     _eigenValues.reserve(3);
     _eigenVectors.reserve(3);
+    for (std::list<gp_Pnt>::const_iterator it=aPts.begin();it!=aPts.end();it++)
+        Add(*it);
 }
+
+void PCA::Clear()
+{
+    _count=0;
+    _mean.SetCoord(0,0,0);
+    std::fill(_m2,_m2+6,0.0);
+}
+
+void PCA::Add(const gp_Pnt& aPnt)
+{//Welford: 均值和协方差逐点更新
+    _count++;
+    const gp_XYZ d = aPnt.XYZ() - _mean;
+    _mean += d / double(_count);
+    const gp_XYZ e = aPnt.XYZ() - _mean;
+    _m2[0]+=d.X()*e.X(); _m2[1]+=d.X()*e.Y(); _m2[2]+=d.X()*e.Z();
+    _m2[3]+=d.Y()*e.Y(); _m2[4]+=d.Y()*e.Z(); _m2[5]+=d.Z()*e.Z();
+}
+
+void PCA::Add(const gp_Pnt* aPnts, size_t count)
+{
+    const PntArray pts = { aPnts };
+    for(size_t from=0;from<count;from+=BLOCK_SIZE)
+    {
+        const size_t n = std::min(BLOCK_SIZE, count-from);
+        gp_XYZ mean;
+        double m2[6];
+        reduceBlock(pts, from, n, mean, m2);
+        merge(n, mean, m2);
+    }
+}
+
+void PCA::Add(const double* x, const double* y, const double* z, size_t count)
+{
+    const CoordArrays pts = { x, y, z };
+    for(size_t from=0;from<count;from+=BLOCK_SIZE)
+    {
+        const size_t n = std::min(BLOCK_SIZE, count-from);
+        gp_XYZ mean;
+        double m2[6];
+        reduceBlock(pts, from, n, mean, m2);
+        merge(n, mean, m2);
+    }
+}
+
+void PCA::Merge(const PCA& other)
+{
+    merge(other._count, other._mean, other._m2);
+}
+
+void PCA::merge(size_t n, const gp_XYZ& mean, const double m2[6])
+{//两组的均值和协方差合并(Chan)
+    if(n==0)
+        return;
+    if(_count==0)
+    {
+        _count=n;
+        _mean=mean;
+        std::copy(m2,m2+6,_m2);
+        return;
+    }
+    const double na=double(_count), nb=double(n), nt=na+nb;
+    const gp_XYZ d = mean - _mean;
+    const double w = na*nb/nt;
+    _m2[0]+=m2[0]+d.X()*d.X()*w; _m2[1]+=m2[1]+d.X()*d.Y()*w; _m2[2]+=m2[2]+d.X()*d.Z()*w;
+    _m2[3]+=m2[3]+d.Y()*d.Y()*w; _m2[4]+=m2[4]+d.Y()*d.Z()*w; _m2[5]+=m2[5]+d.Z()*d.Z()*w;
+    _mean += d * (nb/nt);
+    _count += n;
+}
+
 bool PCA::Run()
 {//进行pca分析
-    if(_pPtsList==NULL)return false;
-    int nPts=_pPtsList->size();
-    std::list<gp_Pnt> newdata;
-    {//算出xyz的平均值,生成新的数据
-        float sumX,sumY,sumZ;
-        sumX=sumY=sumZ=0;
-        for (std::list<gp_Pnt>::const_iterator it=_pPtsList->begin();it!=_pPtsList->end();it++)
-        {
-            sumX+=(*it).X();
-            sumY+=(*it).Y();
-            sumZ+=(*it).Z();
-        }
-        //求平均值
-        sumX/=nPts;
-        sumY/=nPts;
-        sumZ/=nPts;
-        _ptCenter.SetCoord(sumX,sumY,sumZ);//中心点
-
-        gp_Pnt pttmp;
-        for(std::list<gp_Pnt>::const_iterator it=_pPtsList->begin();it!=_pPtsList->end();it++)
-        {//每个点减去平均值
-            pttmp.SetCoord((*it).X()-sumX,(*it).Y()-sumY,(*it).Z()-sumZ);
-            newdata.push_back(pttmp);
-        }
-    }
+    _eigenValues.clear();
+    _eigenVectors.clear();
+    if(_count<2)return false;
+    _ptCenter.SetXYZ(_mean);//中心点
+
     math_Matrix covMatrix(1, 3, 1,3);
-    {//生成协方差矩阵并计算特征值
-        float covxx,covxy,covxz,covyy,covyz,covzz;
-        covxx=covxy=covxz=covyy=covyz=covzz=0;
-        for (std::list<gp_Pnt>::iterator it=newdata.begin();it!=newdata.end();it++)
-        {
-            covxx+=it->X()*it->X();
-            covxy+=it->X()*it->Y();
-            covxz+=it->X()*it->Z();
-            covyy+=it->Y()*it->Y();
-            covyz+=it->Y()*it->Z();
-            covzz+=it->Z()*it->Z();
-        }
-        covxx/=(nPts-1);
-        covxy/=(nPts-1);
-        covxz/=(nPts-1);
-        covyy/=(nPts-1);
-        covyz/=(nPts-1);
-        covzz/=(nPts-1);
-        covMatrix(1, 1) = covxx;  covMatrix(1, 2) = covxy;covMatrix(1,3)=covxz;
-        covMatrix(2, 1) = covxy;  covMatrix(2, 2) = covyy;covMatrix(2,3)=covyz;
-        covMatrix(3, 1) = covxz;  covMatrix(3, 2) = covyz;covMatrix(3,3)=covzz;
+    {//生成协方差矩阵
+        const double n1 = double(_count-1);
+        covMatrix(1, 1) = _m2[0]/n1;  covMatrix(1, 2) = _m2[1]/n1;covMatrix(1,3)=_m2[2]/n1;
+        covMatrix(2, 1) = _m2[1]/n1;  covMatrix(2, 2) = _m2[3]/n1;covMatrix(2,3)=_m2[4]/n1;
+        covMatrix(3, 1) = _m2[2]/n1;  covMatrix(3, 2) = _m2[4]/n1;covMatrix(3,3)=_m2[5]/n1;
     }
-    {//根据协方差矩阵求特征值和特征向量
-        _eigenValues.clear();
-        _eigenVectors.clear();
+    {//根据协方差矩阵求特征值和特征向量, 按特征值从大到小排列
         math_Jacobi J(covMatrix);
-        if (J.IsDone())
+        if (!J.IsDone())
+            return false;
+        int order[3] = {1,2,3};
+        std::sort(order,order+3,[&J](int a,int b){ return J.Value(a) > J.Value(b); });
+        for (int i = 0; i < 3; ++i)
         {
-            for (Standard_Integer i = covMatrix.LowerRow(); i <= covMatrix.UpperRow(); ++i)
-            {
-                math_Vector V(1, covMatrix.RowNumber());
-                J.Vector(i, V);
-                gp_Vec tmpVec(V.Value(1),V.Value(2),V.Value(3));
-                _eigenVectors.push_back(tmpVec);
-                _eigenValues.push_back(J.Value(i));
-            }
+            math_Vector V(1, 3);
+            J.Vector(order[i], V);
+            _eigenVectors.push_back(gp_Vec(V.Value(1),V.Value(2),V.Value(3)));
+            _eigenValues.push_back(J.Value(order[i]));
         }
     }
-    if(_eigenValues.size()==3&&_eigenVectors.size()==3) return true;
-    return false;
-
+    return true;
 }
 
 std::vector<gp_Vec> PCA::GetEigenVector()
 {
     return _eigenVectors;
 }
-std::vector<float> PCA::GetEigenvalue()
+std::vector<double> PCA::GetEigenvalue()
 {
     return _eigenValues;
 }
@@ -1,25 +1,56 @@
 ﻿#ifndef PCA_H
 #define PCA_H
 
+#include <cstddef>
 #include <list>
 #include <vector>
 #include "gp_Pnt.hxx"
 #include "gp_Vec.hxx"
+#include "gp_XYZ.hxx"
+
+//! Principal component analysis of points. The mean and the co-moments are
+//! accumulated in one pass, in double and relative to the mean, so a part
+//! far from the origin keeps its precision. The points may come in chunks of
+//! contiguous arrays, a chunk is reduced on its own and merged into the sums,
+//! and the sums of two PCA can be merged, such as chunks reduced in parallel.
 class PCA
 {
 public:
-    //PCA();
+    PCA();
     PCA(const std::list<gp_Pnt>& aPts);
+
+    //! Forget all the points
+    void Clear();
+    //! Add one point
+    void Add(const gp_Pnt& aPnt);
+    //! Add a chunk of count points
+    void Add(const gp_Pnt* aPnts, size_t count);
+    //! Add a chunk of count points by their coordinates in separate arrays
+    void Add(const double* x, const double* y, const double* z, size_t count);
+    //! Add the points of another PCA
+    void Merge(const PCA& other);
+
+    //! Number of added points
+    size_t Count() const { return _count; }
+
+    //! Compute the eigenvalues and eigenvectors of the covariance, it needs 2 points at least
     bool Run();
-    //获取特征值
-    std::vector<float> GetEigenvalue();
-    //获取特征向量
+    //获取特征值, 从大到小
+    std::vector<double> GetEigenvalue();
+    //获取特征向量, 与特征值的顺序相同
     std::vector<gp_Vec> GetEigenVector();
     //获取中心点
     gp_Pnt GetCenterPoint();
 private:
-    const std::list<gp_Pnt>* _pPtsList;
-    std::vector<float> _eigenValues;
+    //! merge a group of n points with its mean and co-moments
+    void merge(size_t n, const gp_XYZ& mean, const double m2[6]);
+
+    size_t _count;
+    gp_XYZ _mean;
+    //! sums of products of the deviations from mean: xx, xy, xz, yy, yz, zz
+    double _m2[6];
+
+    std::vector<double> _eigenValues;
     std::vector<gp_Vec> _eigenVectors;//特征向量
     gp_Pnt _ptCenter;
 };
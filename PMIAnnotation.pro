@@ -16,70 +16,25 @@ HEADERS += \
     Dialogs/DiamensionInput.h \
     Dialogs/TolBaseInput.h \
     Dialogs/ToleranceInput.h \
-    Label/Label_Angle.h \
-    Label/Label_Datum.h \
-    Label/Label_Diameter.h \
-    Label/Label_Length.h \
-    Label/Label_PMI.h \
-    Label/Label_Radius.h \
-    Label/Label_Taper.h \
-    Label/Label_Tolerance.h \
     MainWindow.h \
     OCCTool/AIS_DraftPoint.h \
-    OCCTool/AIS_DraftShape.hxx \
-    OCCTool/GeneralTools.h \
     OCCTool/OccWidget.h \
-    OCCTool/PMIModel.h \
-    OCCTool/pca.h \
-    TolStringInfo.h
+    OCCTool/ViewProfiler.h
 
 SOURCES += \
     Dialogs/DatumInput.cpp \
     Dialogs/DiamensionInput.cpp \
     Dialogs/TolBaseInput.cpp \
     Dialogs/ToleranceInput.cpp \
-    Label/Label_Angle.cpp \
-    Label/Label_Datum.cpp \
-    Label/Label_Diameter.cpp \
-    Label/Label_Length.cpp \
-    Label/Label_PMI.cpp \
-    Label/Label_Radius.cpp \
-    Label/Label_Taper.cpp \
-    Label/Label_Tolerance.cpp \
     MainWindow.cpp \
     OCCTool/AIS_DraftPoint.cpp \
-    OCCTool/GeneralTools.cpp \
     OCCTool/OccWidget.cpp \
-    OCCTool/PMIModel.cpp \
-    OCCTool/pca.cpp \
+    OCCTool/ViewProfiler.cpp \
     main.cpp
 
-DESTDIR = $$PWD/bin
+include(PMICore.pri)
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
-
-OCCTLIB_PATH = D:/OpenCasCade
-
-win32 {
-    contains(QT_ARCH, x86_64){
-        contains(QMAKE_MSC_VER, 1916){
-            INCLUDEPATH += $$OCCTLIB_PATH/inc
-            LIBS += $$OCCTLIB_PATH/lib/*.lib
-            message("using msvc")
-        }else{
-            mingw{
-                INCLUDEPATH += $$OCCTLIB_PATH/inc
-                LIBS += $$OCCTLIB_PATH/lib/lib*.a
-                message("using mingw")
-            }else{
-                message("wrong kit config")
-            }
-        }
-    }else{
-        message("wrong system version")
-    }
-}
-
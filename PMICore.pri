@@ -0,0 +1,104 @@
+# Model, geometry tools and labels, shared by the application and the batch tool.
+# They don't depend on the widgets, only on QtCore and QtGui.
+
+INCLUDEPATH += $$PWD
+
+HEADERS += \
+    $$PWD/Label/Label_Angle.h \
+    $$PWD/Label/Label_Builder.h \
+    $$PWD/Label/Label_Datum.h \
+    $$PWD/Label/Label_Diameter.h \
+    $$PWD/Label/Label_FontCache.h \
+    $$PWD/Label/Label_Layout.h \
+    $$PWD/Label/Label_LazyDisplay.h \
+    $$PWD/Label/Label_Length.h \
+    $$PWD/Label/Label_LevelOfDetail.h \
+    $$PWD/Label/Label_PMI.h \
+    $$PWD/Label/Label_Radius.h \
+    $$PWD/Label/Label_Record.h \
+    $$PWD/Label/Label_Session.h \
+    $$PWD/Label/Label_Taper.h \
+    $$PWD/Label/Label_Tolerance.h \
+    $$PWD/OCCTool/AIS_DraftShape.hxx \
+    $$PWD/OCCTool/GeneralTools.h \
+    $$PWD/OCCTool/ModelCache.h \
+    $$PWD/OCCTool/ModelImporter.h \
+    $$PWD/OCCTool/OffscreenView.h \
+    $$PWD/OCCTool/PMIModel.h \
+    $$PWD/OCCTool/PickIndex.h \
+    $$PWD/OCCTool/PointBuffer.h \
+    $$PWD/OCCTool/PointMoments.h \
+    $$PWD/OCCTool/RansacFit.h \
+    $$PWD/OCCTool/ShapeFeature.h \
+    $$PWD/OCCTool/pca.h \
+    $$PWD/TolStringInfo.h
+
+SOURCES += \
+    $$PWD/Label/Label_Angle.cpp \
+    $$PWD/Label/Label_Builder.cpp \
+    $$PWD/Label/Label_Datum.cpp \
+    $$PWD/Label/Label_Diameter.cpp \
+    $$PWD/Label/Label_FontCache.cpp \
+    $$PWD/Label/Label_Layout.cpp \
+    $$PWD/Label/Label_LazyDisplay.cpp \
+    $$PWD/Label/Label_Length.cpp \
+    $$PWD/Label/Label_LevelOfDetail.cpp \
+    $$PWD/Label/Label_PMI.cpp \
+    $$PWD/Label/Label_Radius.cpp \
+    $$PWD/Label/Label_Session.cpp \
+    $$PWD/Label/Label_Taper.cpp \
+    $$PWD/Label/Label_Tolerance.cpp \
+    $$PWD/OCCTool/GeneralTools.cpp \
+    $$PWD/OCCTool/ModelCache.cpp \
+    $$PWD/OCCTool/ModelImporter.cpp \
+    $$PWD/OCCTool/OffscreenView.cpp \
+    $$PWD/OCCTool/PMIModel.cpp \
+    $$PWD/OCCTool/PickIndex.cpp \
+    $$PWD/OCCTool/PointBuffer.cpp \
+    $$PWD/OCCTool/PointMoments.cpp \
+    $$PWD/OCCTool/RansacFit.cpp \
+    $$PWD/OCCTool/ShapeFeature.cpp \
+    $$PWD/OCCTool/pca.cpp
+
+DESTDIR = $$PWD/bin
+
+# The point moments use SSE2 on x86-64, CONFIG+=avx2 builds them with AVX2
+# for machines that have it
+avx2 {
+    msvc: QMAKE_CXXFLAGS += /arch:AVX2
+    else: QMAKE_CXXFLAGS += -mavx2 -mfma
+}
+
+isEmpty(OCCTLIB_PATH) {
+    win32: OCCTLIB_PATH = D:/OpenCasCade
+    else: OCCTLIB_PATH = /usr
+}
+
+win32 {
+    contains(QT_ARCH, x86_64){
+        contains(QMAKE_MSC_VER, 1916){
+            INCLUDEPATH += $$OCCTLIB_PATH/inc
+            LIBS += $$OCCTLIB_PATH/lib/*.lib
+            message("using msvc")
+        }else{
+            mingw{
+                INCLUDEPATH += $$OCCTLIB_PATH/inc
+                LIBS += $$OCCTLIB_PATH/lib/lib*.a
+                message("using mingw")
+            }else{
+                message("wrong kit config")
+            }
+        }
+    }else{
+        message("wrong system version")
+    }
+}
+
+unix {
+    INCLUDEPATH += $$OCCTLIB_PATH/include/opencascade
+    LIBS += -L$$OCCTLIB_PATH/lib \
+        -lTKernel -lTKMath -lTKG2d -lTKG3d -lTKGeomBase -lTKBRep \
+        -lTKGeomAlgo -lTKTopAlgo -lTKPrim -lTKBO -lTKFeat -lTKMesh -lTKShHealing \
+        -lTKService -lTKV3d -lTKOpenGl \
+        -lTKXSBase -lTKSTEP -lTKSTEPBase -lTKSTEPAttr -lTKSTEP209 -lTKIGES
+}